@@ -20,6 +20,8 @@ namespace fs = std::filesystem;
 namespace fs = std::experimental::filesystem;
 #endif
 
+#include <sys/resource.h>
+
 #include "Application.h"
 
 #define USEC2SEC(x) (x / 1000000)
@@ -30,6 +32,7 @@ namespace tkm::monitor
 Application *Application::appInstance = nullptr;
 
 static bool isProfMode(const std::shared_ptr<tkm::monitor::Options> opts);
+static void raiseFileLimit(void);
 
 Application::Application(const std::string &name,
                          const std::string &description,
@@ -45,7 +48,8 @@ Application::Application(const std::string &name,
   bool profModeEnabled = isProfMode(m_options);
 
   auto logLevel = Logger::Message::Type::Verbose;
-  const auto logLevelString = m_options->getFor(Options::Key::LogLevel);
+  const auto &settings = m_options->getSettings();
+  const auto &logLevelString = settings.logLevel;
   if (logLevelString.rfind("debug", 0) != std::string::npos) {
     logLevel = Logger::Message::Type::Debug;
   } else if (logLevelString.rfind("info", 0) != std::string::npos) {
@@ -64,19 +68,22 @@ Application::Application(const std::string &name,
   // Set update lanes intervals based on runtime mode
   if (profModeEnabled) {
     logInfo() << "Profiling mode enabled";
-    m_fastLaneInterval = std::stoul(m_options->getFor(Options::Key::ProfModeFastLaneInt));
-    m_paceLaneInterval = std::stoul(m_options->getFor(Options::Key::ProfModePaceLaneInt));
-    m_slowLaneInterval = std::stoul(m_options->getFor(Options::Key::ProfModeSlowLaneInt));
+    m_fastLaneInterval = static_cast<uint64_t>(settings.profModeFastLaneInt.count());
+    m_paceLaneInterval = static_cast<uint64_t>(settings.profModePaceLaneInt.count());
+    m_slowLaneInterval = static_cast<uint64_t>(settings.profModeSlowLaneInt.count());
   } else {
-    m_fastLaneInterval = std::stoul(m_options->getFor(Options::Key::ProdModeFastLaneInt));
-    m_paceLaneInterval = std::stoul(m_options->getFor(Options::Key::ProdModePaceLaneInt));
-    m_slowLaneInterval = std::stoul(m_options->getFor(Options::Key::ProdModeSlowLaneInt));
+    m_fastLaneInterval = static_cast<uint64_t>(settings.prodModeFastLaneInt.count());
+    m_paceLaneInterval = static_cast<uint64_t>(settings.prodModePaceLaneInt.count());
+    m_slowLaneInterval = static_cast<uint64_t>(settings.prodModeSlowLaneInt.count());
   }
 
   logDebug() << "Update lanes interval fast=" << m_fastLaneInterval
              << " pace=" << m_paceLaneInterval << " slow=" << m_slowLaneInterval;
 
-  if (m_options->getFor(Options::Key::EnableTCPServer) == tkmDefaults.valFor(Defaults::Val::True)) {
+  // ProcEntries keep procfs descriptors open
+  raiseFileLimit();
+
+  if (settings.enableTCPServer) {
     if (profModeEnabled) {
       m_netServer = std::make_shared<TCPServer>(m_options);
       try {
@@ -88,7 +95,7 @@ Application::Application(const std::string &name,
     }
   }
 
-  if (m_options->getFor(Options::Key::EnableUDSServer) == tkmDefaults.valFor(Defaults::Val::True)) {
+  if (settings.enableUDSServer) {
     m_udsServer = std::make_shared<UDSServer>(m_options);
     try {
       m_udsServer->start();
@@ -99,14 +106,14 @@ Application::Application(const std::string &name,
   }
 
 #ifdef WITH_PROC_EVENT
-  if (m_options->getFor(Options::Key::EnableProcEvent) == tkmDefaults.valFor(Defaults::Val::True)) {
+  if (settings.enableProcEvent) {
     m_procEvent = std::make_shared<ProcEvent>(m_options);
     m_procEvent->setEventSource();
   }
 #endif
 
 #ifdef WITH_PROC_ACCT
-  if (m_options->getFor(Options::Key::EnableProcAcct) == tkmDefaults.valFor(Defaults::Val::True)) {
+  if (settings.enableProcAcct) {
     if (profModeEnabled) {
       m_procAcct = std::make_shared<ProcAcct>(m_options);
       m_procAcct->setEventSource();
@@ -115,8 +122,7 @@ Application::Application(const std::string &name,
 #endif
 
 #ifdef WITH_STARTUP_DATA
-  if (m_options->getFor(Options::Key::EnableStartupData) ==
-      tkmDefaults.valFor(Defaults::Val::True)) {
+  if (settings.enableStartupData) {
     if (profModeEnabled) {
       m_startupData = std::make_shared<StartupData>(m_options);
       m_startupData->setEventSource();
@@ -183,10 +189,21 @@ Application::Application(const std::string &name,
     m_dataSources.append(m_sysProcWireless);
   }
 
+  if (m_options->getSettings().enableCGroupStat &&
+      fs::exists("/sys/fs/cgroup/cgroup.controllers")) {
+    try {
+      m_sysCGroupStat = std::make_shared<SysCGroupStat>(m_options);
+      m_sysCGroupStat->setUpdateLane(IDataSource::UpdateLane::Pace);
+      m_sysCGroupStat->setUpdateInterval(m_paceLaneInterval);
+      m_sysCGroupStat->setEventSource();
+      m_dataSources.append(m_sysCGroupStat);
+    } catch (std::exception &e) {
+      logError() << "Fail to create cgroup data source. Exception: " << e.what();
+    }
+  }
+
 #ifdef WITH_VM_STAT
-  if ((m_options->getFor(Options::Key::EnableSysProcVMStat) ==
-       tkmDefaults.valFor(Defaults::Val::True)) &&
-      (fs::exists("/proc/vmstat"))) {
+  if (settings.enableSysProcVMStat && (fs::exists("/proc/vmstat"))) {
     m_sysProcVMStat = std::make_shared<SysProcVMStat>(m_options);
     m_sysProcVMStat->setUpdateLane(IDataSource::UpdateLane::Slow);
     m_sysProcVMStat->setUpdateInterval(m_slowLaneInterval);
@@ -206,8 +223,7 @@ Application::Application(const std::string &name,
 
   // After init we can lower or priority if configured in production mode
   if (!profModeEnabled) {
-    if (m_options->getFor(Options::Key::SelfLowerPriority) ==
-        tkmDefaults.valFor(Defaults::Val::True)) {
+    if (settings.selfLowerPriority) {
       if (nice(19) == -1) {
         logWarn() << "Failed to set nice value. Error: " << strerror(errno);
       }
@@ -292,9 +308,30 @@ void Application::startWatchdog(void)
 #endif
 }
 
+static void raiseFileLimit(void)
+{
+  struct rlimit fdLimit {
+  };
+
+  if (getrlimit(RLIMIT_NOFILE, &fdLimit) != 0) {
+    logWarn() << "Fail to get file descriptor limit. Error: " << strerror(errno);
+    return;
+  }
+
+  if (fdLimit.rlim_cur < fdLimit.rlim_max) {
+    fdLimit.rlim_cur = fdLimit.rlim_max;
+    if (setrlimit(RLIMIT_NOFILE, &fdLimit) != 0) {
+      logWarn() << "Fail to raise file descriptor limit. Error: " << strerror(errno);
+      return;
+    }
+  }
+
+  logDebug() << "File descriptor limit set to " << fdLimit.rlim_cur;
+}
+
 static bool isProfMode(const std::shared_ptr<tkm::monitor::Options> opts)
 {
-  auto profCond = opts->getFor(Options::Key::ProfModeIfPath);
+  const auto &profCond = opts->getSettings().profModeIfPath;
   if (profCond != tkmDefaults.valFor(Defaults::Val::None)) {
     if (fs::exists(profCond)) {
       return true;
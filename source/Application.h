@@ -25,6 +25,7 @@
 #include "ProcEntry.h"
 #include "ProcRegistry.h"
 #include "StateManager.h"
+#include "SysCGroupStat.h"
 #include "SysProcBuddyInfo.h"
 #include "SysProcDiskStats.h"
 #include "SysProcMemInfo.h"
@@ -127,6 +128,10 @@ public:
   {
     return m_sysProcBuddyInfo;
   }
+  auto getSysCGroupStat(void) -> const std::shared_ptr<SysCGroupStat>
+  {
+    return m_sysCGroupStat;
+  }
   bool hasConfigFile(void)
   {
     return m_options->hasConfigFile();
@@ -193,6 +198,7 @@ private:
   std::shared_ptr<SysProcDiskStats> m_sysProcDiskStats = nullptr;
   std::shared_ptr<SysProcPressure> m_sysProcPressure = nullptr;
   std::shared_ptr<SysProcBuddyInfo> m_sysProcBuddyInfo = nullptr;
+  std::shared_ptr<SysCGroupStat> m_sysCGroupStat = nullptr;
   std::shared_ptr<SysProcWireless> m_sysProcWireless = nullptr;
   std::atomic<unsigned short> m_procAcctCollectorCounter = 0;
 
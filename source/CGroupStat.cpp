@@ -0,0 +1,379 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     CGroupStat Class
+ * @details   Resource usage of a cgroup v2 node
+ *-
+ */
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "CGroupStat.h"
+#include "ProcParser.h"
+
+namespace tkm::monitor
+{
+
+template <size_t N>
+static inline bool keyIs(const char *key, size_t keyLen, const char (&name)[N])
+{
+  return (keyLen == (N - 1)) && (::memcmp(key, name, N - 1) == 0);
+}
+
+static inline auto findEol(const char *pos, const char *end) -> const char *
+{
+  auto eol = static_cast<const char *>(::memchr(pos, '\n', static_cast<size_t>(end - pos)));
+  return (eol == nullptr) ? end : eol;
+}
+
+// Flat keyed files use "<key> <value>" lines. The handler returns the target
+// for a known key or nullptr to skip the line.
+template <typename F>
+static size_t parseFlatKeyed(const char *buf, size_t len, F &&lookup)
+{
+  const char *end = buf + len;
+  const char *pos = buf;
+  size_t found = 0;
+
+  while (pos < end) {
+    const char *eol = findEol(pos, end);
+    auto sep = static_cast<const char *>(::memchr(pos, ' ', static_cast<size_t>(eol - pos)));
+
+    if (sep != nullptr) {
+      uint64_t *target = lookup(pos, static_cast<size_t>(sep - pos));
+      const char *val = sep + 1;
+      if ((target != nullptr) && scanUnsigned(val, eol, *target)) {
+        found++;
+      }
+    }
+
+    pos = eol + 1;
+  }
+
+  return found;
+}
+
+// PSI averages are printed with two decimals
+static bool scanDecimal(const char *&pos, const char *end, float &value)
+{
+  uint64_t integral = 0;
+  if (!scanUnsigned(pos, end, integral)) {
+    return false;
+  }
+
+  float result = static_cast<float>(integral);
+  if ((pos < end) && (*pos == '.')) {
+    float scale = 0.1f;
+    pos++;
+    while ((pos < end) && (*pos >= '0') && (*pos <= '9')) {
+      result += static_cast<float>(*pos - '0') * scale;
+      scale /= 10;
+      pos++;
+    }
+  }
+
+  value = result;
+  return true;
+}
+
+bool parseCGroupCpuStat(const char *buf, size_t len, CGroupStatData &data)
+{
+  const auto found = parseFlatKeyed(buf, len, [&data](const char *key, size_t keyLen) {
+    uint64_t *target = nullptr;
+    if (keyIs(key, keyLen, "usage_usec")) {
+      target = &data.usageUsec;
+    } else if (keyIs(key, keyLen, "user_usec")) {
+      target = &data.userUsec;
+    } else if (keyIs(key, keyLen, "system_usec")) {
+      target = &data.systemUsec;
+    } else if (keyIs(key, keyLen, "nr_periods")) {
+      target = &data.nrPeriods;
+    } else if (keyIs(key, keyLen, "nr_throttled")) {
+      target = &data.nrThrottled;
+    } else if (keyIs(key, keyLen, "throttled_usec")) {
+      target = &data.throttledUsec;
+    }
+    return target;
+  });
+
+  // The throttling counters are only present with the cpu controller enabled
+  return found >= 3;
+}
+
+bool parseCGroupMemoryStat(const char *buf, size_t len, CGroupStatData &data)
+{
+  const auto found = parseFlatKeyed(buf, len, [&data](const char *key, size_t keyLen) {
+    uint64_t *target = nullptr;
+    if (keyIs(key, keyLen, "anon")) {
+      target = &data.memAnon;
+    } else if (keyIs(key, keyLen, "file")) {
+      target = &data.memFile;
+    } else if (keyIs(key, keyLen, "kernel")) {
+      target = &data.memKernel;
+    } else if (keyIs(key, keyLen, "shmem")) {
+      target = &data.memShmem;
+    } else if (keyIs(key, keyLen, "sock")) {
+      target = &data.memSock;
+    }
+    return target;
+  });
+
+  // Older kernels have no "kernel" entry
+  return found >= 2;
+}
+
+bool parseCGroupIOStat(const char *buf, size_t len, CGroupStatData &data)
+{
+  const char *end = buf + len;
+  const char *pos = buf;
+
+  data.ioRBytes = data.ioWBytes = data.ioRIOs = data.ioWIOs = 0;
+
+  // Lines are "<major>:<minor> rbytes=N wbytes=N rios=N wios=N dbytes=N dios=N"
+  while (pos < end) {
+    const char *eol = findEol(pos, end);
+
+    if (skipFields(pos, eol, 1)) {
+      while (pos < eol) {
+        while ((pos < eol) && (*pos == ' ')) {
+          pos++;
+        }
+        auto eq = static_cast<const char *>(::memchr(pos, '=', static_cast<size_t>(eol - pos)));
+        if (eq == nullptr) {
+          break;
+        }
+
+        const auto keyLen = static_cast<size_t>(eq - pos);
+        const char *val = eq + 1;
+        uint64_t value = 0;
+        if (!scanUnsigned(val, eol, value)) {
+          return false;
+        }
+
+        if (keyIs(pos, keyLen, "rbytes")) {
+          data.ioRBytes += value;
+        } else if (keyIs(pos, keyLen, "wbytes")) {
+          data.ioWBytes += value;
+        } else if (keyIs(pos, keyLen, "rios")) {
+          data.ioRIOs += value;
+        } else if (keyIs(pos, keyLen, "wios")) {
+          data.ioWIOs += value;
+        }
+        pos = val;
+      }
+    }
+
+    pos = eol + 1;
+  }
+
+  // Empty if no IO was done yet
+  return true;
+}
+
+bool parseCGroupPressure(const char *buf, size_t len, CGroupPSIData &some, CGroupPSIData &full)
+{
+  const char *end = buf + len;
+  const char *pos = buf;
+  size_t found = 0;
+
+  // Lines are "some|full avg10=N.NN avg60=N.NN avg300=N.NN total=N"
+  while (pos < end) {
+    const char *eol = findEol(pos, end);
+    CGroupPSIData *target = nullptr;
+
+    if (((eol - pos) > 4) && (::memcmp(pos, "some", 4) == 0)) {
+      target = &some;
+    } else if (((eol - pos) > 4) && (::memcmp(pos, "full", 4) == 0)) {
+      target = &full;
+    }
+
+    if (target != nullptr) {
+      pos += 4;
+      while (pos < eol) {
+        while ((pos < eol) && (*pos == ' ')) {
+          pos++;
+        }
+        auto eq = static_cast<const char *>(::memchr(pos, '=', static_cast<size_t>(eol - pos)));
+        if (eq == nullptr) {
+          break;
+        }
+
+        const auto keyLen = static_cast<size_t>(eq - pos);
+        const char *val = eq + 1;
+        bool status = false;
+
+        if (keyIs(pos, keyLen, "avg10")) {
+          status = scanDecimal(val, eol, target->avg10);
+        } else if (keyIs(pos, keyLen, "avg60")) {
+          status = scanDecimal(val, eol, target->avg60);
+        } else if (keyIs(pos, keyLen, "avg300")) {
+          status = scanDecimal(val, eol, target->avg300);
+        } else if (keyIs(pos, keyLen, "total")) {
+          status = scanUnsigned(val, eol, target->total);
+        }
+        if (!status) {
+          return false;
+        }
+        pos = val;
+      }
+      found++;
+    }
+
+    pos = eol + 1;
+  }
+
+  return found > 0;
+}
+
+static constexpr const char *fileNames[] = {
+    "cpu.stat", "memory.current", "memory.stat", "io.stat", "cpu.pressure"};
+
+CGroupStat::CGroupStat(const std::string &path, int dirFd)
+: m_path(path)
+, m_dirFd(dirFd)
+{
+  m_fds.fill(-1);
+
+  if (m_dirFd < 0) {
+    return;
+  }
+
+  struct stat st {};
+  if (::fstat(m_dirFd, &st) == 0) {
+    m_id = static_cast<uint64_t>(st.st_ino);
+  }
+
+  for (size_t i = 0; i < m_fds.size(); i++) {
+    m_fds[i] = ::openat(m_dirFd, fileNames[i], O_RDONLY | O_CLOEXEC);
+  }
+}
+
+CGroupStat::~CGroupStat()
+{
+  for (auto &fd : m_fds) {
+    if (fd >= 0) {
+      ::close(fd);
+      fd = -1;
+    }
+  }
+
+  if (m_dirFd >= 0) {
+    ::close(m_dirFd);
+    m_dirFd = -1;
+  }
+}
+
+bool CGroupStat::update(void)
+{
+  char buf[CGroupStatBufferSize];
+
+  auto readFile = [this, &buf](File file) -> ssize_t {
+    const auto fd = m_fds[static_cast<size_t>(file)];
+    return (fd < 0) ? -1 : ::pread(fd, buf, sizeof(buf), 0);
+  };
+
+  // The cgroup is gone if cpu.stat (always present on v2) can't be read
+  auto len = readFile(File::CpuStat);
+  if ((len <= 0) || !parseCGroupCpuStat(buf, static_cast<size_t>(len), m_data)) {
+    return false;
+  }
+
+  len = readFile(File::MemCurrent);
+  if (len > 0) {
+    const char *pos = buf;
+    scanUnsigned(pos, buf + len, m_data.memCurrent);
+  }
+
+  len = readFile(File::MemStat);
+  if (len > 0) {
+    parseCGroupMemoryStat(buf, static_cast<size_t>(len), m_data);
+  }
+
+  len = readFile(File::IOStat);
+  if (len >= 0) {
+    parseCGroupIOStat(buf, static_cast<size_t>(len), m_data);
+  }
+
+  len = readFile(File::CpuPressure);
+  if (len > 0) {
+    parseCGroupPressure(buf, static_cast<size_t>(len), m_data.cpuSome, m_data.cpuFull);
+  }
+
+  using USec = std::chrono::microseconds;
+  const auto now = std::chrono::steady_clock::now();
+  const bool hasBaseline = (m_lastUpdateTime.time_since_epoch().count() != 0);
+  const auto durationUs =
+      hasBaseline ? std::chrono::duration_cast<USec>(now - m_lastUpdateTime).count() : 0;
+
+  if ((durationUs > 0) && (m_data.usageUsec > m_lastUsageUsec)) {
+    m_cpuPercent = static_cast<uint32_t>(((m_data.usageUsec - m_lastUsageUsec) * 100) /
+                                         static_cast<uint64_t>(durationUs));
+  } else {
+    m_cpuPercent = 0;
+  }
+
+  m_lastUsageUsec = m_data.usageUsec;
+  m_lastUpdateTime = now;
+
+  return true;
+}
+
+static constexpr const char *pressureFileNames[] = {
+    "cpu.pressure", "memory.pressure", "io.pressure"};
+
+CGroupPressure::CGroupPressure(int rootFd, const std::string &path)
+: m_path(path)
+{
+  m_fds.fill(-1);
+
+  for (size_t i = 0; i < m_fds.size(); i++) {
+    const std::string filePath = path + "/" + pressureFileNames[i];
+    m_fds[i] = ::openat(rootFd, filePath.c_str(), O_RDONLY | O_CLOEXEC);
+  }
+}
+
+CGroupPressure::~CGroupPressure()
+{
+  for (auto &fd : m_fds) {
+    if (fd >= 0) {
+      ::close(fd);
+      fd = -1;
+    }
+  }
+}
+
+bool CGroupPressure::isOpen(void) const
+{
+  for (const auto fd : m_fds) {
+    if (fd >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CGroupPressure::update(void)
+{
+  char buf[CGroupStatBufferSize];
+  bool status = false;
+
+  auto readFile = [this, &buf](File file, CGroupPSIData &some, CGroupPSIData &full) -> bool {
+    const auto fd = m_fds[static_cast<size_t>(file)];
+    const auto len = (fd < 0) ? -1 : ::pread(fd, buf, sizeof(buf), 0);
+    return (len > 0) && parseCGroupPressure(buf, static_cast<size_t>(len), some, full);
+  };
+
+  status |= readFile(File::CpuPressure, m_data.cpuSome, m_data.cpuFull);
+  status |= readFile(File::MemPressure, m_data.memSome, m_data.memFull);
+  status |= readFile(File::IOPressure, m_data.ioSome, m_data.ioFull);
+
+  return status;
+}
+
+} // namespace tkm::monitor
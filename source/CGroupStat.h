@@ -0,0 +1,157 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     CGroupStat Class
+ * @details   Resource usage of a cgroup v2 node
+ *-
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tkm::monitor
+{
+
+// Enough for memory.stat (about 50 lines on recent kernels) and io.stat
+constexpr size_t CGroupStatBufferSize = 8192;
+
+typedef struct CGroupPSIData {
+  float avg10 = 0;
+  float avg60 = 0;
+  float avg300 = 0;
+  uint64_t total = 0;
+} CGroupPSIData;
+
+typedef struct CGroupStatData {
+  // cpu.stat
+  uint64_t usageUsec = 0;
+  uint64_t userUsec = 0;
+  uint64_t systemUsec = 0;
+  uint64_t nrPeriods = 0;
+  uint64_t nrThrottled = 0;
+  uint64_t throttledUsec = 0;
+  // memory.current and memory.stat in bytes
+  uint64_t memCurrent = 0;
+  uint64_t memAnon = 0;
+  uint64_t memFile = 0;
+  uint64_t memKernel = 0;
+  uint64_t memShmem = 0;
+  uint64_t memSock = 0;
+  // io.stat summed over all devices
+  uint64_t ioRBytes = 0;
+  uint64_t ioWBytes = 0;
+  uint64_t ioRIOs = 0;
+  uint64_t ioWIOs = 0;
+  // cpu.pressure
+  CGroupPSIData cpuSome{};
+  CGroupPSIData cpuFull{};
+} CGroupStatData;
+
+// PSI of one cgroup from its cpu.pressure, memory.pressure and io.pressure
+typedef struct CGroupPressureData {
+  CGroupPSIData cpuSome{};
+  CGroupPSIData cpuFull{};
+  CGroupPSIData memSome{};
+  CGroupPSIData memFull{};
+  CGroupPSIData ioSome{};
+  CGroupPSIData ioFull{};
+} CGroupPressureData;
+
+// Parse cpu.stat content from buf
+bool parseCGroupCpuStat(const char *buf, size_t len, CGroupStatData &data);
+// Parse memory.stat content from buf
+bool parseCGroupMemoryStat(const char *buf, size_t len, CGroupStatData &data);
+// Parse io.stat content from buf and sum the device counters
+bool parseCGroupIOStat(const char *buf, size_t len, CGroupStatData &data);
+// Parse a PSI file (cpu.pressure or /proc/pressure/*) content from buf
+bool parseCGroupPressure(const char *buf, size_t len, CGroupPSIData &some, CGroupPSIData &full);
+
+/*
+ * Keep the cgroup v2 interface files of one cgroup open and read them with a
+ * single pread each on update. Controller files missing from the cgroup (i.e.
+ * io not enabled in the parent subtree_control) are skipped.
+ */
+class CGroupStat
+{
+public:
+  enum class File { CpuStat, MemCurrent, MemStat, IOStat, CpuPressure, Count };
+
+public:
+  // Takes ownership of dirFd, an open cgroup directory. Path is only used as name.
+  explicit CGroupStat(const std::string &path, int dirFd);
+  ~CGroupStat();
+
+public:
+  CGroupStat(CGroupStat const &) = delete;
+  void operator=(CGroupStat const &) = delete;
+
+public:
+  bool update(void);
+  bool hasFile(File file) const { return m_fds[static_cast<size_t>(file)] >= 0; }
+
+  auto getPath(void) const -> const std::string & { return m_path; }
+  // The cgroup id is the cgroup directory inode number
+  auto getId(void) const -> uint64_t { return m_id; }
+  auto getData(void) const -> const CGroupStatData & { return m_data; }
+  // Same scale as ProcInfoEntry cpu_percent
+  auto getCPUPercent(void) const -> uint32_t { return m_cpuPercent; }
+  auto getGeneration(void) const -> uint64_t { return m_generation; }
+  void setGeneration(uint64_t generation) { m_generation = generation; }
+
+private:
+  std::array<int, static_cast<size_t>(File::Count)> m_fds{};
+  std::chrono::time_point<std::chrono::steady_clock> m_lastUpdateTime{};
+  CGroupStatData m_data{};
+  std::string m_path{};
+  uint64_t m_lastUsageUsec = 0;
+  uint64_t m_id = 0;
+  uint64_t m_generation = 0;
+  uint32_t m_cpuPercent = 0;
+  int m_dirFd = -1;
+};
+
+/*
+ * Keep the PSI files of one cgroup open for the per context pressure. The
+ * three files are read with a single pread each on update.
+ */
+class CGroupPressure
+{
+public:
+  enum class File { CpuPressure, MemPressure, IOPressure, Count };
+
+public:
+  // Path is relative to rootFd, the files are opened once here
+  explicit CGroupPressure(int rootFd, const std::string &path);
+  ~CGroupPressure();
+
+public:
+  CGroupPressure(CGroupPressure const &) = delete;
+  void operator=(CGroupPressure const &) = delete;
+
+public:
+  // False if none of the files can be read (i.e. removed cgroup)
+  bool update(void);
+  bool hasFile(File file) const { return m_fds[static_cast<size_t>(file)] >= 0; }
+  bool isOpen(void) const;
+
+  auto getPath(void) const -> const std::string & { return m_path; }
+  auto getData(void) const -> const CGroupPressureData & { return m_data; }
+  auto getGeneration(void) const -> uint64_t { return m_generation; }
+  void setGeneration(uint64_t generation) { m_generation = generation; }
+
+private:
+  std::array<int, static_cast<size_t>(File::Count)> m_fds{};
+  CGroupPressureData m_data{};
+  std::string m_path{};
+  uint64_t m_generation = 0;
+};
+
+} // namespace tkm::monitor
@@ -14,6 +14,24 @@
 namespace tkm::monitor
 {
 
+auto commonCGroup(const std::string &first, const std::string &second) -> std::string
+{
+  size_t common = 0;
+  size_t pos = 0;
+
+  // Compare whole path components, "/a/bc" is not inside "/a/b"
+  while ((pos < first.size()) && (pos < second.size()) && (first[pos] == second[pos])) {
+    pos++;
+    if ((pos == first.size()) || (first[pos] == '/')) {
+      if ((pos == second.size()) || (second[pos] == '/')) {
+        common = pos;
+      }
+    }
+  }
+
+  return (common <= 1) ? std::string{"/"} : first.substr(0, common);
+}
+
 ContextEntry::ContextEntry(uint64_t id, const std::string &name)
 {
   m_data.set_ctx_id(id);
@@ -28,4 +46,70 @@ void ContextEntry::resetData()
   m_data.set_total_mem_pss(0);
 }
 
+void ContextEntry::addProc(const tkm::msg::monitor::ProcInfoEntry &data)
+{
+  m_procCount++;
+  addProcData(data);
+}
+
+void ContextEntry::remProc(const tkm::msg::monitor::ProcInfoEntry &data)
+{
+  if (m_procCount > 0) {
+    m_procCount--;
+  }
+  subProcData(data);
+}
+
+void ContextEntry::addProcData(const tkm::msg::monitor::ProcInfoEntry &data)
+{
+  m_data.set_total_cpu_time(m_data.total_cpu_time() + data.cpu_time());
+  m_data.set_total_cpu_percent(m_data.total_cpu_percent() + data.cpu_percent());
+  m_data.set_total_mem_rss(m_data.total_mem_rss() + data.mem_rss());
+  m_data.set_total_mem_pss(m_data.total_mem_pss() + data.mem_pss());
+}
+
+void ContextEntry::addProcCGroup(const std::string &cgroup)
+{
+  if (m_procCGroups[cgroup]++ == 0) {
+    updateCGroup();
+  }
+}
+
+void ContextEntry::remProcCGroup(const std::string &cgroup)
+{
+  auto it = m_procCGroups.find(cgroup);
+  if (it == m_procCGroups.end()) {
+    return;
+  }
+
+  if (--it->second == 0) {
+    m_procCGroups.erase(it);
+    updateCGroup();
+  }
+}
+
+void ContextEntry::updateCGroup(void)
+{
+  // Only distinct cgroups are folded, usually a handful per context
+  m_cgroup.clear();
+  for (const auto &entry : m_procCGroups) {
+    m_cgroup = m_cgroup.empty() ? entry.first : commonCGroup(m_cgroup, entry.first);
+  }
+}
+
+template <class T, class V>
+static auto subSaturated(T total, V value) -> T
+{
+  return (total > value) ? static_cast<T>(total - value) : 0;
+}
+
+void ContextEntry::subProcData(const tkm::msg::monitor::ProcInfoEntry &data)
+{
+  // Saturate so a missed update can't wrap the totals around
+  m_data.set_total_cpu_time(subSaturated(m_data.total_cpu_time(), data.cpu_time()));
+  m_data.set_total_cpu_percent(subSaturated(m_data.total_cpu_percent(), data.cpu_percent()));
+  m_data.set_total_mem_rss(subSaturated(m_data.total_mem_rss(), data.mem_rss()));
+  m_data.set_total_mem_pss(subSaturated(m_data.total_mem_pss(), data.mem_pss()));
+}
+
 } // namespace tkm::monitor
@@ -11,11 +11,19 @@
 
 #pragma once
 
+#include <chrono>
+#include <map>
+#include <string>
 #include <taskmonitor/taskmonitor.h>
 
+#include "CGroupStat.h"
+
 namespace tkm::monitor
 {
 
+// Deepest cgroup containing both paths (i.e. "/a/b" for "/a/b/c" and "/a/b/d")
+auto commonCGroup(const std::string &first, const std::string &second) -> std::string;
+
 class ContextEntry : public std::enable_shared_from_this<ContextEntry>
 {
 public:
@@ -31,10 +39,44 @@ public:
   auto getData(void) -> tkm::msg::monitor::ContextInfoEntry & { return m_data; }
   void setData(tkm::msg::monitor::ContextInfoEntry &data) { m_data.CopyFrom(data); }
   auto getContextId(void) -> uint64_t { return m_data.ctx_id(); }
+  auto getProcCount(void) -> size_t { return m_procCount; }
   void resetData(void);
 
+  // Running totals updated by the registry on process add, sample and remove
+  void addProc(const tkm::msg::monitor::ProcInfoEntry &data);
+  void remProc(const tkm::msg::monitor::ProcInfoEntry &data);
+  void addProcData(const tkm::msg::monitor::ProcInfoEntry &data);
+  void subProcData(const tkm::msg::monitor::ProcInfoEntry &data);
+
+  // Common cgroup of the context processes, "/" for the root context (system wide PSI)
+  auto getCGroup(void) -> const std::string & { return m_cgroup; }
+  void setCGroup(const std::string &cgroup) { m_cgroup = cgroup; }
+  // Cgroups of the attached processes, the context cgroup follows their common
+  // ancestor as processes come and go
+  void addProcCGroup(const std::string &cgroup);
+  void remProcCGroup(const std::string &cgroup);
+  // Updated by SysProcPressure, ContextInfoEntry has no PSI fields
+  auto getPressure(void) -> const CGroupPressureData & { return m_pressure; }
+  void setPressure(const CGroupPressureData &pressure) { m_pressure = pressure; }
+  auto getStallLogTime(void) -> std::chrono::time_point<std::chrono::steady_clock>
+  {
+    return m_stallLogTime;
+  }
+  void setStallLogTime(std::chrono::time_point<std::chrono::steady_clock> time)
+  {
+    m_stallLogTime = time;
+  }
+
+private:
+  void updateCGroup(void);
+
 private:
   tkm::msg::monitor::ContextInfoEntry m_data;
+  std::chrono::time_point<std::chrono::steady_clock> m_stallLogTime{};
+  std::map<std::string, size_t> m_procCGroups{};
+  CGroupPressureData m_pressure{};
+  std::string m_cgroup{};
+  size_t m_procCount = 0;
 };
 
 } // namespace tkm::monitor
@@ -0,0 +1,71 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     DataCache Class
+ * @details   Serialized data response shared by collector requests
+ *-
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <taskmonitor/taskmonitor.h>
+
+namespace tkm::monitor
+{
+
+/*
+ * Hold the response envelope built for the current data source generation.
+ * The envelope payloads are packed (serialized) once when the first collector
+ * asks for the data and reused by all requests until the data source update
+ * completes and invalidates the cache. The stored envelope is never modified.
+ */
+class DataCache
+{
+public:
+  explicit DataCache(const std::string &name)
+  : m_name(name)
+  {
+  }
+  ~DataCache() = default;
+
+public:
+  DataCache(DataCache const &) = delete;
+  void operator=(DataCache const &) = delete;
+
+public:
+  auto get(void) -> std::shared_ptr<const tkm::msg::Envelope>
+  {
+    if (m_envelope != nullptr) {
+      m_hits++;
+    } else {
+      m_misses++;
+    }
+    return m_envelope;
+  }
+  void store(const std::shared_ptr<const tkm::msg::Envelope> &envelope) { m_envelope = envelope; }
+  void invalidate(void)
+  {
+    m_envelope.reset();
+    m_generation++;
+  }
+
+  auto getName(void) -> const std::string & { return m_name; }
+  auto getGeneration(void) -> uint64_t { return m_generation; }
+  auto getHits(void) -> uint64_t { return m_hits; }
+  auto getMisses(void) -> uint64_t { return m_misses; }
+
+private:
+  std::shared_ptr<const tkm::msg::Envelope> m_envelope = nullptr;
+  std::string m_name{};
+  uint64_t m_generation = 0;
+  uint64_t m_hits = 0;
+  uint64_t m_misses = 0;
+};
+
+} // namespace tkm::monitor
@@ -11,7 +11,9 @@
 
 #pragma once
 
+#include <memory>
 #include <taskmonitor/taskmonitor.h>
+#include <vector>
 
 #include "../bswinfra/source/Pollable.h"
 #include "../bswinfra/source/Timer.h"
@@ -61,6 +63,13 @@ public:
   void sendData(const tkm::msg::monitor::Data &data)
   {
     tkm::msg::Envelope envelope;
+
+    wrapData(data, envelope);
+    writeEnvelope(envelope);
+  }
+
+  static void wrapData(const tkm::msg::monitor::Data &data, tkm::msg::Envelope &envelope)
+  {
     tkm::msg::monitor::Message message;
 
     message.set_type(tkm::msg::monitor::Message_Type_Data);
@@ -68,8 +77,30 @@ public:
     envelope.mutable_mesg()->PackFrom(message);
     envelope.set_target(tkm::msg::Envelope_Recipient_Collector);
     envelope.set_origin(tkm::msg::Envelope_Recipient_Monitor);
+  }
 
-    writeEnvelope(envelope);
+  static auto makeDataEnvelope(const tkm::msg::monitor::Data &data)
+      -> std::shared_ptr<const tkm::msg::Envelope>
+  {
+    auto envelope = std::make_shared<tkm::msg::Envelope>();
+
+    wrapData(data, *envelope);
+    return envelope;
+  }
+
+  // Write one packed envelope to every live subscriber, expired ones are dropped
+  static void broadcastEnvelope(const tkm::msg::Envelope &envelope,
+                                std::vector<std::weak_ptr<ICollector>> &subscribers)
+  {
+    for (auto it = subscribers.begin(); it != subscribers.end();) {
+      auto collector = it->lock();
+      if (collector == nullptr) {
+        it = subscribers.erase(it);
+        continue;
+      }
+      collector->writeEnvelope(envelope);
+      ++it;
+    }
   }
 
   auto getDescriptor(void) -> tkm::msg::collector::Descriptor & { return m_descriptor; }
@@ -24,6 +24,97 @@ Options::Options(const string &configFile)
     logWarn() << "Fail to parse config file: " << configFile;
     m_configFile.reset();
   }
+
+  loadSettings();
+}
+
+auto Options::getBoolFor(Key key) -> bool
+{
+  return getFor(key) == tkmDefaults.valFor(Defaults::Val::True);
+}
+
+auto Options::getUnsignedFor(Key key, Defaults::Default def) -> uint64_t
+{
+  const auto value = getFor(key);
+
+  // std::stoull accepts a minus sign and wraps negative values around
+  const auto pos = value.find_first_not_of(" \t");
+  if ((pos != std::string::npos) && (value[pos] != '-')) {
+    try {
+      return std::stoull(value);
+    } catch (...) {
+    }
+  }
+
+  logWarn() << "Invalid numeric option value: " << value;
+  return std::stoull(tkmDefaults.getFor(def));
+}
+
+void Options::loadSettings(void)
+{
+  using USec = std::chrono::microseconds;
+  using D = Defaults::Default;
+
+  m_settings.logLevel = getFor(Key::LogLevel);
+  m_settings.containersPath = getFor(Key::ContainersPath);
+  m_settings.profModeIfPath = getFor(Key::ProfModeIfPath);
+  m_settings.tcpServerAddress = getFor(Key::TCPServerAddress);
+  m_settings.udsServerSocketPath = getFor(Key::UDSServerSocketPath);
+
+  m_settings.prodModeFastLaneInt =
+      USec(getUnsignedFor(Key::ProdModeFastLaneInt, D::ProdModeFastLaneInt));
+  m_settings.prodModePaceLaneInt =
+      USec(getUnsignedFor(Key::ProdModePaceLaneInt, D::ProdModePaceLaneInt));
+  m_settings.prodModeSlowLaneInt =
+      USec(getUnsignedFor(Key::ProdModeSlowLaneInt, D::ProdModeSlowLaneInt));
+  m_settings.profModeFastLaneInt =
+      USec(getUnsignedFor(Key::ProfModeFastLaneInt, D::ProfModeFastLaneInt));
+  m_settings.profModePaceLaneInt =
+      USec(getUnsignedFor(Key::ProfModePaceLaneInt, D::ProfModePaceLaneInt));
+  m_settings.profModeSlowLaneInt =
+      USec(getUnsignedFor(Key::ProfModeSlowLaneInt, D::ProfModeSlowLaneInt));
+  m_settings.startupDataCleanupTime =
+      USec(getUnsignedFor(Key::StartupDataCleanupTime, D::StartupDataCleanupTime));
+  m_settings.collectorInactiveTimeout =
+      USec(getUnsignedFor(Key::CollectorInactiveTimeout, D::CollectorInactiveTimeout));
+  m_settings.procEventCoalesceInterval =
+      USec(getUnsignedFor(Key::ProcEventCoalesceInterval, D::ProcEventCoalesceInterval));
+
+  m_settings.rxBufferSize = getUnsignedFor(Key::RxBufferSize, D::RxBufferSize);
+  m_settings.txBufferSize = getUnsignedFor(Key::TxBufferSize, D::TxBufferSize);
+  m_settings.msgBufferSize = getUnsignedFor(Key::MsgBufferSize, D::MsgBufferSize);
+  m_settings.smapsRSSThreshold = getUnsignedFor(Key::SmapsRSSThreshold, D::SmapsRSSThreshold);
+  m_settings.samplingThreads = getUnsignedFor(Key::SamplingThreads, D::SamplingThreads);
+  m_settings.procAcctBatchSize = getUnsignedFor(Key::ProcAcctBatchSize, D::ProcAcctBatchSize);
+  m_settings.smapsSampleInterval = getUnsignedFor(Key::SmapsSampleInterval, D::SmapsSampleInterval);
+  m_settings.procEventBatchSize = getUnsignedFor(Key::ProcEventBatchSize, D::ProcEventBatchSize);
+  m_settings.threadTopCount = getUnsignedFor(Key::ThreadTopCount, D::ThreadTopCount);
+  m_settings.threadCPUThreshold =
+      static_cast<uint32_t>(getUnsignedFor(Key::ThreadCPUThreshold, D::ThreadCPUThreshold));
+
+  auto port = getUnsignedFor(Key::TCPServerPort, D::TCPServerPort);
+  if ((port == 0) || (port > UINT16_MAX)) {
+    logWarn() << "Invalid TCP server port " << port << ". Using default";
+    port = std::stoull(tkmDefaults.getFor(D::TCPServerPort));
+  }
+  m_settings.tcpServerPort = static_cast<uint16_t>(port);
+
+  m_settings.selfLowerPriority = getBoolFor(Key::SelfLowerPriority);
+  m_settings.readProcAtInit = getBoolFor(Key::ReadProcAtInit);
+  m_settings.enableProcEvent = getBoolFor(Key::EnableProcEvent);
+  m_settings.enableProcAcct = getBoolFor(Key::EnableProcAcct);
+  m_settings.enableProcExitAcct = getBoolFor(Key::EnableProcExitAcct);
+  m_settings.enableTCPServer = getBoolFor(Key::EnableTCPServer);
+  m_settings.enableUDSServer = getBoolFor(Key::EnableUDSServer);
+  m_settings.enableStartupData = getBoolFor(Key::EnableStartupData);
+  m_settings.enableProcFDCount = getBoolFor(Key::EnableProcFDCount);
+  m_settings.enableSysProcVMStat = getBoolFor(Key::EnableSysProcVMStat);
+  m_settings.updateOnProcEvent = getBoolFor(Key::UpdateOnProcEvent);
+  m_settings.enableProcPidFd = getBoolFor(Key::EnableProcPidFd);
+  m_settings.resolveProcExeName = getBoolFor(Key::ResolveProcExeName);
+  m_settings.enableCGroupStat = getBoolFor(Key::EnableCGroupStat);
+  m_settings.tcpActiveWakeLock = getBoolFor(Key::TCPActiveWakeLock);
+  m_settings.udsMonitorCollectorInactivity = getBoolFor(Key::UDSMonitorCollectorInactivity);
 }
 
 auto Options::getFor(Key key) -> string const
@@ -206,6 +297,13 @@ auto Options::getFor(Key key) -> string const
       return prop.value_or(tkmDefaults.getFor(Defaults::Default::EnableProcAcct));
     }
     return tkmDefaults.getFor(Defaults::Default::EnableProcAcct);
+  case Key::EnableProcExitAcct:
+    if (hasConfigFile()) {
+      const optional<string> prop =
+          m_configFile->getPropertyValue("monitor", -1, "EnableProcExitAcct");
+      return prop.value_or(tkmDefaults.getFor(Defaults::Default::EnableProcExitAcct));
+    }
+    return tkmDefaults.getFor(Defaults::Default::EnableProcExitAcct);
   case Key::EnableTCPServer:
     if (hasConfigFile()) {
       const optional<string> prop =
@@ -248,6 +346,147 @@ auto Options::getFor(Key key) -> string const
       return prop.value_or(tkmDefaults.getFor(Defaults::Default::UpdateOnProcEvent));
     }
     return tkmDefaults.getFor(Defaults::Default::UpdateOnProcEvent);
+  case Key::EnableProcPidFd:
+    if (hasConfigFile()) {
+      const optional<string> prop =
+          m_configFile->getPropertyValue("monitor", -1, "EnableProcPidFd");
+      return prop.value_or(tkmDefaults.getFor(Defaults::Default::EnableProcPidFd));
+    }
+    return tkmDefaults.getFor(Defaults::Default::EnableProcPidFd);
+  case Key::ResolveProcExeName:
+    if (hasConfigFile()) {
+      const optional<string> prop =
+          m_configFile->getPropertyValue("monitor", -1, "ResolveProcExeName");
+      return prop.value_or(tkmDefaults.getFor(Defaults::Default::ResolveProcExeName));
+    }
+    return tkmDefaults.getFor(Defaults::Default::ResolveProcExeName);
+  case Key::EnableCGroupStat:
+    if (hasConfigFile()) {
+      const optional<string> prop =
+          m_configFile->getPropertyValue("monitor", -1, "EnableCGroupStat");
+      return prop.value_or(tkmDefaults.getFor(Defaults::Default::EnableCGroupStat));
+    }
+    return tkmDefaults.getFor(Defaults::Default::EnableCGroupStat);
+  case Key::SamplingThreads:
+    if (hasConfigFile()) {
+      const optional<string> prop =
+          m_configFile->getPropertyValue("monitor", -1, "SamplingThreads");
+
+      try {
+        std::stoul(prop.value_or(tkmDefaults.getFor(Defaults::Default::SamplingThreads)));
+      } catch (...) {
+        return tkmDefaults.getFor(Defaults::Default::SamplingThreads);
+      }
+
+      return prop.value_or(tkmDefaults.getFor(Defaults::Default::SamplingThreads));
+    }
+    return tkmDefaults.getFor(Defaults::Default::SamplingThreads);
+  case Key::ProcAcctBatchSize:
+    if (hasConfigFile()) {
+      const optional<string> prop =
+          m_configFile->getPropertyValue("monitor", -1, "ProcAcctBatchSize");
+
+      try {
+        std::stoul(prop.value_or(tkmDefaults.getFor(Defaults::Default::ProcAcctBatchSize)));
+      } catch (...) {
+        return tkmDefaults.getFor(Defaults::Default::ProcAcctBatchSize);
+      }
+
+      return prop.value_or(tkmDefaults.getFor(Defaults::Default::ProcAcctBatchSize));
+    }
+    return tkmDefaults.getFor(Defaults::Default::ProcAcctBatchSize);
+  case Key::SmapsSampleInterval:
+    if (hasConfigFile()) {
+      const optional<string> prop =
+          m_configFile->getPropertyValue("monitor", -1, "SmapsSampleInterval");
+
+      try {
+        std::stoul(prop.value_or(tkmDefaults.getFor(Defaults::Default::SmapsSampleInterval)));
+      } catch (...) {
+        return tkmDefaults.getFor(Defaults::Default::SmapsSampleInterval);
+      }
+
+      return prop.value_or(tkmDefaults.getFor(Defaults::Default::SmapsSampleInterval));
+    }
+    return tkmDefaults.getFor(Defaults::Default::SmapsSampleInterval);
+  case Key::SmapsRSSThreshold:
+    if (hasConfigFile()) {
+      const optional<string> prop =
+          m_configFile->getPropertyValue("monitor", -1, "SmapsRSSThreshold");
+
+      try {
+        std::stoul(prop.value_or(tkmDefaults.getFor(Defaults::Default::SmapsRSSThreshold)));
+      } catch (...) {
+        return tkmDefaults.getFor(Defaults::Default::SmapsRSSThreshold);
+      }
+
+      return prop.value_or(tkmDefaults.getFor(Defaults::Default::SmapsRSSThreshold));
+    }
+    return tkmDefaults.getFor(Defaults::Default::SmapsRSSThreshold);
+  case Key::ProcEventBatchSize:
+    if (hasConfigFile()) {
+      const optional<string> prop =
+          m_configFile->getPropertyValue("monitor", -1, "ProcEventBatchSize");
+
+      try {
+        if (std::stoul(prop.value_or(tkmDefaults.getFor(Defaults::Default::ProcEventBatchSize))) ==
+            0) {
+          return tkmDefaults.getFor(Defaults::Default::ProcEventBatchSize);
+        }
+      } catch (...) {
+        return tkmDefaults.getFor(Defaults::Default::ProcEventBatchSize);
+      }
+
+      return prop.value_or(tkmDefaults.getFor(Defaults::Default::ProcEventBatchSize));
+    }
+    return tkmDefaults.getFor(Defaults::Default::ProcEventBatchSize);
+  case Key::ProcEventCoalesceInterval:
+    if (hasConfigFile()) {
+      const optional<string> prop =
+          m_configFile->getPropertyValue("monitor", -1, "ProcEventCoalesceInterval");
+
+      try {
+        std::stoul(prop.value_or(tkmDefaults.getFor(Defaults::Default::ProcEventCoalesceInterval)));
+      } catch (...) {
+        return tkmDefaults.getFor(Defaults::Default::ProcEventCoalesceInterval);
+      }
+
+      return prop.value_or(tkmDefaults.getFor(Defaults::Default::ProcEventCoalesceInterval));
+    }
+    return tkmDefaults.getFor(Defaults::Default::ProcEventCoalesceInterval);
+  case Key::ThreadCPUThreshold:
+    if (hasConfigFile()) {
+      const optional<string> prop =
+          m_configFile->getPropertyValue("monitor", -1, "ThreadCPUThreshold");
+
+      try {
+        if (std::stoul(prop.value_or(tkmDefaults.getFor(Defaults::Default::ThreadCPUThreshold))) >
+            UINT32_MAX) {
+          return tkmDefaults.getFor(Defaults::Default::ThreadCPUThreshold);
+        }
+      } catch (...) {
+        return tkmDefaults.getFor(Defaults::Default::ThreadCPUThreshold);
+      }
+
+      return prop.value_or(tkmDefaults.getFor(Defaults::Default::ThreadCPUThreshold));
+    }
+    return tkmDefaults.getFor(Defaults::Default::ThreadCPUThreshold);
+  case Key::ThreadTopCount:
+    if (hasConfigFile()) {
+      const optional<string> prop =
+          m_configFile->getPropertyValue("monitor", -1, "ThreadTopCount");
+
+      try {
+        if (std::stoul(prop.value_or(tkmDefaults.getFor(Defaults::Default::ThreadTopCount))) == 0) {
+          return tkmDefaults.getFor(Defaults::Default::ThreadTopCount);
+        }
+      } catch (...) {
+        return tkmDefaults.getFor(Defaults::Default::ThreadTopCount);
+      }
+
+      return prop.value_or(tkmDefaults.getFor(Defaults::Default::ThreadTopCount));
+    }
+    return tkmDefaults.getFor(Defaults::Default::ThreadTopCount);
   case Key::CollectorInactiveTimeout:
     if (hasConfigFile()) {
       const optional<string> prop =
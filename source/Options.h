@@ -12,6 +12,8 @@
 #pragma once
 
 #include <any>
+#include <chrono>
+#include <cstdint>
 #include <string>
 
 #include "Defaults.h"
@@ -42,12 +44,16 @@ public:
     ReadProcAtInit,
     EnableProcEvent,
     EnableProcAcct,
+    EnableProcExitAcct,
     EnableTCPServer,
     EnableUDSServer,
     EnableStartupData,
     EnableProcFDCount,
     EnableSysProcVMStat,
     UpdateOnProcEvent,
+    EnableProcPidFd,
+    ResolveProcExeName,
+    EnableCGroupStat,
     StartupDataCleanupTime,
     TCPServerAddress,
     TCPServerPort,
@@ -55,17 +61,77 @@ public:
     CollectorInactiveTimeout,
     UDSMonitorCollectorInactivity,
     TCPActiveWakeLock,
+    SamplingThreads,
+    ProcAcctBatchSize,
+    SmapsSampleInterval,
+    SmapsRSSThreshold,
+    ProcEventBatchSize,
+    ProcEventCoalesceInterval,
+    ThreadCPUThreshold,
+    ThreadTopCount,
   };
 
+  // Options parsed and validated once at construction for hot paths
+  typedef struct Settings {
+    std::string logLevel;
+    std::string containersPath;
+    std::string profModeIfPath;
+    std::string tcpServerAddress;
+    std::string udsServerSocketPath;
+    std::chrono::microseconds prodModeFastLaneInt{0};
+    std::chrono::microseconds prodModePaceLaneInt{0};
+    std::chrono::microseconds prodModeSlowLaneInt{0};
+    std::chrono::microseconds profModeFastLaneInt{0};
+    std::chrono::microseconds profModePaceLaneInt{0};
+    std::chrono::microseconds profModeSlowLaneInt{0};
+    std::chrono::microseconds startupDataCleanupTime{0};
+    std::chrono::microseconds collectorInactiveTimeout{0};
+    std::chrono::microseconds procEventCoalesceInterval{0};
+    uint64_t rxBufferSize = 0;
+    uint64_t txBufferSize = 0;
+    uint64_t msgBufferSize = 0;
+    uint64_t smapsRSSThreshold = 0;
+    size_t samplingThreads = 0;
+    size_t procAcctBatchSize = 0;
+    size_t smapsSampleInterval = 0;
+    size_t procEventBatchSize = 0;
+    size_t threadTopCount = 0;
+    uint32_t threadCPUThreshold = 0;
+    uint16_t tcpServerPort = 0;
+    bool selfLowerPriority = false;
+    bool readProcAtInit = false;
+    bool enableProcEvent = false;
+    bool enableProcAcct = false;
+    bool enableProcExitAcct = false;
+    bool enableTCPServer = false;
+    bool enableUDSServer = false;
+    bool enableStartupData = false;
+    bool enableProcFDCount = false;
+    bool enableSysProcVMStat = false;
+    bool updateOnProcEvent = false;
+    bool enableProcPidFd = false;
+    bool resolveProcExeName = false;
+    bool enableCGroupStat = false;
+    bool tcpActiveWakeLock = false;
+    bool udsMonitorCollectorInactivity = false;
+  } Settings;
+
 public:
   explicit Options(const std::string &configFile);
 
   auto getFor(Key key) -> std::string const;
+  auto getSettings() -> const Settings & { return m_settings; }
   bool hasConfigFile() { return m_configFile != nullptr; }
   auto getConfigFile() -> std::shared_ptr<bswi::kf::KeyFile> { return m_configFile; }
 
+private:
+  void loadSettings(void);
+  auto getBoolFor(Key key) -> bool;
+  auto getUnsignedFor(Key key, Defaults::Default def) -> uint64_t;
+
 private:
   std::shared_ptr<bswi::kf::KeyFile> m_configFile = nullptr;
+  Settings m_settings{};
 };
 
 } // namespace tkm::monitor
@@ -0,0 +1,160 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     PressureTrigger Class
+ * @details   Kernel PSI triggers watched for stall events
+ *-
+ */
+
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "PressureTrigger.h"
+#include "ProcfsFile.h"
+
+namespace tkm::monitor
+{
+
+bool parsePressureTrigger(const std::string &str, PressureTriggerSpec &spec)
+{
+  std::vector<std::string> tokens;
+  std::stringstream ss(str);
+  std::string token;
+
+  while (std::getline(ss, token, ':')) {
+    tokens.push_back(token);
+  }
+  if (tokens.size() != 4) {
+    return false;
+  }
+
+  PressureTriggerSpec result{.resource = tokens[0], .type = tokens[1]};
+  if ((result.resource != "cpu") && (result.resource != "memory") && (result.resource != "io") &&
+      (result.resource != "irq")) {
+    return false;
+  }
+  if ((result.type != "some") && (result.type != "full")) {
+    return false;
+  }
+  if (!ProcfsLine::toUnsigned(tokens[2], result.stallUsec) ||
+      !ProcfsLine::toUnsigned(tokens[3], result.windowUsec)) {
+    return false;
+  }
+  if ((result.windowUsec < PressureTriggerMinWindow) ||
+      (result.windowUsec > PressureTriggerMaxWindow) || (result.stallUsec == 0) ||
+      (result.stallUsec > result.windowUsec)) {
+    return false;
+  }
+
+  spec = result;
+  return true;
+}
+
+PressureTrigger::~PressureTrigger()
+{
+  stop();
+
+  for (const auto fd : m_fds) {
+    ::close(fd);
+  }
+  m_fds.clear();
+}
+
+bool PressureTrigger::addTrigger(const std::string &path, const PressureTriggerSpec &spec)
+{
+  if (isRunning()) {
+    return false;
+  }
+
+  int fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  // One trigger per fd, the kernel expects the terminating null
+  const std::string trigger =
+      spec.type + " " + std::to_string(spec.stallUsec) + " " + std::to_string(spec.windowUsec);
+  if (::write(fd, trigger.c_str(), trigger.size() + 1) < 0) {
+    ::close(fd);
+    return false;
+  }
+
+  m_triggers.push_back(spec);
+  m_fds.push_back(fd);
+
+  return true;
+}
+
+bool PressureTrigger::start(const Notify &notify)
+{
+  if (isRunning() || m_fds.empty()) {
+    return false;
+  }
+
+  m_stopFd = ::eventfd(0, EFD_CLOEXEC);
+  if (m_stopFd < 0) {
+    return false;
+  }
+
+  m_notify = notify;
+  m_thread = std::thread([this]() { watcher(); });
+
+  return true;
+}
+
+void PressureTrigger::stop(void)
+{
+  if (!isRunning()) {
+    return;
+  }
+
+  const uint64_t value = 1;
+  while ((::write(m_stopFd, &value, sizeof(value)) < 0) && (errno == EINTR)) {
+  }
+  m_thread.join();
+
+  ::close(m_stopFd);
+  m_stopFd = -1;
+}
+
+void PressureTrigger::watcher(void)
+{
+  std::vector<struct pollfd> fds;
+
+  for (const auto fd : m_fds) {
+    fds.push_back({.fd = fd, .events = POLLPRI, .revents = 0});
+  }
+  fds.push_back({.fd = m_stopFd, .events = POLLIN, .revents = 0});
+
+  while (true) {
+    if (::poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+
+    if (fds.back().revents & POLLIN) {
+      break;
+    }
+
+    for (size_t i = 0; i < m_fds.size(); i++) {
+      if (fds[i].revents & POLLERR) {
+        // The monitored resource is gone (i.e. removed cgroup)
+        fds[i].fd = -1;
+      } else if (fds[i].revents & POLLPRI) {
+        m_eventCount++;
+        m_notify(i);
+      }
+    }
+  }
+}
+
+} // namespace tkm::monitor
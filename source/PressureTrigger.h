@@ -0,0 +1,85 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     PressureTrigger Class
+ * @details   Kernel PSI triggers watched for stall events
+ *-
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tkm::monitor
+{
+
+// Kernel limits for the trigger time window
+constexpr uint64_t PressureTriggerMinWindow = 500000;
+constexpr uint64_t PressureTriggerMaxWindow = 10000000;
+
+/*
+ * Trigger configured as "<resource>:<some|full>:<stall_us>:<window_us>"
+ * (i.e. "memory:some:150000:1000000" for 150ms stall within 1s)
+ */
+typedef struct PressureTriggerSpec {
+  std::string resource{};
+  std::string type{};
+  uint64_t stallUsec = 0;
+  uint64_t windowUsec = 0;
+} PressureTriggerSpec;
+
+// False if the format or the values are not accepted by the kernel
+bool parsePressureTrigger(const std::string &str, PressureTriggerSpec &spec);
+
+/*
+ * A PSI file fd with a trigger written reports POLLPRI once per window when
+ * the stall threshold is crossed. The fds are always readable so they cannot
+ * be added to the level triggered event loop, a watcher thread blocks in
+ * poll for POLLPRI instead and calls the notify callback with the trigger
+ * index. The owner has to hand the event back to its event loop.
+ */
+class PressureTrigger
+{
+public:
+  using Notify = std::function<void(size_t index)>;
+
+public:
+  PressureTrigger() = default;
+  ~PressureTrigger();
+
+public:
+  PressureTrigger(PressureTrigger const &) = delete;
+  void operator=(PressureTrigger const &) = delete;
+
+public:
+  // Register the trigger on the pressure file (i.e. /proc/pressure/memory)
+  bool addTrigger(const std::string &path, const PressureTriggerSpec &spec);
+  bool start(const Notify &notify);
+  void stop(void);
+
+  bool isRunning(void) const { return m_thread.joinable(); }
+  auto getTriggers(void) const -> const std::vector<PressureTriggerSpec> & { return m_triggers; }
+  auto getEventCount(void) const -> uint64_t { return m_eventCount.load(); }
+
+private:
+  void watcher(void);
+
+private:
+  std::vector<PressureTriggerSpec> m_triggers{};
+  std::vector<int> m_fds{};
+  std::atomic<uint64_t> m_eventCount{0};
+  std::thread m_thread{};
+  Notify m_notify = nullptr;
+  int m_stopFd = -1;
+};
+
+} // namespace tkm::monitor
@@ -10,6 +10,11 @@
  */
 
 #include "netlink/errno.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <linux/genetlink.h>
 #include <linux/taskstats.h>
 #include <netlink/attr.h>
 #include <netlink/genl/ctrl.h>
@@ -17,13 +22,67 @@
 #include <netlink/msg.h>
 #include <netlink/netlink.h>
 #include <netlink/socket.h>
+#include <sys/sysinfo.h>
+#include <unistd.h>
 
 #include "Application.h"
 #include "ProcAcct.h"
 
 #define average_ms(t, c) (t / 1000000ULL / (c ? c : 1))
 
-static void processDelayAcct(struct taskstats *t)
+// Batched requests are fixed size TASKSTATS_CMD_GET messages with a PID attribute
+constexpr size_t NlMsgHdrLen = sizeof(struct nlmsghdr);
+constexpr size_t GenlMsgHdrLen = sizeof(struct genlmsghdr);
+constexpr size_t NlAttrHdrLen = sizeof(struct nlattr);
+constexpr size_t ProcAcctRequestSize =
+    NlMsgHdrLen + GenlMsgHdrLen + NlAttrHdrLen + sizeof(uint32_t);
+constexpr size_t ProcAcctRxBufferSize = 32768;
+constexpr size_t ProcAcctMaxBatchSize = 4096;
+constexpr size_t ProcAcctDefaultBatchSize = 128;
+constexpr std::chrono::seconds ProcAcctReplyTimeout{2};
+
+static auto alignTo4(size_t len) -> size_t
+{
+  return (len + 3) & ~static_cast<size_t>(3);
+}
+
+static auto findAttr(const uint8_t *buf, size_t len, uint16_t type, size_t &attrLen)
+    -> const uint8_t *
+{
+  size_t offset = 0;
+
+  while (offset + NlAttrHdrLen <= len) {
+    const auto *nla = reinterpret_cast<const struct nlattr *>(buf + offset);
+    const size_t nlaLen = nla->nla_len;
+
+    if ((nlaLen < NlAttrHdrLen) || (offset + nlaLen > len)) {
+      return nullptr;
+    }
+
+    if ((nla->nla_type & NLA_TYPE_MASK) == type) {
+      attrLen = nlaLen - NlAttrHdrLen;
+      return buf + offset + NlAttrHdrLen;
+    }
+
+    offset += alignTo4(nlaLen);
+  }
+
+  return nullptr;
+}
+
+static auto getPossibleCPUs(void) -> std::string
+{
+  std::ifstream possible{"/sys/devices/system/cpu/possible"};
+  std::string mask;
+
+  if (possible.is_open() && std::getline(possible, mask) && !mask.empty()) {
+    return mask;
+  }
+
+  return std::string("0-") + std::to_string(std::max(get_nprocs_conf(), 1) - 1);
+}
+
+static void processDelayAcct(const struct taskstats *t)
 {
   auto entry = App()->getProcRegistry()->getProcEntry(static_cast<int>(t->ac_pid));
 
@@ -117,16 +176,10 @@ ProcAcct::ProcAcct(const std::shared_ptr<Options> options)
 : Pollable("ProcAcct")
 , m_options(options)
 {
-  long msgBufferSize, txBufferSize, rxBufferSize;
+  const auto msgBufferSize = static_cast<long>(m_options->getSettings().msgBufferSize);
+  const auto txBufferSize = static_cast<long>(m_options->getSettings().txBufferSize);
+  const auto rxBufferSize = static_cast<long>(m_options->getSettings().rxBufferSize);
   int err = NLE_SUCCESS;
-
-  try {
-    msgBufferSize = std::stol(m_options->getFor(Options::Key::MsgBufferSize));
-    txBufferSize = std::stol(m_options->getFor(Options::Key::TxBufferSize));
-    rxBufferSize = std::stol(m_options->getFor(Options::Key::RxBufferSize));
-  } catch (std::exception &e) {
-    throw std::runtime_error("Invalid TX/RX/MSG buffer size in configuration");
-  }
   logDebug() << "Netlink buffers msgBufferSize=" << msgBufferSize
              << " txBufferSize=" << txBufferSize << " rxBufferSize=" << rxBufferSize;
 
@@ -176,10 +229,36 @@ ProcAcct::ProcAcct(const std::shared_ptr<Options> options)
     throw std::runtime_error("Fail to set message callback");
   }
 
+  m_batchSize = m_options->getSettings().procAcctBatchSize;
+  m_exitAcct = m_options->getSettings().enableProcExitAcct;
+  if (m_exitAcct && (m_batchSize == 0)) {
+    // Exit records are received on the batched requests socket
+    logInfo() << "ProcAcct exit accounting requires batched requests";
+    m_batchSize = ProcAcctDefaultBatchSize;
+  }
+
+  if (m_batchSize > 0) {
+    if (m_batchSize > ProcAcctMaxBatchSize) {
+      logWarn() << "ProcAcct batch size limited to " << ProcAcctMaxBatchSize;
+      m_batchSize = ProcAcctMaxBatchSize;
+    }
+    openRawSocket(rxBufferSize, txBufferSize);
+    logDebug() << "ProcAcct batched requests enabled with batchSize=" << m_batchSize;
+  }
+
+  if (m_exitAcct && !setExitListener(true)) {
+    logWarn() << "ProcAcct exit accounting not available";
+    m_exitAcct = false;
+  }
+
   lateSetup(
       [this]() {
         int nl_err = NLE_SUCCESS;
 
+        if (m_batchSize > 0) {
+          return readBatch();
+        }
+
         if ((nl_err = nl_recvmsgs_default(m_nlSock)) < 0) {
           if ((nl_err != -NLE_AGAIN) && (nl_err != -NLE_BUSY) && (nl_err != -NLE_OBJ_NOTFOUND)) {
             logError() << "Error receiving procacct message: " << nl_geterror(nl_err);
@@ -189,7 +268,7 @@ ProcAcct::ProcAcct(const std::shared_ptr<Options> options)
 
         return true;
       },
-      m_sockFd,
+      (m_batchSize > 0) ? m_rawFd : m_sockFd,
       bswi::event::IPollable::Events::Level,
       bswi::event::IEventSource::Priority::Normal);
 
@@ -208,17 +287,308 @@ void ProcAcct::setEventSource(bool enabled)
 
 ProcAcct::~ProcAcct()
 {
+  if (m_rawFd != -1) {
+    if (m_exitAcct) {
+      setExitListener(false);
+    }
+    ::close(m_rawFd);
+  }
+
   if (m_nlSock != nullptr) {
     nl_close(m_nlSock);
     nl_socket_free(m_nlSock);
   }
 }
 
+void ProcAcct::openRawSocket(long rxBufferSize, long txBufferSize)
+{
+  int rxSize = static_cast<int>(rxBufferSize);
+  int txSize = static_cast<int>(txBufferSize);
+
+  m_rawFd = ::socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_GENERIC);
+  if (m_rawFd == -1) {
+    throw std::runtime_error("Fail to create taskstats netlink socket");
+  }
+
+  if (setsockopt(m_rawFd, SOL_SOCKET, SO_RCVBUF, &rxSize, sizeof(rxSize)) == -1) {
+    throw std::runtime_error("Fail to set taskstats rx socket buffer size");
+  }
+
+  if (setsockopt(m_rawFd, SOL_SOCKET, SO_SNDBUF, &txSize, sizeof(txSize)) == -1) {
+    throw std::runtime_error("Fail to set taskstats tx socket buffer size");
+  }
+
+  struct sockaddr_nl addr {};
+  addr.nl_family = AF_NETLINK;
+  if (bind(m_rawFd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == -1) {
+    throw std::runtime_error("Fail to bind taskstats netlink socket");
+  }
+
+  m_txBuffer.resize(m_batchSize * ProcAcctRequestSize);
+  m_rxBuffer.resize(ProcAcctRxBufferSize);
+}
+
+bool ProcAcct::setExitListener(bool enabled)
+{
+  const std::string cpuMask = getPossibleCPUs();
+  const size_t attrLen = NlAttrHdrLen + cpuMask.size() + 1;
+  const size_t msgLen = NlMsgHdrLen + GenlMsgHdrLen + alignTo4(attrLen);
+  std::vector<uint8_t> buf(msgLen, 0);
+
+  auto *nlh = reinterpret_cast<struct nlmsghdr *>(buf.data());
+  nlh->nlmsg_len = static_cast<uint32_t>(msgLen);
+  nlh->nlmsg_type = static_cast<uint16_t>(m_nlFamily);
+  nlh->nlmsg_flags = NLM_F_REQUEST;
+  nlh->nlmsg_seq = 0; // PID requests use the PID as sequence number
+
+  auto *genlh = reinterpret_cast<struct genlmsghdr *>(buf.data() + NlMsgHdrLen);
+  genlh->cmd = TASKSTATS_CMD_GET;
+  genlh->version = TASKSTATS_VERSION;
+
+  auto *nla = reinterpret_cast<struct nlattr *>(buf.data() + NlMsgHdrLen + GenlMsgHdrLen);
+  nla->nla_len = static_cast<uint16_t>(attrLen);
+  nla->nla_type = enabled ? TASKSTATS_CMD_ATTR_REGISTER_CPUMASK
+                          : TASKSTATS_CMD_ATTR_DEREGISTER_CPUMASK;
+  memcpy(buf.data() + NlMsgHdrLen + GenlMsgHdrLen + NlAttrHdrLen,
+         cpuMask.c_str(),
+         cpuMask.size());
+
+  struct sockaddr_nl addr {};
+  addr.nl_family = AF_NETLINK;
+
+  if (sendto(m_rawFd,
+             buf.data(),
+             buf.size(),
+             0,
+             reinterpret_cast<struct sockaddr *>(&addr),
+             sizeof(addr)) == -1) {
+    logError() << "Cannot send taskstats exit listener request. Reason: " << strerror(errno);
+    return false;
+  }
+
+  logDebug() << "ProcAcct exit listener " << (enabled ? "registered" : "deregistered")
+             << " for cpus=" << cpuMask;
+
+  return true;
+}
+
+void ProcAcct::flushTaskAcct(void)
+{
+  if (m_batchSize == 0) {
+    return;
+  }
+
+  // Replies lost without an error (e.g. socket overrun) must not block the pipeline
+  if ((m_inFlight > 0) &&
+      ((std::chrono::steady_clock::now() - m_lastActivity) > ProcAcctReplyTimeout)) {
+    logWarn() << "Drop " << m_inFlight << " taskstats requests without reply";
+    m_inFlight = 0;
+  }
+
+  sendBatch();
+}
+
+bool ProcAcct::sendBatch(void)
+{
+  size_t offset = 0;
+  size_t count = 0;
+
+  while (!m_pendingPids.empty() && ((m_inFlight + count) < m_batchSize)) {
+    const auto pid = static_cast<uint32_t>(m_pendingPids.front());
+    uint8_t *buf = m_txBuffer.data() + offset;
+    m_pendingPids.pop_front();
+
+    auto *nlh = reinterpret_cast<struct nlmsghdr *>(buf);
+    nlh->nlmsg_len = static_cast<uint32_t>(ProcAcctRequestSize);
+    nlh->nlmsg_type = static_cast<uint16_t>(m_nlFamily);
+    nlh->nlmsg_flags = NLM_F_REQUEST;
+    nlh->nlmsg_seq = pid; // replies carry the sequence so we can map errors
+    nlh->nlmsg_pid = 0;
+
+    auto *genlh = reinterpret_cast<struct genlmsghdr *>(buf + NlMsgHdrLen);
+    genlh->cmd = TASKSTATS_CMD_GET;
+    genlh->version = TASKSTATS_VERSION;
+    genlh->reserved = 0;
+
+    auto *nla = reinterpret_cast<struct nlattr *>(buf + NlMsgHdrLen + GenlMsgHdrLen);
+    nla->nla_len = static_cast<uint16_t>(NlAttrHdrLen + sizeof(pid));
+    nla->nla_type = TASKSTATS_CMD_ATTR_PID;
+    memcpy(buf + NlMsgHdrLen + GenlMsgHdrLen + NlAttrHdrLen, &pid, sizeof(pid));
+
+    offset += ProcAcctRequestSize;
+    count++;
+  }
+
+  if (count == 0) {
+    return true;
+  }
+
+  struct sockaddr_nl addr {};
+  addr.nl_family = AF_NETLINK;
+
+  // All requests go to the kernel in a single sendmsg
+  if (sendto(m_rawFd,
+             m_txBuffer.data(),
+             offset,
+             0,
+             reinterpret_cast<struct sockaddr *>(&addr),
+             sizeof(addr)) == -1) {
+    // The entries will request again after their reply timeout
+    logWarn() << "Cannot send taskstats batch of " << count
+              << " requests. Reason: " << strerror(errno);
+    return false;
+  }
+
+  m_inFlight += count;
+  m_lastActivity = std::chrono::steady_clock::now();
+
+  return true;
+}
+
+bool ProcAcct::readBatch(void)
+{
+  while (true) {
+    auto len = recv(m_rawFd, m_rxBuffer.data(), m_rxBuffer.size(), MSG_DONTWAIT);
+
+    if (len == -1) {
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        break;
+      } else if (errno == EINTR) {
+        continue;
+      } else if (errno == ENOBUFS) {
+        logWarn() << "ProcAcct netlink buffer space error";
+        m_inFlight = 0;
+        continue;
+      }
+
+      logError() << "Error receiving procacct message: " << strerror(errno);
+      return false;
+    } else if (len == 0) {
+      break;
+    }
+
+    parseBatch(m_rxBuffer.data(), static_cast<size_t>(len));
+  }
+
+  // Keep the pipeline full while there are queued requests
+  if (!m_pendingPids.empty()) {
+    sendBatch();
+  }
+
+  return true;
+}
+
+void ProcAcct::parseBatch(const uint8_t *buf, size_t len)
+{
+  size_t offset = 0;
+
+  while (offset + NlMsgHdrLen <= len) {
+    const auto *nlh = reinterpret_cast<const struct nlmsghdr *>(buf + offset);
+    const size_t msgLen = nlh->nlmsg_len;
+
+    if ((msgLen < NlMsgHdrLen) || (offset + msgLen > len)) {
+      logError() << "Malformed taskstats reply";
+      return;
+    }
+
+    const uint8_t *payload = buf + offset + NlMsgHdrLen;
+    const size_t payloadLen = msgLen - NlMsgHdrLen;
+    const int pid = static_cast<int>(nlh->nlmsg_seq);
+    // Exit records sent to the registered listeners have no originating port
+    const bool exitRecord = (nlh->nlmsg_pid == 0);
+
+    // Exit records and listener errors are not replies to our PID requests
+    if ((pid != 0) && !exitRecord) {
+      if (m_inFlight > 0) {
+        m_inFlight--;
+      }
+      m_lastActivity = std::chrono::steady_clock::now();
+    }
+
+    if ((nlh->nlmsg_type == NLMSG_ERROR) && (payloadLen >= sizeof(struct nlmsgerr))) {
+      struct nlmsgerr err {};
+      memcpy(&err, payload, sizeof(err));
+
+      if (pid == 0) {
+        if (err.error != 0) {
+          logError() << "Taskstats exit listener request failed. Reason: "
+                     << strerror(-err.error);
+        }
+      } else if (err.error == -ESRCH) {
+        logDebug() << "Taskstats process gone for pid=" << pid;
+        auto entry = App()->getProcRegistry()->getProcEntry(pid);
+        if (entry != nullptr) {
+          entry->markStale();
+        }
+      } else if (err.error != 0) {
+        logDebug() << "Taskstats request failed for pid=" << pid
+                   << ". Reason: " << strerror(-err.error);
+        auto entry = App()->getProcRegistry()->getProcEntry(pid);
+        if (entry != nullptr) {
+          entry->setUpdateProcAcctPending(false);
+        }
+      }
+    } else if ((nlh->nlmsg_type == m_nlFamily) && (payloadLen >= GenlMsgHdrLen) && exitRecord) {
+      parseExitRecord(payload + GenlMsgHdrLen, payloadLen - GenlMsgHdrLen);
+    } else if ((nlh->nlmsg_type == m_nlFamily) && (payloadLen >= GenlMsgHdrLen)) {
+      size_t aggrLen = 0;
+      size_t statsLen = 0;
+
+      const uint8_t *attrs = payload + GenlMsgHdrLen;
+      const size_t attrsLen = payloadLen - GenlMsgHdrLen;
+      const uint8_t *aggr = findAttr(attrs, attrsLen, TASKSTATS_TYPE_AGGR_PID, aggrLen);
+      if (aggr == nullptr) {
+        aggr = findAttr(attrs, attrsLen, TASKSTATS_TYPE_AGGR_TGID, aggrLen);
+      }
+
+      const uint8_t *stats =
+          (aggr != nullptr) ? findAttr(aggr, aggrLen, TASKSTATS_TYPE_STATS, statsLen) : nullptr;
+      if (stats != nullptr) {
+        // Kernel and header struct versions may differ in size
+        struct taskstats t {};
+        memcpy(&t, stats, std::min(statsLen, sizeof(t)));
+        processDelayAcct(&t);
+      } else {
+        logError() << "Unknown attribute format received";
+      }
+    }
+
+    offset += alignTo4(msgLen);
+  }
+}
+
+void ProcAcct::parseExitRecord(const uint8_t *attrs, size_t len)
+{
+  size_t aggrLen = 0;
+  size_t statsLen = 0;
+
+  // The thread group record only carries delay accounting so we use the per task record
+  const uint8_t *aggr = findAttr(attrs, len, TASKSTATS_TYPE_AGGR_PID, aggrLen);
+  const uint8_t *stats =
+      (aggr != nullptr) ? findAttr(aggr, aggrLen, TASKSTATS_TYPE_STATS, statsLen) : nullptr;
+
+  if (stats == nullptr) {
+    return;
+  }
+
+  struct taskstats t {};
+  memcpy(&t, stats, std::min(statsLen, sizeof(t)));
+  m_exitSummary.add(t);
+}
+
 bool ProcAcct::requestTaskAcct(int pid)
 {
   struct nl_msg *msg = nullptr;
   int err = NLE_SUCCESS;
 
+  if (m_batchSize > 0) {
+    m_pendingPids.push_back(pid);
+    if (m_pendingPids.size() >= m_batchSize) {
+      sendBatch();
+    }
+    return true;
+  }
+
   if (!(msg = nlmsg_alloc())) {
     logError() << "Failed to alloc message: " << nl_geterror(err);
     return false;
@@ -11,12 +11,16 @@
 
 #pragma once
 
+#include <chrono>
+#include <deque>
 #include <netinet/in.h>
 #include <netlink/netlink.h>
 #include <sys/socket.h>
+#include <vector>
 
 #include "Options.h"
 #include "ProcEntry.h"
+#include "ProcExitSummary.h"
 
 #include "../bswinfra/source/Pollable.h"
 
@@ -39,12 +43,34 @@ public:
   auto getShared() -> std::shared_ptr<ProcAcct> { return shared_from_this(); }
   void setEventSource(bool enabled = true);
   bool requestTaskAcct(int pid);
+  void flushTaskAcct(void);
+  auto getBatchSize(void) -> size_t { return m_batchSize; }
+  auto getInFlight(void) -> size_t { return m_inFlight; }
+  auto getExitSummary(void) -> ProcExitSummary & { return m_exitSummary; }
+  bool getExitAcct(void) { return m_exitAcct; }
 
 private:
+  void openRawSocket(long rxBufferSize, long txBufferSize);
+  bool sendBatch(void);
+  bool readBatch(void);
+  void parseBatch(const uint8_t *buf, size_t len);
+  void parseExitRecord(const uint8_t *attrs, size_t len);
+  bool setExitListener(bool enabled);
+
+private:
+  std::chrono::time_point<std::chrono::steady_clock> m_lastActivity{};
   std::shared_ptr<Options> m_options = nullptr;
   struct nl_sock *m_nlSock = nullptr;
+  ProcExitSummary m_exitSummary{"ProcAcctExitSummary"};
+  std::vector<uint8_t> m_txBuffer{};
+  std::vector<uint8_t> m_rxBuffer{};
+  std::deque<int> m_pendingPids{};
+  size_t m_batchSize = 0;
+  size_t m_inFlight = 0;
+  bool m_exitAcct = false;
   int m_nlFamily = 0;
   int m_sockFd = -1;
+  int m_rawFd = -1;
 };
 
 } // namespace tkm::monitor
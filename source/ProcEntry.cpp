@@ -9,19 +9,20 @@
  *-
  */
 
+#include <atomic>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "ProcEntry.h"
 #include "Application.h"
 #include "Helpers.h"
 
-#if __has_include(<filesystem>)
-#include <filesystem>
-namespace fs = std::filesystem;
-#else
-#include <experimental/filesystem>
-namespace fs = std::experimental::filesystem;
-#endif
-
-bool gProcInfoFDCollect = false;
+std::atomic<bool> gProcInfoFDCollect{false};
+std::atomic<size_t> gProcInfoSmapsInterval{1};
+std::atomic<uint64_t> gProcInfoSmapsRSSThreshold{0};
+std::atomic<uint32_t> gProcInfoThreadCPUThreshold{50};
+std::atomic<size_t> gProcInfoThreadTopCount{5};
 
 namespace tkm::monitor
 {
@@ -29,19 +30,78 @@ namespace tkm::monitor
 #ifdef WITH_LXC
 constexpr size_t ContextNameMaxRetry = 10;
 #endif
+#ifdef WITH_PROC_ACCT
+constexpr std::chrono::seconds ProcAcctPendingTimeout{3};
+#endif
+
+static auto statRSSKb(const ProcStatData &data) -> uint64_t
+{
+  static const auto pageSizeKb = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE)) / 1024;
+  return (data.rss > 0) ? static_cast<uint64_t>(data.rss) * pageSizeKb : 0;
+}
 
 ProcEntry::ProcEntry(int pid, const std::string &name)
 : m_pid(pid)
 {
   setName(name);
+  openProcDir();
   initInfoData();
 
   if (App()->getOptions() != nullptr) {
-    if (App()->getOptions()->getFor(Options::Key::EnableProcFDCount) ==
-        tkmDefaults.valFor(Defaults::Val::True)) {
+    const auto &settings = App()->getOptions()->getSettings();
+    if (settings.enableProcFDCount) {
       gProcInfoFDCollect = true;
     }
+    gProcInfoSmapsInterval = settings.smapsSampleInterval;
+    gProcInfoSmapsRSSThreshold = settings.smapsRSSThreshold;
+    gProcInfoThreadCPUThreshold = settings.threadCPUThreshold;
+    gProcInfoThreadTopCount = settings.threadTopCount;
+  }
+}
+
+ProcEntry::~ProcEntry()
+{
+  closeProcDir();
+}
+
+void ProcEntry::openProcDir(void)
+{
+  char path[32];
+
+  snprintf(path, sizeof(path), "/proc/%d", m_pid);
+  m_procDirFd = ::open(path, O_PATH | O_DIRECTORY | O_CLOEXEC);
+  if (m_procDirFd < 0) {
+    // Fallback to path based access (e.g. out of file descriptors)
+    logDebug() << "Cannot open procfs directory for pid=" << m_pid
+               << ". Error: " << strerror(errno);
+    return;
+  }
+
+  // Keep stat open since is read on each update and pread regenerates the content
+  m_statFd = ::openat(m_procDirFd, "stat", O_RDONLY | O_CLOEXEC);
+}
+
+void ProcEntry::closeProcDir(void)
+{
+  if (m_statFd >= 0) {
+    ::close(m_statFd);
+    m_statFd = -1;
   }
+  if (m_procDirFd >= 0) {
+    ::close(m_procDirFd);
+    m_procDirFd = -1;
+  }
+}
+
+auto ProcEntry::openProcFile(const char *name, int flags) -> int
+{
+  if (m_procDirFd >= 0) {
+    return ::openat(m_procDirFd, name, flags | O_CLOEXEC);
+  }
+
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/%d/%s", m_pid, name);
+  return ::open(path, flags | O_CLOEXEC);
 }
 
 #ifdef WITH_PROC_ACCT
@@ -52,12 +112,17 @@ bool ProcEntry::updateProcAcct(void)
   }
 
   if (getUpdateProcAcctPending()) {
-    return true;
+    // Request again if the reply was lost (i.e. batched socket overrun)
+    if ((std::chrono::steady_clock::now() - m_procAcctRequestTime) < ProcAcctPendingTimeout) {
+      return true;
+    }
+    logDebug() << "ProcAcct reply timeout for pid=" << m_pid;
   }
 
   setUpdateProcAcctPending(true);
+  m_procAcctRequestTime = std::chrono::steady_clock::now();
   if (!App()->getProcAcct()->requestTaskAcct(m_pid)) {
-    App()->getProcRegistry()->remProcEntry(m_pid);
+    markStale();
     return false;
   }
 
@@ -67,225 +132,318 @@ bool ProcEntry::updateProcAcct(void)
 
 bool ProcEntry::updateProcInfo(void)
 {
-  bool status = true;
-
-  if (getUpdatePending()) {
+  if (!prepareSample()) {
     return true;
   }
-  setUpdatePending(true);
 
-#ifdef WITH_LXC
-  if (m_contextNameResolveCount++ < ContextNameMaxRetry) {
-    if (m_info.ctx_name() == "unknown") {
-      m_info.set_ctx_id(tkm::getContextId(m_pid));
-      m_info.set_ctx_name(tkm::getContextName(
-          App()->getOptions()->getFor(Options::Key::ContainersPath), m_info.ctx_id()));
-    }
-  }
-#endif
+  sampleInfoData();
+  return publishInfoData();
+}
 
-  try {
-    status = updateInfoData();
-  } catch (std::exception &e) {
-    logError() << "Fail to update info data for PID " << m_pid << ". Exception: " << e.what();
-    status = false;
+bool ProcEntry::prepareSample(void)
+{
+  if (getUpdatePending()) {
+    return false;
   }
 
-  setUpdatePending(false);
-  if (!status) {
-    App()->getProcRegistry()->remProcEntry(m_pid);
+  // Decided on the main loop, the sampler keeps its own reference in case
+  // thread monitoring is disabled meanwhile
+  m_sample.threads = nullptr;
+  if ((m_threads != nullptr) && (m_info.cpu_percent() >= gProcInfoThreadCPUThreshold)) {
+    m_sample.threads = m_threads;
   }
 
-  return status;
+  setUpdatePending(true);
+  return true;
 }
 
-void ProcEntry::initInfoData(void)
+void ProcEntry::setThreadMonitor(bool enabled)
 {
-  std::ifstream statStream{"/proc/" + std::to_string(m_pid) + "/stat"};
+  if (!enabled) {
+    m_threads.reset();
+    m_hotThreads.clear();
+    return;
+  }
 
-  if (!statStream.is_open()) {
-    throw std::runtime_error("Fail to open /proc/" + std::to_string(m_pid) + "/stat file");
+  if (m_threads != nullptr) {
+    return;
   }
 
-  std::string line;
-  if (!std::getline(statStream, line)) {
-    throw std::runtime_error("Fail to read /proc/" + std::to_string(m_pid) + "/stat file");
+  int fd = openProcFile("task", O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    logDebug() << "Cannot open task directory for pid=" << m_pid;
+    return;
   }
 
-  std::vector<std::string> tokens;
-  std::stringstream ss(line);
-  std::string buf;
+  logDebug() << "Enable thread monitoring for pid=" << m_pid << " name=" << getName();
+  m_threads = std::make_shared<ProcThreads>(m_pid, fd, gProcInfoThreadTopCount);
+}
 
-  while (ss >> buf) {
-    tokens.push_back(buf);
-  }
+bool ProcEntry::sampleInfoData(void)
+{
+  m_sample.valid = false;
+  m_sample.threadsValid = false;
 
-  if (tokens.size() < 52) {
-    throw std::runtime_error("Parse fail for /proc/" + std::to_string(m_pid) + "stat file");
-  }
+  try {
+    if (!readProcStat()) {
+      return false;
+    }
 
-  auto afterNameOffset = tokens.size() - 52;
-  m_info.set_pid(static_cast<uint32_t>(std::stoul(tokens[0])));
-  m_info.set_ppid(static_cast<uint32_t>(std::stoul(tokens[3 + afterNameOffset])));
+    m_sample.smapsValid = false;
+    if (needSmapsSample()) {
+      if (!readProcSmapsRollup()) {
+        return false;
+      }
+      m_sample.smapsValid = true;
+    }
 
-  auto cpuTime =
-      std::stoul(tokens[13 + afterNameOffset]) + std::stoul(tokens[14 + afterNameOffset]);
-  m_info.set_cpu_time(cpuTime);
+    if (gProcInfoFDCollect) {
+      if (!countFileDescriptors()) {
+        return false;
+      }
+    }
 
-  // If need to run as root for context identification
-  if (getuid() == 0) {
-    m_info.set_ctx_id(tkm::getContextId(m_pid));
-    m_info.set_ctx_name(tkm::getContextName(
-        App()->getOptions()->getFor(Options::Key::ContainersPath), m_info.ctx_id()));
-  } else {
-    m_info.set_ctx_id(0);
-    m_info.set_ctx_name("generic");
+    if (m_sample.threads != nullptr) {
+      m_sample.threadsValid = m_sample.threads->sample();
+    }
+  } catch (std::exception &e) {
+    logError() << "Fail to update info data for PID " << m_pid << ". Exception: " << e.what();
+    return false;
   }
+
+  m_sample.valid = true;
+  return true;
 }
 
-bool ProcEntry::readProcStat(void)
+bool ProcEntry::publishInfoData(void)
 {
-  std::ifstream statStream{"/proc/" + std::to_string(m_pid) + "/stat"};
-  if (!statStream.is_open()) {
-    return false;
-  }
+  setUpdatePending(false);
 
-  std::string line;
-  if (!std::getline(statStream, line)) {
+  if (!m_sample.valid) {
+    // Removed with the other gone entries by the next registry sweep
+    markStale();
     return false;
   }
 
-  std::vector<std::string> tokens;
-  std::string buf;
-
-  std::stringstream ss(line);
-  while (ss >> buf) {
-    tokens.push_back(buf);
+  // Withdraw the previous values from the context totals before the update
+  if (m_context != nullptr) {
+    m_context->subProcData(m_info);
   }
 
-  if (tokens.size() < 52) {
-    throw std::runtime_error("Fail to parse stat file");
-  }
+  m_statData = m_sample.stat;
 
-  auto afterNameOffset = tokens.size() - 52;
   uint64_t oldCPUTime = m_info.cpu_time();
-  uint64_t newCPUTime =
-      std::stoul(tokens[13 + afterNameOffset]) + std::stoul(tokens[14 + afterNameOffset]);
+  uint64_t newCPUTime = m_statData.utime + m_statData.stime;
 
   m_info.set_cpu_time(newCPUTime);
 
-  auto timeNow = std::chrono::steady_clock::now();
   using USec = std::chrono::microseconds;
 
   if (m_lastUpdateTime.time_since_epoch().count() == 0) {
-    m_lastUpdateTime = timeNow;
+    m_lastUpdateTime = m_sample.time;
     m_info.set_cpu_percent(0);
   } else {
-    auto durationUs = std::chrono::duration_cast<USec>(timeNow - m_lastUpdateTime).count();
-    m_lastUpdateTime = timeNow;
+    auto durationUs = std::chrono::duration_cast<USec>(m_sample.time - m_lastUpdateTime).count();
+    m_lastUpdateTime = m_sample.time;
     m_info.set_cpu_percent(static_cast<uint32_t>(((newCPUTime - oldCPUTime) * 1000000) /
                                                  static_cast<uint64_t>(durationUs)));
   }
 
+  // RSS is updated on every sample while PSS keeps the last smaps_rollup value
+  m_info.set_mem_rss(statRSSKb(m_statData));
+  if (m_sample.smapsValid) {
+    m_smapsData = m_sample.smaps;
+    m_smapsRSS = m_info.mem_rss();
+    m_smapsTime = m_sample.time;
+    m_smapsSkipCount = 0;
+  } else {
+    m_smapsSkipCount++;
+  }
+  m_info.set_mem_pss(m_smapsData.pss);
+
+  if (gProcInfoFDCollect) {
+    m_info.set_fd_count(m_sample.fdCount);
+  }
+
+  if (m_sample.threadsValid && (m_sample.threads == m_threads)) {
+    m_hotThreads = m_threads->getHotThreads();
+  } else if ((m_threads != nullptr) && (m_sample.threads == nullptr)) {
+    // Restart the thread deltas once the process gets busy again
+    m_threads->reset();
+    m_hotThreads.clear();
+  }
+  m_sample.threads = nullptr;
+
+  if (m_context != nullptr) {
+    m_context->addProcData(m_info);
+  }
+
+#ifdef WITH_LXC
+  if (m_contextNameResolveCount++ < ContextNameMaxRetry) {
+    if (m_info.ctx_name() == "unknown") {
+      m_info.set_ctx_id(tkm::getContextId(m_pid));
+      m_info.set_ctx_name(tkm::getContextName(
+          App()->getOptions()->getSettings().containersPath, m_info.ctx_id()));
+      if ((m_context != nullptr) && (m_context->getContextId() != m_info.ctx_id())) {
+        App()->getProcRegistry()->updContextEntry(getShared());
+      }
+    }
+  }
+#endif
+
   return true;
 }
 
-bool ProcEntry::readProcSmapsRollup(void)
+auto ProcEntry::getExeName(void) -> const std::string &
+{
+  if (!m_exeName.empty()) {
+    return m_exeName;
+  }
+
+  int fd = openProcFile("cmdline", O_RDONLY);
+  if (fd >= 0) {
+    tkm::monitor::readProcCmdlineExe(fd, m_exeName);
+    ::close(fd);
+  }
+
+  // Kernel threads have no command line
+  if (m_exeName.empty()) {
+    m_exeName = getName();
+  }
+
+  return m_exeName;
+}
+
+bool ProcEntry::checkAlive(void)
 {
-  std::ifstream memStream{"/proc/" + std::to_string(m_pid) + "/smaps_rollup"};
-  if (!memStream.is_open()) {
+  ProcStatData data{};
+
+  if (!readStatData(data)) {
     return false;
   }
 
-  std::vector<std::string> tokens;
-  std::string line;
-  std::string buf;
+  return data.startTime == m_statData.startTime;
+}
 
-  typedef enum _LineMemData { IGN, RSS, PSS } LineMemData;
+void ProcEntry::initInfoData(void)
+{
+  if (!readStatData(m_statData)) {
+    closeProcDir();
+    throw std::runtime_error("Fail to read /proc/" + std::to_string(m_pid) + "/stat file");
+  }
 
-  size_t complete = 2;
-  while (std::getline(memStream, line)) {
-    LineMemData lineData = LineMemData::IGN;
-    std::stringstream ssm(line);
+  m_info.set_pid(static_cast<uint32_t>(m_statData.pid));
+  m_info.set_ppid(static_cast<uint32_t>(m_statData.ppid));
+  m_info.set_cpu_time(m_statData.utime + m_statData.stime);
 
-    if (line.rfind("Rss:", 0) != std::string::npos) {
-      lineData = LineMemData::RSS;
-    } else if (line.rfind("Pss:", 0) != std::string::npos) {
-      lineData = LineMemData::PSS;
-    }
+  // If need to run as root for context identification
+  if (getuid() == 0) {
+    m_info.set_ctx_id(tkm::getContextId(m_pid));
+    m_info.set_ctx_name(tkm::getContextName(
+        App()->getOptions()->getSettings().containersPath, m_info.ctx_id()));
+  } else {
+    m_info.set_ctx_id(0);
+    m_info.set_ctx_name("generic");
+  }
+}
 
-    if (lineData == LineMemData::IGN) {
-      continue;
-    }
+bool ProcEntry::readStatData(ProcStatData &data)
+{
+  if (m_statFd >= 0) {
+    return tkm::monitor::readProcStat(m_statFd, data);
+  }
 
-    while (ssm >> buf) {
-      tokens.push_back(buf);
-    }
+  int fd = openProcFile("stat", O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
 
-    if (tokens.size() < 3) {
-      logError() << "Proc smaps_rollup file parse error";
-      return false;
-    }
+  auto status = tkm::monitor::readProcStat(fd, data);
+  ::close(fd);
 
-    switch (lineData) {
-    case LineMemData::RSS:
-      m_info.set_mem_rss(std::stoull(tokens[1]));
-      complete--;
-      break;
-    case LineMemData::PSS:
-      m_info.set_mem_pss(std::stoull(tokens[1]));
-      complete--;
-      break;
-    default:
-      break;
-    }
+  return status;
+}
 
-    if (complete == 0) {
-      break;
-    }
-    tokens.clear();
+bool ProcEntry::readProcStat(void)
+{
+  if (!readStatData(m_sample.stat)) {
+    return false;
+  }
+  m_sample.time = std::chrono::steady_clock::now();
+
+  // The open descriptors fail with ESRCH once the task is gone but the path
+  // based fallback can land on a new process reusing our PID
+  if (m_sample.stat.startTime != m_statData.startTime) {
+    logDebug() << "PID reuse detected for pid=" << m_pid;
+    return false;
   }
 
   return true;
 }
 
-bool ProcEntry::countFileDescriptors(void)
+bool ProcEntry::needSmapsSample(void)
 {
-  auto dirIter = fs::directory_iterator("/proc/" + std::to_string(m_pid) + "/fd");
-  auto fdCount = m_info.fd_count();
+  const size_t interval = gProcInfoSmapsInterval;
+  const uint64_t threshold = gProcInfoSmapsRSSThreshold;
 
-  try {
-    fdCount = std::count_if(begin(dirIter), end(dirIter), [](auto &entry) {
-#if __has_include(<filesystem>)
-      return entry.is_symlink();
-#else
-      return fs::is_symlink(entry);
-#endif
-    });
-  } catch (...) {
+  if (interval > 0) {
+    if ((m_smapsTime.time_since_epoch().count() == 0) || (m_smapsSkipCount + 1 >= interval)) {
+      return true;
+    }
+  }
+
+  if (threshold > 0) {
+    const uint64_t rss = statRSSKb(m_sample.stat);
+    const uint64_t delta = (rss > m_smapsRSS) ? (rss - m_smapsRSS) : (m_smapsRSS - rss);
+    if (delta > threshold) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool ProcEntry::readProcSmapsRollup(void)
+{
+  int fd = openProcFile("smaps_rollup", O_RDONLY);
+  if (fd < 0) {
     return false;
   }
 
-  m_info.set_fd_count(fdCount);
+  auto status = tkm::monitor::readProcSmapsRollup(fd, m_sample.smaps);
+  ::close(fd);
+
+  if (!status) {
+    logError() << "Proc smaps_rollup file parse error";
+    return false;
+  }
 
   return true;
 }
 
-bool ProcEntry::updateInfoData(void)
+bool ProcEntry::countFileDescriptors(void)
 {
-  if (!readProcStat()) {
+  int fd = openProcFile("fd", O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
     return false;
   }
 
-  if (!readProcSmapsRollup()) {
+  DIR *dir = ::fdopendir(fd);
+  if (dir == nullptr) {
+    ::close(fd);
     return false;
   }
 
-  if (gProcInfoFDCollect) {
-    if (!countFileDescriptors()) {
-      return false;
+  uint32_t fdCount = 0;
+  struct dirent *dirEntry = nullptr;
+  while ((dirEntry = ::readdir(dir)) != nullptr) {
+    if (dirEntry->d_type == DT_LNK) {
+      fdCount++;
     }
   }
+  ::closedir(dir); // closes fd
+
+  m_sample.fdCount = fdCount;
 
   return true;
 }
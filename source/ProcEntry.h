@@ -12,19 +12,42 @@
 #pragma once
 
 #include <chrono>
+#include <memory>
 #include <string>
+#include <vector>
 #include <taskmonitor/taskmonitor.h>
 
+#include "ContextEntry.h"
 #include "IDataSource.h"
+#include "ProcParser.h"
+#include "ProcThreads.h"
 
 namespace tkm::monitor
 {
 
+class ProcExitWatch;
+
+typedef struct ProcSample {
+  // Set while the process is busy enough to have its threads sampled
+  std::shared_ptr<ProcThreads> threads{};
+  ProcStatData stat{};
+  ProcSmapsData smaps{};
+  uint32_t fdCount = 0;
+  std::chrono::time_point<std::chrono::steady_clock> time{};
+  bool smapsValid = false;
+  bool threadsValid = false;
+  bool valid = false;
+} ProcSample;
+
 class ProcEntry : public IDataSource, public std::enable_shared_from_this<ProcEntry>
 {
+public:
+  // Generation of entries found gone, removed by the next registry sweep
+  static constexpr uint64_t StaleGeneration = 0;
+
 public:
   explicit ProcEntry(int pid, const std::string &name);
-  virtual ~ProcEntry() = default;
+  virtual ~ProcEntry();
 
 public:
   ProcEntry(ProcEntry const &) = delete;
@@ -35,6 +58,14 @@ public:
   bool update(const std::string &sourceName) override;
   bool update(void) override;
 
+  // Sampling is split so the procfs reads can run on a worker thread while
+  // the published data is only changed from the main event loop
+  bool prepareSample(void);
+  bool sampleInfoData(void);
+  bool publishInfoData(void);
+  // True if the process we were created for still runs (not gone nor PID reused)
+  bool checkAlive(void);
+
 #ifdef WITH_PROC_ACCT
   auto getAcct(void) -> tkm::msg::monitor::ProcAcct &
   {
@@ -70,20 +101,89 @@ public:
   void setName(const std::string &name)
   {
     m_info.set_comm(name);
+    m_exeName.clear();
   }
+  // Executable name from cmdline, resolved on first use (comm is truncated)
+  auto getExeName(void) -> const std::string &;
   auto getPid(void) -> int
   {
     return m_pid;
   }
+  auto getStatData(void) -> const ProcStatData &
+  {
+    return m_statData;
+  }
+  auto getSmapsData(void) -> const ProcSmapsData &
+  {
+    return m_smapsData;
+  }
   auto getContextId(void) -> uint64_t
   {
     return m_info.ctx_id();
   }
+  auto getContext(void) -> const std::shared_ptr<ContextEntry> &
+  {
+    return m_context;
+  }
+  void setContext(const std::shared_ptr<ContextEntry> &context)
+  {
+    m_context = context;
+  }
+  // Cgroup accounted in the context cgroup, empty if not tracked
+  auto getCGroup(void) -> const std::string &
+  {
+    return m_cgroup;
+  }
+  void setCGroup(const std::string &cgroup)
+  {
+    m_cgroup = cgroup;
+  }
+  // Per thread sampling for watched processes
+  void setThreadMonitor(bool enabled);
+  bool getThreadMonitor(void)
+  {
+    return m_threads != nullptr;
+  }
+  // Hottest threads from the last sample while the process was busy. Internal,
+  // libtkm has no thread message and ProcInfo only carries processes
+  auto getHotThreads(void) -> const std::vector<ProcThreads::HotThread> &
+  {
+    return m_hotThreads;
+  }
+  // Last registry scan or event batch generation the process was seen in
+  auto getGeneration(void) -> uint64_t
+  {
+    return m_generation;
+  }
+  void setGeneration(uint64_t generation)
+  {
+    m_generation = generation;
+  }
+  void markStale(void)
+  {
+    m_generation = StaleGeneration;
+  }
+  bool isStale(void)
+  {
+    return m_generation == StaleGeneration;
+  }
+  auto getExitWatch(void) -> const std::shared_ptr<ProcExitWatch> &
+  {
+    return m_exitWatch;
+  }
+  void setExitWatch(const std::shared_ptr<ProcExitWatch> &watch)
+  {
+    m_exitWatch = watch;
+  }
 
 private:
+  void openProcDir(void);
+  void closeProcDir(void);
+  auto openProcFile(const char *name, int flags) -> int;
   void initInfoData(void);
-  bool updateInfoData(void);
+  bool readStatData(ProcStatData &data);
   bool readProcStat(void);
+  bool needSmapsSample(void);
   bool readProcSmapsRollup(void);
   bool countFileDescriptors(void);
 #ifdef WITH_PROC_ACCT
@@ -94,13 +194,29 @@ private:
 private:
   std::chrono::time_point<std::chrono::steady_clock> m_lastUpdateTime{};
   tkm::msg::monitor::ProcInfoEntry m_info;
+  std::shared_ptr<ContextEntry> m_context = nullptr;
+  std::shared_ptr<ProcExitWatch> m_exitWatch = nullptr;
+  std::chrono::time_point<std::chrono::steady_clock> m_smapsTime{};
+  ProcStatData m_statData{};
+  std::string m_exeName{};
+  std::string m_cgroup{};
+  ProcSmapsData m_smapsData{};
+  ProcSample m_sample{};
+  std::shared_ptr<ProcThreads> m_threads = nullptr;
+  std::vector<ProcThreads::HotThread> m_hotThreads{};
+  uint64_t m_smapsRSS = 0;
+  uint64_t m_generation = StaleGeneration + 1;
+  size_t m_smapsSkipCount = 0;
 #ifdef WITH_PROC_ACCT
+  std::chrono::time_point<std::chrono::steady_clock> m_procAcctRequestTime{};
   tkm::msg::monitor::ProcAcct m_acct;
   bool m_updateProcAcctPending = false;
 #endif
 #ifdef WITH_LXC
   size_t m_contextNameResolveCount = 0;
 #endif
+  int m_procDirFd = -1;
+  int m_statFd = -1;
   int m_pid = 0;
 };
 
@@ -9,8 +9,7 @@
  *-
  */
 
-#include <linux/cn_proc.h>
-#include <linux/connector.h>
+#include <algorithm>
 #include <netdb.h>
 #include <unistd.h>
 
@@ -22,18 +21,15 @@ namespace tkm::monitor
 
 static bool doCollectAndSend(const std::shared_ptr<ProcEvent> mgr, const ProcEvent::Request &rq);
 
+// Apply the pending events right away if a burst grows the set this large
+constexpr size_t ProcEventMaxPending = 4096;
+
 ProcEvent::ProcEvent(const std::shared_ptr<Options> options)
 : Pollable("ProcEvent")
 , m_options(options)
 {
-  int txBufferSize, rxBufferSize;
-
-  try {
-    txBufferSize = std::stoi(m_options->getFor(Options::Key::TxBufferSize));
-    rxBufferSize = std::stoi(m_options->getFor(Options::Key::RxBufferSize));
-  } catch (std::exception &e) {
-    throw std::runtime_error("Invalid TX/RX buffer size in configuration");
-  }
+  const auto txBufferSize = static_cast<int>(m_options->getSettings().txBufferSize);
+  const auto rxBufferSize = static_cast<int>(m_options->getSettings().rxBufferSize);
 
   if ((m_sockFd = socket(PF_NETLINK, SOCK_DGRAM, NETLINK_CONNECTOR)) == -1) {
     throw std::runtime_error("Fail to create netlink socket");
@@ -55,111 +51,27 @@ ProcEvent::ProcEvent(const std::shared_ptr<Options> options)
     throw std::runtime_error("Fail to bind netlink socket");
   }
 
-  lateSetup(
-      [this]() {
-        __attribute__((aligned(NLMSG_ALIGNTO))) char
-            msg_buf[sizeof(struct nlmsghdr) + sizeof(struct cn_msg) + sizeof(struct proc_event)]{};
-        struct nlmsghdr *nl_hdr = reinterpret_cast<struct nlmsghdr *>(msg_buf);
-        struct cn_msg *cn_msg = reinterpret_cast<struct cn_msg *>(NLMSG_DATA(nl_hdr));
-        struct proc_event *proc_ev = reinterpret_cast<struct proc_event *>(&cn_msg->data[0]);
-        ssize_t rc;
-
-        rc = recv(m_sockFd, &msg_buf, sizeof(msg_buf), 0);
-        if (rc == 0) {
-          return true;
-        } else if (rc == -1) {
-          if (errno != ENOBUFS) {
-            logError() << "NetLink process receive error: " << ::strerror(errno);
-            return false;
-          }
-
-          logWarn() << "ProcEvent NetLink buffer space error";
-          // In case of buffer size errors we trigger a process list update manually
-          StateManager::Request rq = {.action = StateManager::Action::UpdateProcessList};
-          App()->getStateManager()->pushRequest(rq);
-
-          return true;
-        }
-
-        switch (proc_ev->what) {
-        case proc_event::what::PROC_EVENT_NONE:
-          logDebug() << "ProcEvent Set mcast listen OK";
-          break;
-        case proc_event::what::PROC_EVENT_FORK: {
-          logDebug() << "proc.event[fork]:"
-                     << " parent_pid=" << proc_ev->event_data.fork.parent_pid
-                     << " parent_tgid=" << proc_ev->event_data.fork.parent_tgid
-                     << " child_pid=" << proc_ev->event_data.fork.child_pid
-                     << " child_tgid=" << proc_ev->event_data.fork.child_tgid;
-          m_eventData.set_fork_count(m_eventData.fork_count() + 1);
-
-          // We only add a process entry in registry for processes
-          if (proc_ev->event_data.fork.child_pid == proc_ev->event_data.fork.child_tgid) {
-            if (m_options->getFor(Options::Key::UpdateOnProcEvent) ==
-                tkmDefaults.valFor(Defaults::Val::True)) {
-              App()->getProcRegistry()->addProcEntry(proc_ev->event_data.fork.child_tgid);
-            }
-          }
-          break;
-        }
-        case proc_event::what::PROC_EVENT_EXEC: {
-          logDebug() << "proc.event[exec]:"
-                     << " process_pid=" << proc_ev->event_data.exec.process_pid
-                     << " process_tgid=" << proc_ev->event_data.exec.process_tgid;
-          m_eventData.set_exec_count(m_eventData.exec_count() + 1);
-          if (m_options->getFor(Options::Key::UpdateOnProcEvent) ==
-              tkmDefaults.valFor(Defaults::Val::True)) {
-            App()->getProcRegistry()->updProcEntry(proc_ev->event_data.exec.process_pid);
-          }
-          break;
-        }
-        case proc_event::what::PROC_EVENT_UID: {
-          logDebug() << "proc.event[uid]:"
-                     << " process_pid=" << proc_ev->event_data.id.process_pid
-                     << " process_tgid=" << proc_ev->event_data.id.process_tgid
-                     << " ruid=" << proc_ev->event_data.id.r.ruid
-                     << " euid=" << proc_ev->event_data.id.e.euid;
-          m_eventData.set_uid_count(m_eventData.uid_count() + 1);
-          break;
-        }
-        case proc_event::what::PROC_EVENT_GID: {
-          logDebug() << "proc.event[gid]:"
-                     << " process_pid=" << proc_ev->event_data.id.process_pid
-                     << " process_tgid=" << proc_ev->event_data.id.process_tgid
-                     << " rgid=" << proc_ev->event_data.id.r.rgid
-                     << " egid=" << proc_ev->event_data.id.e.egid;
-          m_eventData.set_gid_count(m_eventData.gid_count() + 1);
-          break;
-        }
-        case proc_event::what::PROC_EVENT_EXIT: {
-          logDebug() << "proc.event[exit]:"
-                     << " process_pid=" << proc_ev->event_data.id.process_pid
-                     << " process_tgid=" << proc_ev->event_data.id.process_tgid
-                     << " exit_code=" << proc_ev->event_data.exit.exit_code;
-          m_eventData.set_exit_count(m_eventData.exit_count() + 1);
-          if (proc_ev->event_data.exit.process_pid == proc_ev->event_data.exit.process_tgid) {
-            if (m_options->getFor(Options::Key::UpdateOnProcEvent) ==
-                tkmDefaults.valFor(Defaults::Val::True)) {
-              App()->getProcRegistry()->remProcEntry(proc_ev->event_data.exit.process_pid, true);
-            }
-          }
-          break;
-        }
-        default:
-          break;
-        }
-
-        return true;
-      },
-      m_sockFd,
-      bswi::event::IPollable::Events::Level,
-      bswi::event::IEventSource::Priority::Normal);
+  // Preallocate the receive vectors so the event handler does not allocate
+  m_rxBuffers.resize(std::max<size_t>(m_options->getSettings().procEventBatchSize, 1));
+  m_rxIov.resize(m_rxBuffers.size());
+  m_rxMsgs.resize(m_rxBuffers.size());
+  for (size_t i = 0; i < m_rxBuffers.size(); i++) {
+    m_rxIov[i].iov_base = m_rxBuffers[i].data;
+    m_rxIov[i].iov_len = sizeof(m_rxBuffers[i].data);
+    m_rxMsgs[i].msg_hdr = {};
+    m_rxMsgs[i].msg_hdr.msg_iov = &m_rxIov[i];
+    m_rxMsgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  lateSetup([this]() { return receiveEvents(); },
+            m_sockFd,
+            bswi::event::IPollable::Events::Level,
+            bswi::event::IEventSource::Priority::Normal);
 
   // If the event is removed we stop the main application
   setFinalize([this]() {
     logWarn() << "ProcEvent kernel closed connection";
-    if (m_options->getFor(Options::Key::UpdateOnProcEvent) ==
-        tkmDefaults.valFor(Defaults::Val::True)) {
+    if (m_options->getSettings().updateOnProcEvent) {
       logError() << "ProcEvent source lost. Terminate taskmonitor";
       App()->stop();
     }
@@ -215,6 +127,168 @@ auto ProcEvent::requestHandler(const Request &request) -> bool
   return false;
 }
 
+bool ProcEvent::receiveEvents(void)
+{
+  // Drain up to batch size events with one call, the level triggered source
+  // wakes us again if more events are queued
+  int rc = recvmmsg(m_sockFd,
+                    m_rxMsgs.data(),
+                    static_cast<unsigned int>(m_rxMsgs.size()),
+                    MSG_DONTWAIT,
+                    nullptr);
+  if (rc == 0) {
+    return true;
+  } else if (rc == -1) {
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
+      return true;
+    }
+
+    if (errno != ENOBUFS) {
+      logError() << "NetLink process receive error: " << ::strerror(errno);
+      return false;
+    }
+
+    m_dropCount++;
+    logWarn() << "ProcEvent NetLink buffer space error. Overrun count: " << m_dropCount;
+    // In case of buffer size errors we trigger a process list update manually
+    StateManager::Request rq = {.action = StateManager::Action::UpdateProcessList};
+    App()->getStateManager()->pushRequest(rq);
+
+    return true;
+  }
+
+  m_batchCount++;
+  m_maxBatchLength = std::max(m_maxBatchLength, static_cast<size_t>(rc));
+
+  for (int i = 0; i < rc; i++) {
+    if (m_rxMsgs[static_cast<size_t>(i)].msg_len <
+        (sizeof(struct nlmsghdr) + sizeof(struct cn_msg))) {
+      continue;
+    }
+
+    const struct nlmsghdr *nlHdr =
+        reinterpret_cast<const struct nlmsghdr *>(m_rxBuffers[static_cast<size_t>(i)].data);
+    const struct cn_msg *cnMsg = reinterpret_cast<const struct cn_msg *>(NLMSG_DATA(nlHdr));
+    handleEvent(reinterpret_cast<const struct proc_event *>(&cnMsg->data[0]));
+  }
+
+  schedulePending();
+
+  return true;
+}
+
+void ProcEvent::schedulePending(void)
+{
+  m_cancelCount = m_pending.getCancelCount();
+  m_pendingCount = m_pending.size();
+
+  if (m_pending.empty()) {
+    return;
+  }
+
+  const auto interval = m_options->getSettings().procEventCoalesceInterval;
+  if ((interval.count() == 0) || (m_pending.size() >= ProcEventMaxPending)) {
+    flushPending();
+    return;
+  }
+
+  if (m_flushTimer != nullptr) {
+    return;
+  }
+
+  std::weak_ptr<ProcEvent> weakSelf = getShared();
+  m_flushTimer = std::make_shared<Timer>("ProcEventFlushTimer", [weakSelf]() {
+    if (auto self = weakSelf.lock()) {
+      self->m_flushTimer = nullptr;
+      self->flushPending();
+    }
+    return false;
+  });
+  m_flushTimer->start(static_cast<ulong>(interval.count()), false);
+  App()->addEventSource(m_flushTimer);
+}
+
+void ProcEvent::flushPending(void)
+{
+  if (m_pending.empty()) {
+    return;
+  }
+
+  m_pending.take(m_exited, m_forked, m_execed);
+  m_pendingCount = 0;
+  m_flushCount++;
+
+  App()->getProcRegistry()->applyProcEvents(m_exited, m_forked, m_execed);
+}
+
+void ProcEvent::handleEvent(const struct proc_event *procEvent)
+{
+  switch (procEvent->what) {
+  case proc_event::what::PROC_EVENT_NONE:
+    logDebug() << "ProcEvent Set mcast listen OK";
+    break;
+  case proc_event::what::PROC_EVENT_FORK: {
+    logDebug() << "proc.event[fork]:"
+               << " parent_pid=" << procEvent->event_data.fork.parent_pid
+               << " parent_tgid=" << procEvent->event_data.fork.parent_tgid
+               << " child_pid=" << procEvent->event_data.fork.child_pid
+               << " child_tgid=" << procEvent->event_data.fork.child_tgid;
+    m_eventData.set_fork_count(m_eventData.fork_count() + 1);
+
+    // We only add a process entry in registry for processes
+    if (procEvent->event_data.fork.child_pid == procEvent->event_data.fork.child_tgid) {
+      if (m_options->getSettings().updateOnProcEvent) {
+        m_pending.add(procEvent->event_data.fork.child_tgid, proc_event::what::PROC_EVENT_FORK);
+      }
+    }
+    break;
+  }
+  case proc_event::what::PROC_EVENT_EXEC: {
+    logDebug() << "proc.event[exec]:"
+               << " process_pid=" << procEvent->event_data.exec.process_pid
+               << " process_tgid=" << procEvent->event_data.exec.process_tgid;
+    m_eventData.set_exec_count(m_eventData.exec_count() + 1);
+    if (m_options->getSettings().updateOnProcEvent) {
+      m_pending.add(procEvent->event_data.exec.process_pid, proc_event::what::PROC_EVENT_EXEC);
+    }
+    break;
+  }
+  case proc_event::what::PROC_EVENT_UID: {
+    logDebug() << "proc.event[uid]:"
+               << " process_pid=" << procEvent->event_data.id.process_pid
+               << " process_tgid=" << procEvent->event_data.id.process_tgid
+               << " ruid=" << procEvent->event_data.id.r.ruid
+               << " euid=" << procEvent->event_data.id.e.euid;
+    m_eventData.set_uid_count(m_eventData.uid_count() + 1);
+    break;
+  }
+  case proc_event::what::PROC_EVENT_GID: {
+    logDebug() << "proc.event[gid]:"
+               << " process_pid=" << procEvent->event_data.id.process_pid
+               << " process_tgid=" << procEvent->event_data.id.process_tgid
+               << " rgid=" << procEvent->event_data.id.r.rgid
+               << " egid=" << procEvent->event_data.id.e.egid;
+    m_eventData.set_gid_count(m_eventData.gid_count() + 1);
+    break;
+  }
+  case proc_event::what::PROC_EVENT_EXIT: {
+    logDebug() << "proc.event[exit]:"
+               << " process_pid=" << procEvent->event_data.id.process_pid
+               << " process_tgid=" << procEvent->event_data.id.process_tgid
+               << " exit_code=" << procEvent->event_data.exit.exit_code;
+    m_eventData.set_exit_count(m_eventData.exit_count() + 1);
+    if (procEvent->event_data.exit.process_pid == procEvent->event_data.exit.process_tgid) {
+      if (m_options->getSettings().updateOnProcEvent) {
+        m_pending.add(procEvent->event_data.exit.process_pid, proc_event::what::PROC_EVENT_EXIT);
+      }
+    }
+    break;
+  }
+  default:
+    break;
+  }
+}
+
 void ProcEvent::startMonitoring(void)
 {
   __attribute__((aligned(NLMSG_ALIGNTO))) char
@@ -11,21 +11,32 @@
 
 #pragma once
 
+#include <atomic>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
 #include <linux/netlink.h>
 #include <sys/socket.h>
 #include <taskmonitor/taskmonitor.h>
+#include <vector>
 
 #include "ICollector.h"
 #include "Options.h"
+#include "ProcEventSet.h"
 
 #include "../bswinfra/source/AsyncQueue.h"
 #include "../bswinfra/source/Pollable.h"
+#include "../bswinfra/source/Timer.h"
 
 using namespace bswi::event;
 
 namespace tkm::monitor
 {
 
+typedef struct ProcEventBuffer {
+  __attribute__((aligned(NLMSG_ALIGNTO))) char
+      data[sizeof(struct nlmsghdr) + sizeof(struct cn_msg) + sizeof(struct proc_event)];
+} ProcEventBuffer;
+
 class ProcEvent : public Pollable, public std::enable_shared_from_this<ProcEvent>
 {
 public:
@@ -46,11 +57,22 @@ public:
 public:
   auto getShared(void) -> std::shared_ptr<ProcEvent> { return shared_from_this(); }
   auto getProcEventData(void) -> tkm::msg::monitor::ProcEvent & { return m_eventData; }
+  auto getBatchSize(void) -> size_t { return m_rxBuffers.size(); }
+  auto getBatchCount(void) -> uint64_t { return m_batchCount; }
+  auto getMaxBatchLength(void) -> size_t { return m_maxBatchLength; }
+  auto getDropCount(void) -> uint64_t { return m_dropCount; }
+  auto getFlushCount(void) -> uint64_t { return m_flushCount; }
+  auto getCancelCount(void) -> uint64_t { return m_cancelCount; }
+  auto getPendingCount(void) -> size_t { return m_pendingCount; }
   auto pushRequest(ProcEvent::Request &request) -> int;
   void setEventSource(bool enabled = true);
 
 private:
   void startMonitoring(void);
+  bool receiveEvents(void);
+  void handleEvent(const struct proc_event *procEvent);
+  void schedulePending(void);
+  void flushPending(void);
   bool requestHandler(const Request &request);
 
 private:
@@ -58,6 +80,21 @@ private:
   std::shared_ptr<Options> m_options = nullptr;
   tkm::msg::monitor::ProcEvent m_eventData{};
   struct sockaddr_nl m_addr = {};
+  std::vector<ProcEventBuffer> m_rxBuffers{};
+  std::vector<struct iovec> m_rxIov{};
+  std::vector<struct mmsghdr> m_rxMsgs{};
+  ProcEventSet m_pending{};
+  std::vector<int> m_exited{};
+  std::vector<int> m_forked{};
+  std::vector<int> m_execed{};
+  std::shared_ptr<Timer> m_flushTimer = nullptr;
+  uint64_t m_batchCount = 0;
+  uint64_t m_dropCount = 0;
+  // Read by the tests while the event loop updates them
+  std::atomic<uint64_t> m_flushCount = 0;
+  std::atomic<uint64_t> m_cancelCount = 0;
+  std::atomic<size_t> m_pendingCount = 0;
+  size_t m_maxBatchLength = 0;
   int m_sockFd = -1;
 };
 
@@ -0,0 +1,79 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcEventSet Class
+ * @details   Process events coalesced per PID before the registry update
+ *-
+ */
+
+#include "ProcEventSet.h"
+
+namespace tkm::monitor
+{
+
+void ProcEventSet::add(int pid, enum proc_event::what what)
+{
+  switch (what) {
+  case proc_event::what::PROC_EVENT_FORK: {
+    auto &pending = m_pending[pid];
+    pending.forked = true;
+    pending.execed = false;
+    break;
+  }
+  case proc_event::what::PROC_EVENT_EXEC: {
+    // A new entry reads the process name after exec anyway
+    auto &pending = m_pending[pid];
+    if (!pending.forked) {
+      pending.execed = true;
+    }
+    break;
+  }
+  case proc_event::what::PROC_EVENT_EXIT: {
+    auto it = m_pending.find(pid);
+    if ((it != m_pending.end()) && it->second.forked) {
+      // Short lived process, never visible to the registry
+      m_cancelCount++;
+      if (it->second.exited) {
+        it->second.forked = false;
+      } else {
+        m_pending.erase(it);
+      }
+      break;
+    }
+
+    auto &pending = m_pending[pid];
+    pending.exited = true;
+    pending.execed = false;
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+void ProcEventSet::take(std::vector<int> &exited,
+                        std::vector<int> &forked,
+                        std::vector<int> &execed)
+{
+  exited.clear();
+  forked.clear();
+  execed.clear();
+
+  for (const auto &[pid, pending] : m_pending) {
+    if (pending.exited) {
+      exited.push_back(pid);
+    }
+    if (pending.forked) {
+      forked.push_back(pid);
+    }
+    if (pending.execed) {
+      execed.push_back(pid);
+    }
+  }
+  m_pending.clear();
+}
+
+} // namespace tkm::monitor
@@ -0,0 +1,60 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcEventSet Class
+ * @details   Process events coalesced per PID before the registry update
+ *-
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <linux/cn_proc.h>
+#include <unordered_map>
+#include <vector>
+
+namespace tkm::monitor
+{
+
+// Process events for one PID not yet applied to the process registry
+typedef struct ProcEventPending {
+  bool forked = false;
+  bool execed = false;
+  bool exited = false;
+} ProcEventPending;
+
+/*
+ * Fork, exec and exit events are merged per PID until the owner applies
+ * them to the registry. A fork followed by its exit cancels out so short
+ * lived processes never reach /proc. An exit followed by a fork of a reused
+ * PID keeps both so the old entry is replaced.
+ */
+class ProcEventSet
+{
+public:
+  ProcEventSet() = default;
+  ~ProcEventSet() = default;
+
+public:
+  ProcEventSet(ProcEventSet const &) = delete;
+  void operator=(ProcEventSet const &) = delete;
+
+public:
+  void add(int pid, enum proc_event::what what);
+  // Move the pending PIDs into the registry update lists and clear the set
+  void take(std::vector<int> &exited, std::vector<int> &forked, std::vector<int> &execed);
+
+  bool empty(void) const { return m_pending.empty(); }
+  auto size(void) const -> size_t { return m_pending.size(); }
+  auto getCancelCount(void) const -> uint64_t { return m_cancelCount; }
+
+private:
+  std::unordered_map<int, ProcEventPending> m_pending{};
+  uint64_t m_cancelCount = 0;
+};
+
+} // namespace tkm::monitor
@@ -0,0 +1,126 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcExitSummary Class
+ * @details   Accounting summary for exited processes
+ *-
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "ProcExitSummary.h"
+
+#define average_ms(t, c) (t / 1000000ULL / (c ? c : 1))
+
+namespace tkm::monitor
+{
+
+ProcExitSummary::ProcExitSummary(const std::string &name, size_t maxEntries)
+: m_name(name)
+, m_maxEntries(maxEntries)
+{
+}
+
+void ProcExitSummary::add(const struct taskstats &t)
+{
+  std::string comm(t.ac_comm, strnlen(t.ac_comm, sizeof(t.ac_comm)));
+
+  if ((m_entries.count(comm) == 0) && (m_entries.size() >= m_maxEntries)) {
+    comm = OtherName;
+  }
+
+  auto &entry = m_entries[comm];
+  auto &acct = entry.acct;
+
+  if (!acct.has_cpu()) {
+    // The summary is not bound to a process so pid and ppid are left unset
+    acct.set_ac_comm(comm);
+    acct.set_ac_uid(t.ac_uid);
+    acct.set_ac_gid(t.ac_gid);
+  }
+
+  // Each exiting thread sends its own record but only the leader ends the process
+  bool processExit = true;
+#if TASKSTATS_VERSION >= 13
+  processExit = (t.ac_tgid == 0) || (t.ac_tgid == t.ac_pid);
+#endif
+  if (processExit) {
+    entry.exitCount++;
+    m_exitCount++;
+  }
+
+  acct.set_ac_utime(acct.ac_utime() + t.ac_utime);
+  acct.set_ac_stime(acct.ac_stime() + t.ac_stime);
+
+  auto cpu = acct.mutable_cpu();
+  cpu->set_cpu_count(cpu->cpu_count() + t.cpu_count);
+  cpu->set_cpu_run_real_total(cpu->cpu_run_real_total() + t.cpu_run_real_total);
+  cpu->set_cpu_run_virtual_total(cpu->cpu_run_virtual_total() + t.cpu_run_virtual_total);
+  cpu->set_cpu_delay_total(cpu->cpu_delay_total() + t.cpu_delay_total);
+  cpu->set_cpu_delay_average(average_ms(cpu->cpu_delay_total(), cpu->cpu_count()));
+
+  auto mem = acct.mutable_mem();
+  mem->set_coremem(mem->coremem() + t.coremem);
+  mem->set_virtmem(mem->virtmem() + t.virtmem);
+  mem->set_hiwater_rss(std::max<uint64_t>(mem->hiwater_rss(), t.hiwater_rss));
+  mem->set_hiwater_vm(std::max<uint64_t>(mem->hiwater_vm(), t.hiwater_vm));
+
+  auto ctx = acct.mutable_ctx();
+  ctx->set_nvcsw(ctx->nvcsw() + t.nvcsw);
+  ctx->set_nivcsw(ctx->nivcsw() + t.nivcsw);
+
+  auto io = acct.mutable_io();
+  io->set_blkio_count(io->blkio_count() + t.blkio_count);
+  io->set_blkio_delay_total(io->blkio_delay_total() + t.blkio_delay_total);
+  io->set_blkio_delay_average(average_ms(io->blkio_delay_total(), io->blkio_count()));
+  io->set_read_bytes(io->read_bytes() + t.read_bytes);
+  io->set_write_bytes(io->write_bytes() + t.write_bytes);
+  io->set_read_char(io->read_char() + t.read_char);
+  io->set_write_char(io->write_char() + t.write_char);
+  io->set_read_syscalls(io->read_syscalls() + t.read_syscalls);
+  io->set_write_syscalls(io->write_syscalls() + t.write_syscalls);
+
+  auto swp = acct.mutable_swp();
+  swp->set_swapin_count(swp->swapin_count() + t.swapin_count);
+  swp->set_swapin_delay_total(swp->swapin_delay_total() + t.swapin_delay_total);
+  swp->set_swapin_delay_average(average_ms(swp->swapin_delay_total(), swp->swapin_count()));
+
+  auto reclaim = acct.mutable_reclaim();
+  reclaim->set_freepages_count(reclaim->freepages_count() + t.freepages_count);
+  reclaim->set_freepages_delay_total(reclaim->freepages_delay_total() + t.freepages_delay_total);
+  reclaim->set_freepages_delay_average(
+      average_ms(reclaim->freepages_delay_total(), reclaim->freepages_count()));
+#if TASKSTATS_VERSION >= 9
+  auto thrashing = acct.mutable_thrashing();
+  thrashing->set_thrashing_count(thrashing->thrashing_count() + t.thrashing_count);
+  thrashing->set_thrashing_delay_total(thrashing->thrashing_delay_total() +
+                                       t.thrashing_delay_total);
+  thrashing->set_thrashing_delay_average(
+      average_ms(thrashing->thrashing_delay_total(), thrashing->thrashing_count()));
+#endif
+}
+
+void ProcExitSummary::clear(void)
+{
+  m_entries.clear();
+  m_exitCount = 0;
+}
+
+void ProcExitSummary::foreach (const std::function<void(const Entry &)> &callback) const
+{
+  for (const auto &item : m_entries) {
+    callback(item.second);
+  }
+}
+
+auto ProcExitSummary::getEntry(const std::string &comm) const -> const Entry *
+{
+  auto it = m_entries.find(comm);
+  return (it != m_entries.end()) ? &it->second : nullptr;
+}
+
+} // namespace tkm::monitor
@@ -0,0 +1,68 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcExitSummary Class
+ * @details   Accounting summary for exited processes
+ *-
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <linux/taskstats.h>
+#include <string>
+#include <taskmonitor/taskmonitor.h>
+#include <unordered_map>
+
+namespace tkm::monitor
+{
+
+/*
+ * Accumulate the final taskstats records the kernel sends for exiting
+ * tasks. Records are grouped by process name so short lived jobs
+ * (e.g. compilers or scripts) are accounted even if they never lived long
+ * enough to be sampled. Names above the entry limit are folded into a
+ * single OtherName entry to keep the memory bounded. The summary is not sent
+ * to collectors since ProcAcct records are keyed by PID and a name group
+ * would merge into a bogus PID 0 entry.
+ */
+class ProcExitSummary
+{
+public:
+  typedef struct Entry {
+    tkm::msg::monitor::ProcAcct acct;
+    uint64_t exitCount = 0;
+  } Entry;
+
+  static constexpr size_t DefaultMaxEntries = 512;
+  static constexpr const char *OtherName = "[other]";
+
+public:
+  explicit ProcExitSummary(const std::string &name, size_t maxEntries = DefaultMaxEntries);
+  ~ProcExitSummary() = default;
+
+public:
+  ProcExitSummary(ProcExitSummary const &) = delete;
+  void operator=(ProcExitSummary const &) = delete;
+
+public:
+  void add(const struct taskstats &stats);
+  void clear(void);
+  void foreach (const std::function<void(const Entry &)> &callback) const;
+  auto getEntry(const std::string &comm) const -> const Entry *;
+  auto getEntryCount(void) const -> size_t { return m_entries.size(); }
+  auto getExitCount(void) const -> uint64_t { return m_exitCount; }
+  auto getName(void) -> const std::string & { return m_name; }
+
+private:
+  std::unordered_map<std::string, Entry> m_entries{};
+  std::string m_name{};
+  uint64_t m_exitCount = 0;
+  size_t m_maxEntries = 0;
+};
+
+} // namespace tkm::monitor
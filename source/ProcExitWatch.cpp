@@ -0,0 +1,102 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcExitWatch Class
+ * @details   Process exit notification using pidfd
+ *-
+ */
+
+#include <cstring>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "Application.h"
+#include "ProcExitWatch.h"
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+namespace tkm::monitor
+{
+
+static auto pidfdOpen(int pid) -> int
+{
+  return static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+}
+
+bool ProcExitWatch::isSupported(void)
+{
+  static const bool supported = []() {
+    int fd = pidfdOpen(getpid());
+    if (fd < 0) {
+      logWarn() << "pidfd_open not available. Error: " << ::strerror(errno);
+      return false;
+    }
+    ::close(fd);
+    return true;
+  }();
+
+  return supported;
+}
+
+ProcExitWatch::ProcExitWatch(const std::shared_ptr<ProcEntry> &entry)
+: Pollable("ProcExitWatch")
+, m_entry(entry)
+, m_pid(entry->getPid())
+{
+  m_pidFd = pidfdOpen(m_pid);
+  if (m_pidFd < 0) {
+    throw std::runtime_error("Fail to open pidfd for pid " + std::to_string(m_pid) + ": " +
+                             ::strerror(errno));
+  }
+
+  // The pidfd becomes readable once the process exits. The registry may
+  // already hold a new entry for a reused PID so only the owner is marked.
+  // Exits are swept together as for the coalesced proc events.
+  lateSetup(
+      [this]() {
+        m_active = false;
+
+        auto procEntry = m_entry.lock();
+        if (procEntry != nullptr) {
+          if (App()->getProcRegistry()->getProcEntry(m_pid) == procEntry) {
+            logDebug() << "Process exit notified on pidfd for pid=" << m_pid;
+            App()->getProcRegistry()->markProcExit(procEntry);
+          }
+        }
+
+        // One shot event, the source is removed on return
+        return false;
+      },
+      m_pidFd,
+      bswi::event::IPollable::Events::Level,
+      bswi::event::IEventSource::Priority::Normal);
+}
+
+ProcExitWatch::~ProcExitWatch()
+{
+  if (m_pidFd != -1) {
+    ::close(m_pidFd);
+    m_pidFd = -1;
+  }
+}
+
+void ProcExitWatch::setEventSource(bool enabled)
+{
+  if (enabled == m_active) {
+    return;
+  }
+
+  if (enabled) {
+    App()->addEventSource(getShared());
+  } else {
+    App()->remEventSource(getShared());
+  }
+  m_active = enabled;
+}
+
+} // namespace tkm::monitor
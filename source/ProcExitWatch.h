@@ -0,0 +1,48 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcExitWatch Class
+ * @details   Process exit notification using pidfd
+ *-
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "ProcEntry.h"
+
+#include "../bswinfra/source/Pollable.h"
+
+using namespace bswi::event;
+
+namespace tkm::monitor
+{
+
+class ProcExitWatch : public Pollable, public std::enable_shared_from_this<ProcExitWatch>
+{
+public:
+  explicit ProcExitWatch(const std::shared_ptr<ProcEntry> &entry);
+  ~ProcExitWatch();
+
+public:
+  ProcExitWatch(ProcExitWatch const &) = delete;
+  void operator=(ProcExitWatch const &) = delete;
+
+public:
+  auto getShared() -> std::shared_ptr<ProcExitWatch> { return shared_from_this(); }
+  void setEventSource(bool enabled = true);
+  // Check once if the running kernel provides pidfd_open (Linux 5.3)
+  static bool isSupported(void);
+
+private:
+  std::weak_ptr<ProcEntry> m_entry;
+  bool m_active = false;
+  int m_pidFd = -1;
+  int m_pid = 0;
+};
+
+} // namespace tkm::monitor
@@ -0,0 +1,325 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcFilter Class
+ * @details   Compiled process exclusion rules
+ *-
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ProcFilter.h"
+#include "ProcParser.h"
+
+#include "../bswinfra/source/Logger.h"
+
+namespace tkm::monitor
+{
+
+// Enough for /proc/<pid>/cgroup on cgroup v2 and most hybrid hierarchies
+constexpr size_t ProcCGroupBufferSize = 4096;
+
+ProcFilter::ProcFilter(const std::string &name)
+: m_name(name)
+{
+}
+
+bool ProcFilter::addRule(const std::string &rule)
+{
+  if (rule.empty()) {
+    return false;
+  }
+
+  const auto sep = rule.find(':');
+  const std::string type = (sep != std::string::npos) ? rule.substr(0, sep) : std::string();
+  const std::string value = (sep != std::string::npos) ? rule.substr(sep + 1) : rule;
+
+  try {
+    if (type == "exact") {
+      m_exacts.push_back(value);
+    } else if (type == "prefix") {
+      m_prefixes.push_back(value);
+    } else if (type == "regex") {
+      m_regexes.emplace_back(value, std::regex::ECMAScript | std::regex::optimize);
+    } else if (type == "kthread") {
+      m_kthread = true;
+    } else if (type == "uid") {
+      m_uids.push_back(std::stoll(value));
+    } else if (type == "ppid") {
+      m_ppids.push_back(std::stoi(value));
+    } else if (type == "cgroup") {
+      m_cgroups.push_back(value);
+    } else {
+      // Not a typed rule (process names may contain ':' as well)
+      m_substrings.push_back(rule);
+    }
+  } catch (std::exception &e) {
+    logWarn() << "Invalid process filter rule '" << rule << "': " << e.what();
+    return false;
+  }
+
+  m_ruleCount++;
+  m_compiled = false;
+
+  return true;
+}
+
+void ProcFilter::clear(void)
+{
+  m_goto.clear();
+  m_output.clear();
+  m_substrings.clear();
+  m_exacts.clear();
+  m_prefixes.clear();
+  m_regexes.clear();
+  m_cgroups.clear();
+  m_uids.clear();
+  m_ppids.clear();
+  m_ruleCount = 0;
+  m_kthread = false;
+  m_compiled = false;
+}
+
+void ProcFilter::compile(void)
+{
+  std::array<int32_t, 256> emptyNode;
+  emptyNode.fill(-1);
+
+  m_goto.clear();
+  m_output.clear();
+  m_goto.push_back(emptyNode);
+  m_output.push_back(false);
+
+  // Build the keyword trie
+  for (const auto &pattern : m_substrings) {
+    size_t state = 0;
+    for (const auto ch : pattern) {
+      const auto c = static_cast<unsigned char>(ch);
+      if (m_goto[state][c] < 0) {
+        m_goto[state][c] = static_cast<int32_t>(m_goto.size());
+        m_goto.push_back(emptyNode);
+        m_output.push_back(false);
+      }
+      state = static_cast<size_t>(m_goto[state][c]);
+    }
+    m_output[state] = true;
+  }
+
+  // Add failure transitions in BFS order so the goto table becomes a DFA
+  std::vector<int32_t> fail(m_goto.size(), 0);
+  std::deque<size_t> queue;
+
+  for (size_t c = 0; c < 256; c++) {
+    if (m_goto[0][c] < 0) {
+      m_goto[0][c] = 0;
+    } else {
+      queue.push_back(static_cast<size_t>(m_goto[0][c]));
+    }
+  }
+
+  while (!queue.empty()) {
+    const auto state = queue.front();
+    queue.pop_front();
+
+    for (size_t c = 0; c < 256; c++) {
+      const auto next = m_goto[state][c];
+      const auto fallback = m_goto[static_cast<size_t>(fail[state])][c];
+
+      if (next < 0) {
+        m_goto[state][c] = fallback;
+        continue;
+      }
+
+      fail[static_cast<size_t>(next)] = fallback;
+      if (m_output[static_cast<size_t>(fallback)]) {
+        m_output[static_cast<size_t>(next)] = true;
+      }
+      queue.push_back(static_cast<size_t>(next));
+    }
+  }
+
+  m_compiled = true;
+}
+
+bool ProcFilter::matchSubstring(const std::string &name) const
+{
+  if (m_substrings.empty()) {
+    return false;
+  }
+
+  if (!m_compiled) {
+    return std::any_of(m_substrings.cbegin(), m_substrings.cend(), [&name](const auto &pattern) {
+      return name.find(pattern) != std::string::npos;
+    });
+  }
+
+  size_t state = 0;
+  for (const auto ch : name) {
+    state = static_cast<size_t>(m_goto[state][static_cast<unsigned char>(ch)]);
+    if (m_output[state]) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool ProcFilter::matchName(const std::string &name) const
+{
+  if (matchSubstring(name)) {
+    return true;
+  }
+
+  for (const auto &exact : m_exacts) {
+    if (name == exact) {
+      return true;
+    }
+  }
+
+  for (const auto &prefix : m_prefixes) {
+    if (name.compare(0, prefix.size(), prefix) == 0) {
+      return true;
+    }
+  }
+
+  for (const auto &regex : m_regexes) {
+    if (std::regex_search(name, regex)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool ProcFilter::matchPredicates(const Subject &subject) const
+{
+  if (m_kthread && ((subject.flags & KThreadFlag) != 0)) {
+    return true;
+  }
+
+  if (std::find(m_ppids.cbegin(), m_ppids.cend(), subject.ppid) != m_ppids.cend()) {
+    return true;
+  }
+
+  if (std::find(m_uids.cbegin(), m_uids.cend(), subject.uid) != m_uids.cend()) {
+    return true;
+  }
+
+  if (!subject.cgroup.empty()) {
+    for (const auto &cgroup : m_cgroups) {
+      if (subject.cgroup.compare(0, cgroup.size(), cgroup) == 0) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+bool ProcFilter::matchSubject(const Subject &subject) const
+{
+  return matchName(subject.name) || matchPredicates(subject);
+}
+
+bool readProcCGroup(int pid, std::string &path)
+{
+  char buf[ProcCGroupBufferSize];
+  char filePath[64];
+
+  snprintf(filePath, sizeof(filePath), "/proc/%d/cgroup", pid);
+  int fd = ::open(filePath, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  auto len = ::read(fd, buf, sizeof(buf));
+  ::close(fd);
+  if (len <= 0) {
+    return false;
+  }
+
+  // Lines are "hierarchy-ID:controllers:path". Prefer the unified hierarchy
+  // (0::path) and fallback to the first line on cgroup v1 systems.
+  const char *pos = buf;
+  const char *end = buf + len;
+  while (pos < end) {
+    auto eol = static_cast<const char *>(::memchr(pos, '\n', static_cast<size_t>(end - pos)));
+    if (eol == nullptr) {
+      eol = end;
+    }
+
+    auto sep = static_cast<const char *>(::memchr(pos, ':', static_cast<size_t>(eol - pos)));
+    if (sep != nullptr) {
+      sep = static_cast<const char *>(::memchr(sep + 1, ':', static_cast<size_t>(eol - sep - 1)));
+    }
+    if (sep != nullptr) {
+      const bool unified = ((eol - pos) > 3) && (::memcmp(pos, "0::", 3) == 0);
+      if (unified || path.empty()) {
+        path.assign(sep + 1, static_cast<size_t>(eol - sep - 1));
+      }
+      if (unified) {
+        break;
+      }
+    }
+
+    pos = eol + 1;
+  }
+
+  return !path.empty();
+}
+
+bool ProcFilter::matchProcess(int pid, const std::string &name) const
+{
+  if (matchName(name)) {
+    return true;
+  }
+
+  if (!needsStat() && !needsUid() && !needsCGroup()) {
+    return false;
+  }
+
+  Subject subject{};
+  char path[64];
+
+  if (needsStat()) {
+    ProcStatData data{};
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return false;
+    }
+    auto status = readProcStat(fd, data);
+    ::close(fd);
+
+    if (status) {
+      subject.flags = data.flags;
+      subject.ppid = data.ppid;
+    }
+  }
+
+  if (needsUid()) {
+    struct stat st {};
+
+    snprintf(path, sizeof(path), "/proc/%d", pid);
+    if (::stat(path, &st) == 0) {
+      subject.uid = static_cast<int64_t>(st.st_uid);
+    }
+  }
+
+  if (needsCGroup()) {
+    readProcCGroup(pid, subject.cgroup);
+  }
+
+  return matchPredicates(subject);
+}
+
+} // namespace tkm::monitor
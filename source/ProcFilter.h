@@ -0,0 +1,99 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcFilter Class
+ * @details   Compiled process exclusion rules
+ *-
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace tkm::monitor
+{
+
+// Read the cgroup path of pid (unified hierarchy if mounted) from /proc/<pid>/cgroup
+bool readProcCGroup(int pid, std::string &path);
+
+/*
+ * Process exclusion rules compiled once from the configuration blacklist.
+ * Plain rules are matched as substrings of the process name with a single
+ * Aho-Corasick pass. Typed rules use a "<type>:<value>" key:
+ *   exact:<name>     process name equals value
+ *   prefix:<name>    process name starts with value
+ *   regex:<expr>     ECMAScript regular expression searched in process name
+ *   kthread:any      kernel threads (PF_KTHREAD)
+ *   uid:<uid>        process owner user id
+ *   ppid:<pid>       parent process id
+ *   cgroup:<path>    cgroup path starts with value
+ * The procfs data needed by the non name rules is only read if such rules
+ * are configured.
+ */
+class ProcFilter
+{
+public:
+  // PF_KTHREAD from include/linux/sched.h
+  static constexpr uint32_t KThreadFlag = 0x00200000;
+
+  typedef struct Subject {
+    std::string name{};
+    std::string cgroup{};
+    int64_t uid = -1;
+    int ppid = -1;
+    uint32_t flags = 0;
+  } Subject;
+
+public:
+  explicit ProcFilter(const std::string &name);
+  ~ProcFilter() = default;
+
+public:
+  ProcFilter(ProcFilter const &) = delete;
+  void operator=(ProcFilter const &) = delete;
+
+public:
+  bool addRule(const std::string &rule);
+  void compile(void);
+  void clear(void);
+
+  bool matchName(const std::string &name) const;
+  bool matchSubject(const Subject &subject) const;
+  // Match the name and read the procfs data required by the typed rules
+  bool matchProcess(int pid, const std::string &name) const;
+  bool isExcluded(int pid, const std::string &name) const { return matchProcess(pid, name); }
+
+  auto getRuleCount(void) const -> size_t { return m_ruleCount; }
+  bool needsStat(void) const { return m_kthread || !m_ppids.empty(); }
+  bool needsUid(void) const { return !m_uids.empty(); }
+  bool needsCGroup(void) const { return !m_cgroups.empty(); }
+  auto getName(void) -> const std::string & { return m_name; }
+
+private:
+  bool matchSubstring(const std::string &name) const;
+  bool matchPredicates(const Subject &subject) const;
+
+private:
+  std::vector<std::array<int32_t, 256>> m_goto{};
+  std::vector<bool> m_output{};
+  std::vector<std::string> m_substrings{};
+  std::vector<std::string> m_exacts{};
+  std::vector<std::string> m_prefixes{};
+  std::vector<std::regex> m_regexes{};
+  std::vector<std::string> m_cgroups{};
+  std::vector<int64_t> m_uids{};
+  std::vector<int> m_ppids{};
+  std::string m_name{};
+  size_t m_ruleCount = 0;
+  bool m_kthread = false;
+  bool m_compiled = false;
+};
+
+} // namespace tkm::monitor
@@ -0,0 +1,303 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcIndex Class
+ * @details   PID and name lookup index for registry entries
+ *-
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tkm::monitor
+{
+
+/*
+ * Open addressing (linear probing) hash map from PID to entry with a secondary
+ * name index. The entry type must provide getPid() and getName() methods.
+ * The index is kept next to the registry SafeList and has to be updated by the
+ * owner on each append/remove so that lookups don't scan the list.
+ */
+template <class T>
+class ProcIndex
+{
+public:
+  explicit ProcIndex(const std::string &name, size_t capacity = 1024)
+  : m_name(name)
+  {
+    size_t cap = MinCapacity;
+    while (cap < capacity) {
+      cap <<= 1;
+    }
+    m_slots.resize(cap);
+    m_shift = shiftFor(cap);
+  }
+  ~ProcIndex() = default;
+
+public:
+  ProcIndex(ProcIndex const &) = delete;
+  void operator=(ProcIndex const &) = delete;
+
+public:
+  void insert(const std::shared_ptr<T> &entry)
+  {
+    std::scoped_lock lk(m_mutex);
+
+    if ((m_size + m_tombs + 1) * LoadDen > m_slots.size() * LoadNum) {
+      // Grow if the table is mostly live entries, otherwise only drop tombstones
+      auto capacity = m_slots.size();
+      if ((m_size + 1) * LoadDen * 2 > capacity * LoadNum) {
+        capacity *= 2;
+      }
+      rehash(capacity);
+    }
+
+    const int pid = entry->getPid();
+    auto pos = lookup(pid);
+    if (pos != NotFound) {
+      eraseName(m_slots[pos].entry);
+      m_slots[pos].entry = entry;
+    } else {
+      placeNew(pid, entry);
+    }
+    m_names[entry->getName()].push_back(entry);
+  }
+
+  void erase(const std::shared_ptr<T> &entry)
+  {
+    std::scoped_lock lk(m_mutex);
+
+    auto pos = lookup(entry->getPid());
+    if ((pos == NotFound) || (m_slots[pos].entry != entry)) {
+      return;
+    }
+
+    eraseName(entry);
+    m_slots[pos].entry.reset();
+    m_slots[pos].state = SlotState::Tomb;
+    m_size--;
+    m_tombs++;
+  }
+
+  void rename(const std::shared_ptr<T> &entry, const std::string &oldName)
+  {
+    std::scoped_lock lk(m_mutex);
+
+    auto it = m_names.find(oldName);
+    if (it == m_names.end()) {
+      return;
+    }
+
+    auto &vec = it->second;
+    for (size_t i = 0; i < vec.size(); i++) {
+      if (vec[i] == entry) {
+        vec[i] = vec.back();
+        vec.pop_back();
+        if (vec.empty()) {
+          m_names.erase(it);
+        }
+        m_names[entry->getName()].push_back(entry);
+        return;
+      }
+    }
+  }
+
+  auto find(int pid) -> std::shared_ptr<T>
+  {
+    std::scoped_lock lk(m_mutex);
+
+    auto pos = lookup(pid);
+    return (pos == NotFound) ? nullptr : m_slots[pos].entry;
+  }
+
+  auto find(const std::string &name) -> std::shared_ptr<T>
+  {
+    std::scoped_lock lk(m_mutex);
+
+    auto it = m_names.find(name);
+    return (it == m_names.end()) ? nullptr : it->second.back();
+  }
+
+  auto findAll(const std::string &name) -> std::vector<std::shared_ptr<T>>
+  {
+    std::scoped_lock lk(m_mutex);
+
+    auto it = m_names.find(name);
+    return (it == m_names.end()) ? std::vector<std::shared_ptr<T>>{} : it->second;
+  }
+
+  // Fill pids with the sorted list of indexed PIDs
+  void getPids(std::vector<int> &pids)
+  {
+    std::scoped_lock lk(m_mutex);
+
+    pids.clear();
+    for (const auto &slot : m_slots) {
+      if (slot.state == SlotState::Used) {
+        pids.push_back(slot.pid);
+      }
+    }
+    std::sort(pids.begin(), pids.end());
+  }
+
+  void clear(void)
+  {
+    std::scoped_lock lk(m_mutex);
+
+    for (auto &slot : m_slots) {
+      slot = Slot{};
+    }
+    m_names.clear();
+    m_size = 0;
+    m_tombs = 0;
+  }
+
+  auto getName(void) -> const std::string & { return m_name; }
+  auto getSize(void) -> size_t
+  {
+    std::scoped_lock lk(m_mutex);
+    return m_size;
+  }
+  auto getCapacity(void) -> size_t
+  {
+    std::scoped_lock lk(m_mutex);
+    return m_slots.size();
+  }
+  auto getProbeCount(void) -> uint64_t
+  {
+    std::scoped_lock lk(m_mutex);
+    return m_probes;
+  }
+  void resetProbeCount(void)
+  {
+    std::scoped_lock lk(m_mutex);
+    m_probes = 0;
+  }
+
+private:
+  enum class SlotState { Empty, Used, Tomb };
+  typedef struct Slot {
+    int pid = -1;
+    SlotState state = SlotState::Empty;
+    std::shared_ptr<T> entry = nullptr;
+  } Slot;
+
+  static constexpr size_t MinCapacity = 64;
+  static constexpr size_t LoadNum = 7; // max load factor 0.7
+  static constexpr size_t LoadDen = 10;
+  static constexpr size_t NotFound = SIZE_MAX;
+
+  static auto shiftFor(size_t capacity) -> unsigned
+  {
+    unsigned bits = 0;
+    while ((static_cast<size_t>(1) << bits) < capacity) {
+      bits++;
+    }
+    return 32 - bits;
+  }
+
+  auto slotFor(int pid) -> size_t
+  {
+    // Fibonacci hashing spreads sequential PIDs across the table, the high
+    // bits of the product are the well mixed ones
+    auto h = static_cast<uint32_t>(pid) * 0x9E3779B9U;
+    return static_cast<size_t>(h >> m_shift);
+  }
+
+  auto lookup(int pid) -> size_t
+  {
+    const size_t mask = m_slots.size() - 1;
+    size_t pos = slotFor(pid);
+
+    for (size_t i = 0; i < m_slots.size(); i++) {
+      m_probes++;
+      const auto &slot = m_slots[pos];
+      if (slot.state == SlotState::Empty) {
+        return NotFound;
+      }
+      if ((slot.state == SlotState::Used) && (slot.pid == pid)) {
+        return pos;
+      }
+      pos = (pos + 1) & mask;
+    }
+
+    return NotFound;
+  }
+
+  void placeNew(int pid, const std::shared_ptr<T> &entry)
+  {
+    const size_t mask = m_slots.size() - 1;
+    size_t pos = slotFor(pid);
+
+    while (m_slots[pos].state == SlotState::Used) {
+      pos = (pos + 1) & mask;
+    }
+
+    if (m_slots[pos].state == SlotState::Tomb) {
+      m_tombs--;
+    }
+    m_slots[pos].pid = pid;
+    m_slots[pos].state = SlotState::Used;
+    m_slots[pos].entry = entry;
+    m_size++;
+  }
+
+  void rehash(size_t capacity)
+  {
+    std::vector<Slot> old(capacity);
+    old.swap(m_slots);
+    m_shift = shiftFor(capacity);
+    m_size = 0;
+    m_tombs = 0;
+
+    for (auto &slot : old) {
+      if (slot.state == SlotState::Used) {
+        placeNew(slot.pid, slot.entry);
+      }
+    }
+  }
+
+  void eraseName(const std::shared_ptr<T> &entry)
+  {
+    auto it = m_names.find(entry->getName());
+    if (it == m_names.end()) {
+      return;
+    }
+
+    auto &vec = it->second;
+    for (size_t i = 0; i < vec.size(); i++) {
+      if (vec[i] == entry) {
+        vec[i] = vec.back();
+        vec.pop_back();
+        break;
+      }
+    }
+
+    if (vec.empty()) {
+      m_names.erase(it);
+    }
+  }
+
+private:
+  std::unordered_map<std::string, std::vector<std::shared_ptr<T>>> m_names{};
+  std::vector<Slot> m_slots{};
+  std::mutex m_mutex{};
+  std::string m_name{};
+  uint64_t m_probes = 0;
+  size_t m_size = 0;
+  size_t m_tombs = 0;
+  unsigned m_shift = 32;
+};
+
+} // namespace tkm::monitor
@@ -0,0 +1,485 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcKeyTable Class
+ * @details   Compile time perfect hash of procfs field names
+ *-
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+namespace tkm::monitor
+{
+
+// FNV-1a with the seed mixed in the offset basis
+constexpr auto procKeyHash(std::string_view key, uint32_t seed) -> uint32_t
+{
+  uint32_t hash = 2166136261u ^ (seed * 0x9e3779b9u);
+  for (const auto c : key) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/*
+ * Perfect hash of a fixed key set built at compile time with hash and
+ * displace: the keys are split in buckets by an unseeded hash and each bucket,
+ * largest first, gets the first seed which places all its keys in free slots.
+ * A lookup costs two hashes of the key and a single string compare.
+ */
+template <size_t KeyCount, size_t TableSize>
+class ProcKeyTable
+{
+  static_assert((TableSize & (TableSize - 1)) == 0, "Table size must be a power of two");
+  static_assert(TableSize >= KeyCount * 2, "Table load factor must be at most 0.5");
+
+public:
+  static constexpr size_t BucketCount = TableSize / 4;
+  static constexpr int NoKey = -1;
+
+  constexpr explicit ProcKeyTable(const char *const (&keys)[KeyCount])
+  {
+    for (size_t i = 0; i < KeyCount; i++) {
+      m_keys[i] = keys[i];
+    }
+    for (size_t i = 0; i < TableSize; i++) {
+      m_slots[i] = NoKey;
+    }
+    m_valid = build();
+  }
+
+public:
+  // Key index or NoKey
+  constexpr auto find(std::string_view key) const -> int
+  {
+    const auto seed = m_seeds[procKeyHash(key, 0) & (BucketCount - 1)];
+    const auto index = m_slots[procKeyHash(key, seed) & (TableSize - 1)];
+    return ((index != NoKey) && (m_keys[static_cast<size_t>(index)] == key)) ? index : NoKey;
+  }
+  constexpr auto getKey(size_t index) const -> std::string_view { return m_keys[index]; }
+  constexpr auto size(void) const -> size_t { return KeyCount; }
+  // False on duplicated keys or if a bucket found no seed
+  constexpr bool isValid(void) const { return m_valid; }
+
+private:
+  constexpr bool build(void)
+  {
+    std::array<size_t, BucketCount> bucketSize{};
+    std::array<size_t, BucketCount + 1> bucketStart{};
+    std::array<size_t, KeyCount> order{};
+    size_t maxSize = 0;
+
+    // Counting sort of the keys by bucket
+    for (size_t i = 0; i < KeyCount; i++) {
+      bucketSize[procKeyHash(m_keys[i], 0) & (BucketCount - 1)]++;
+    }
+    for (size_t b = 0; b < BucketCount; b++) {
+      bucketStart[b + 1] = bucketStart[b] + bucketSize[b];
+      maxSize = (bucketSize[b] > maxSize) ? bucketSize[b] : maxSize;
+    }
+    std::array<size_t, BucketCount> fill{};
+    for (size_t i = 0; i < KeyCount; i++) {
+      const auto b = procKeyHash(m_keys[i], 0) & (BucketCount - 1);
+      order[bucketStart[b] + fill[b]++] = i;
+    }
+
+    for (size_t size = maxSize; size > 0; size--) {
+      for (size_t b = 0; b < BucketCount; b++) {
+        if (bucketSize[b] == size && !placeBucket(b, &order[bucketStart[b]], size)) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  constexpr bool placeBucket(size_t bucket, const size_t *keys, size_t count)
+  {
+    std::array<size_t, KeyCount> slots{};
+
+    for (uint32_t seed = 1; seed <= UINT16_MAX; seed++) {
+      bool placed = true;
+
+      for (size_t i = 0; (i < count) && placed; i++) {
+        slots[i] = procKeyHash(m_keys[keys[i]], seed) & (TableSize - 1);
+        placed = (m_slots[slots[i]] == NoKey);
+        for (size_t j = 0; (j < i) && placed; j++) {
+          placed = (slots[i] != slots[j]);
+        }
+      }
+
+      if (placed) {
+        for (size_t i = 0; i < count; i++) {
+          m_slots[slots[i]] = static_cast<int16_t>(keys[i]);
+        }
+        m_seeds[bucket] = static_cast<uint16_t>(seed);
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+private:
+  std::array<std::string_view, KeyCount> m_keys{};
+  std::array<int16_t, TableSize> m_slots{};
+  std::array<uint16_t, BucketCount> m_seeds{};
+  bool m_valid = false;
+};
+
+/*
+ * Runtime selection over a ProcKeyTable with the last value read for each
+ * selected key. Lines of unselected keys are dropped after a single probe.
+ */
+template <typename Table>
+class ProcKeyFields
+{
+public:
+  explicit ProcKeyFields(const Table &table)
+  : m_table(table)
+  , m_selected(table.size(), false)
+  , m_values(table.size(), 0)
+  {
+  }
+
+public:
+  // False if the key is not known
+  bool select(std::string_view key)
+  {
+    const auto index = m_table.find(key);
+    if (index == Table::NoKey) {
+      return false;
+    }
+    if (!m_selected[static_cast<size_t>(index)]) {
+      m_selected[static_cast<size_t>(index)] = true;
+      m_count++;
+    }
+    return true;
+  }
+  // Key index if known and selected or Table::NoKey
+  auto lookup(std::string_view key) const -> int
+  {
+    const auto index = m_table.find(key);
+    return ((index != Table::NoKey) && m_selected[static_cast<size_t>(index)]) ? index
+                                                                             : Table::NoKey;
+  }
+  void setValue(int index, uint64_t value) { m_values[static_cast<size_t>(index)] = value; }
+  // Last value read or zero if the key is not selected or not found in the file
+  auto getValue(std::string_view key) const -> uint64_t
+  {
+    const auto index = lookup(key);
+    return (index != Table::NoKey) ? m_values[static_cast<size_t>(index)] : 0;
+  }
+  bool isSelected(std::string_view key) const { return lookup(key) != Table::NoKey; }
+  auto getSelectedCount(void) const -> size_t { return m_count; }
+  auto getTable(void) const -> const Table & { return m_table; }
+
+private:
+  const Table &m_table;
+  std::vector<bool> m_selected{};
+  std::vector<uint64_t> m_values{};
+  size_t m_count = 0;
+};
+
+/*
+ * /proc/meminfo field names without the ':' suffix
+ */
+constexpr const char *MemInfoKeys[] = {
+    "MemTotal",
+    "MemFree",
+    "MemAvailable",
+    "Buffers",
+    "Cached",
+    "SwapCached",
+    "Active",
+    "Inactive",
+    "Active(anon)",
+    "Inactive(anon)",
+    "Active(file)",
+    "Inactive(file)",
+    "Unevictable",
+    "Mlocked",
+    "HighTotal",
+    "HighFree",
+    "LowTotal",
+    "LowFree",
+    "MmapCopy",
+    "SwapTotal",
+    "SwapFree",
+    "Zswap",
+    "Zswapped",
+    "Dirty",
+    "Writeback",
+    "AnonPages",
+    "Mapped",
+    "Shmem",
+    "KReclaimable",
+    "Slab",
+    "SReclaimable",
+    "SUnreclaim",
+    "KernelStack",
+    "ShadowCallStack",
+    "PageTables",
+    "SecPageTables",
+    "NFS_Unstable",
+    "Bounce",
+    "WritebackTmp",
+    "CommitLimit",
+    "Committed_AS",
+    "VmallocTotal",
+    "VmallocUsed",
+    "VmallocChunk",
+    "Percpu",
+    "HardwareCorrupted",
+    "AnonHugePages",
+    "ShmemHugePages",
+    "ShmemPmdMapped",
+    "FileHugePages",
+    "FilePmdMapped",
+    "CmaTotal",
+    "CmaFree",
+    "Unaccepted",
+    "Balloon",
+    "HugePages_Total",
+    "HugePages_Free",
+    "HugePages_Rsvd",
+    "HugePages_Surp",
+    "Hugepagesize",
+    "Hugetlb",
+    "DirectMap4k",
+    "DirectMap4M",
+    "DirectMap2M",
+    "DirectMap1G"};
+
+constexpr ProcKeyTable<std::size(MemInfoKeys), 256> MemInfoKeyTable{MemInfoKeys};
+static_assert(MemInfoKeyTable.isValid(), "Invalid meminfo key table");
+
+/*
+ * /proc/vmstat field names
+ */
+constexpr const char *VMStatKeys[] = {
+    "nr_free_pages",
+    "nr_free_pages_blocks",
+    "nr_zone_inactive_anon",
+    "nr_zone_active_anon",
+    "nr_zone_inactive_file",
+    "nr_zone_active_file",
+    "nr_zone_unevictable",
+    "nr_zone_write_pending",
+    "nr_mlock",
+    "nr_bounce",
+    "nr_zspages",
+    "nr_free_cma",
+    "nr_unaccepted",
+    "numa_hit",
+    "numa_miss",
+    "numa_foreign",
+    "numa_interleave",
+    "numa_local",
+    "numa_other",
+    "nr_inactive_anon",
+    "nr_active_anon",
+    "nr_inactive_file",
+    "nr_active_file",
+    "nr_unevictable",
+    "nr_slab_reclaimable",
+    "nr_slab_unreclaimable",
+    "nr_isolated_anon",
+    "nr_isolated_file",
+    "workingset_nodes",
+    "workingset_refault",
+    "workingset_refault_anon",
+    "workingset_refault_file",
+    "workingset_activate",
+    "workingset_activate_anon",
+    "workingset_activate_file",
+    "workingset_restore",
+    "workingset_restore_anon",
+    "workingset_restore_file",
+    "workingset_nodereclaim",
+    "nr_anon_pages",
+    "nr_mapped",
+    "nr_file_pages",
+    "nr_dirty",
+    "nr_writeback",
+    "nr_writeback_temp",
+    "nr_shmem",
+    "nr_shmem_hugepages",
+    "nr_shmem_pmdmapped",
+    "nr_file_hugepages",
+    "nr_file_pmdmapped",
+    "nr_anon_transparent_hugepages",
+    "nr_vmscan_write",
+    "nr_vmscan_immediate_reclaim",
+    "nr_dirtied",
+    "nr_written",
+    "nr_throttled_written",
+    "nr_kernel_misc_reclaimable",
+    "nr_foll_pin_acquired",
+    "nr_foll_pin_released",
+    "nr_kernel_stack",
+    "nr_shadow_call_stack",
+    "nr_page_table_pages",
+    "nr_sec_page_table_pages",
+    "nr_iommu_pages",
+    "nr_swapcached",
+    "pgpromote_success",
+    "pgpromote_candidate",
+    "pgpromote_candidate_nrl",
+    "pgdemote_kswapd",
+    "pgdemote_direct",
+    "pgdemote_khugepaged",
+    "pgdemote_proactive",
+    "nr_hugetlb",
+    "nr_balloon_pages",
+    "nr_kernel_file_pages",
+    "nr_dirty_threshold",
+    "nr_dirty_background_threshold",
+    "nr_memmap_pages",
+    "nr_memmap_boot_pages",
+    "nr_unstable",
+    "pgpgin",
+    "pgpgout",
+    "pswpin",
+    "pswpout",
+    "pgalloc_dma",
+    "pgalloc_dma32",
+    "pgalloc_normal",
+    "pgalloc_high",
+    "pgalloc_movable",
+    "pgalloc_device",
+    "allocstall_dma",
+    "allocstall_dma32",
+    "allocstall_normal",
+    "allocstall_high",
+    "allocstall_movable",
+    "allocstall_device",
+    "pgskip_dma",
+    "pgskip_dma32",
+    "pgskip_normal",
+    "pgskip_high",
+    "pgskip_movable",
+    "pgskip_device",
+    "pgfree",
+    "pgactivate",
+    "pgdeactivate",
+    "pglazyfree",
+    "pgfault",
+    "pgmajfault",
+    "pglazyfreed",
+    "pgrefill",
+    "pgreuse",
+    "pgsteal_kswapd",
+    "pgsteal_direct",
+    "pgsteal_khugepaged",
+    "pgsteal_proactive",
+    "pgscan_kswapd",
+    "pgscan_direct",
+    "pgscan_khugepaged",
+    "pgscan_proactive",
+    "pgscan_direct_throttle",
+    "pgscan_anon",
+    "pgscan_file",
+    "pgsteal_anon",
+    "pgsteal_file",
+    "zone_reclaim_success",
+    "zone_reclaim_failed",
+    "pginodesteal",
+    "slabs_scanned",
+    "kswapd_inodesteal",
+    "kswapd_low_wmark_hit_quickly",
+    "kswapd_high_wmark_hit_quickly",
+    "pageoutrun",
+    "pgrotated",
+    "drop_pagecache",
+    "drop_slab",
+    "oom_kill",
+    "numa_pte_updates",
+    "numa_huge_pte_updates",
+    "numa_hint_faults",
+    "numa_hint_faults_local",
+    "numa_pages_migrated",
+    "pgmigrate_success",
+    "pgmigrate_fail",
+    "thp_migration_success",
+    "thp_migration_fail",
+    "thp_migration_split",
+    "compact_migrate_scanned",
+    "compact_free_scanned",
+    "compact_isolated",
+    "compact_stall",
+    "compact_fail",
+    "compact_success",
+    "compact_daemon_wake",
+    "compact_daemon_migrate_scanned",
+    "compact_daemon_free_scanned",
+    "htlb_buddy_alloc_success",
+    "htlb_buddy_alloc_fail",
+    "cma_alloc_success",
+    "cma_alloc_fail",
+    "unevictable_pgs_culled",
+    "unevictable_pgs_scanned",
+    "unevictable_pgs_rescued",
+    "unevictable_pgs_mlocked",
+    "unevictable_pgs_munlocked",
+    "unevictable_pgs_cleared",
+    "unevictable_pgs_stranded",
+    "thp_fault_alloc",
+    "thp_fault_fallback",
+    "thp_fault_fallback_charge",
+    "thp_collapse_alloc",
+    "thp_collapse_alloc_failed",
+    "thp_file_alloc",
+    "thp_file_fallback",
+    "thp_file_fallback_charge",
+    "thp_file_mapped",
+    "thp_split_page",
+    "thp_split_page_failed",
+    "thp_deferred_split_page",
+    "thp_underused_split_page",
+    "thp_split_pmd",
+    "thp_scan_exceed_none_pte",
+    "thp_scan_exceed_swap_pte",
+    "thp_scan_exceed_share_pte",
+    "thp_split_pud",
+    "thp_zero_page_alloc",
+    "thp_zero_page_alloc_failed",
+    "thp_swpout",
+    "thp_swpout_fallback",
+    "balloon_inflate",
+    "balloon_deflate",
+    "balloon_migrate",
+    "swap_ra",
+    "swap_ra_hit",
+    "swpin_zero",
+    "swpout_zero",
+    "ksm_swpin_copy",
+    "cow_ksm",
+    "zswpin",
+    "zswpout",
+    "zswpwb",
+    "direct_map_level2_splits",
+    "direct_map_level3_splits",
+    "direct_map_level2_collapses",
+    "direct_map_level3_collapses",
+    "nr_tlb_remote_flush",
+    "nr_tlb_remote_flush_received",
+    "nr_tlb_local_flush_all",
+    "nr_tlb_local_flush_one"};
+
+constexpr ProcKeyTable<std::size(VMStatKeys), 512> VMStatKeyTable{VMStatKeys};
+static_assert(VMStatKeyTable.isValid(), "Invalid vmstat key table");
+
+} // namespace tkm::monitor
@@ -0,0 +1,433 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcParser methods
+ * @details   Allocation free parsers for procfs files
+ *-
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "ProcParser.h"
+
+namespace tkm::monitor
+{
+
+static inline void skipSpaces(const char *&pos, const char *end)
+{
+  while ((pos < end) && (*pos == ' ' || *pos == '\t')) {
+    pos++;
+  }
+}
+
+bool scanUnsigned(const char *&pos, const char *end, uint64_t &value)
+{
+  skipSpaces(pos, end);
+
+  const char *start = pos;
+  uint64_t result = 0;
+  while ((pos < end) && (*pos >= '0') && (*pos <= '9')) {
+    result = result * 10 + static_cast<uint64_t>(*pos - '0');
+    pos++;
+  }
+
+  if (pos == start) {
+    return false;
+  }
+
+  value = result;
+  return true;
+}
+
+bool scanSigned(const char *&pos, const char *end, int64_t &value)
+{
+  skipSpaces(pos, end);
+
+  bool negative = false;
+  if ((pos < end) && (*pos == '-')) {
+    negative = true;
+    pos++;
+  }
+
+  uint64_t result = 0;
+  if (!scanUnsigned(pos, end, result)) {
+    return false;
+  }
+
+  value = negative ? -static_cast<int64_t>(result) : static_cast<int64_t>(result);
+  return true;
+}
+
+bool skipFields(const char *&pos, const char *end, size_t count)
+{
+  for (size_t i = 0; i < count; i++) {
+    skipSpaces(pos, end);
+    if (pos >= end) {
+      return false;
+    }
+    while ((pos < end) && (*pos != ' ') && (*pos != '\t') && (*pos != '\n')) {
+      pos++;
+    }
+  }
+
+  return true;
+}
+
+bool parseProcStat(const char *buf, size_t len, ProcStatData &data)
+{
+  const char *end = buf + len;
+  const char *pos = buf;
+  uint64_t val = 0;
+  int64_t sval = 0;
+
+  // (1) pid
+  if (!scanUnsigned(pos, end, val)) {
+    return false;
+  }
+  data.pid = static_cast<int>(val);
+
+  // (2) comm can contain spaces and parentheses so we skip after the last ')'
+  const char *commEnd = nullptr;
+  for (const char *p = end - 1; p > pos; p--) {
+    if (*p == ')') {
+      commEnd = p;
+      break;
+    }
+  }
+  if (commEnd == nullptr) {
+    return false;
+  }
+  pos = commEnd + 1;
+
+  // (3) state
+  skipSpaces(pos, end);
+  if (pos >= end) {
+    return false;
+  }
+  data.state = *pos++;
+
+  // (4) ppid
+  if (!scanUnsigned(pos, end, val)) {
+    return false;
+  }
+  data.ppid = static_cast<int>(val);
+
+  // (5) pgrp (6) session (7) tty_nr (8) tpgid
+  if (!skipFields(pos, end, 4)) {
+    return false;
+  }
+
+  // (9) flags
+  if (!scanUnsigned(pos, end, val)) {
+    return false;
+  }
+  data.flags = static_cast<uint32_t>(val);
+
+  // (10) minflt
+  if (!scanUnsigned(pos, end, data.minFlt)) {
+    return false;
+  }
+
+  // (11) cminflt
+  if (!skipFields(pos, end, 1)) {
+    return false;
+  }
+
+  // (12) majflt
+  if (!scanUnsigned(pos, end, data.majFlt)) {
+    return false;
+  }
+
+  // (13) cmajflt
+  if (!skipFields(pos, end, 1)) {
+    return false;
+  }
+
+  // (14) utime (15) stime
+  if (!scanUnsigned(pos, end, data.utime) || !scanUnsigned(pos, end, data.stime)) {
+    return false;
+  }
+
+  // (16) cutime (17) cstime (18) priority (19) nice
+  if (!skipFields(pos, end, 4)) {
+    return false;
+  }
+
+  // (20) num_threads
+  if (!scanSigned(pos, end, data.numThreads)) {
+    return false;
+  }
+
+  // (21) itrealvalue
+  if (!skipFields(pos, end, 1)) {
+    return false;
+  }
+
+  // (22) starttime (23) vsize (24) rss
+  if (!scanUnsigned(pos, end, data.startTime) || !scanUnsigned(pos, end, data.vsize) ||
+      !scanSigned(pos, end, sval)) {
+    return false;
+  }
+  data.rss = sval;
+
+  return true;
+}
+
+bool readProcStat(int fd, ProcStatData &data)
+{
+  char buf[ProcStatBufferSize];
+
+  auto len = ::pread(fd, buf, sizeof(buf), 0);
+  if (len <= 0) {
+    return false;
+  }
+
+  return parseProcStat(buf, static_cast<size_t>(len), data);
+}
+
+bool parseProcStatIdentity(const char *buf, size_t len, std::string &name, uint64_t &startTime)
+{
+  ProcStatData data{};
+
+  if (!parseProcStat(buf, len, data)) {
+    return false;
+  }
+
+  // The comm field is the text between the first '(' and the last ')'
+  auto commStart = static_cast<const char *>(::memchr(buf, '(', len));
+  if (commStart == nullptr) {
+    return false;
+  }
+
+  const char *commEnd = nullptr;
+  for (const char *p = buf + len - 1; p > commStart; p--) {
+    if (*p == ')') {
+      commEnd = p;
+      break;
+    }
+  }
+  if (commEnd == nullptr) {
+    return false;
+  }
+
+  name.assign(commStart + 1, static_cast<size_t>(commEnd - commStart - 1));
+  startTime = data.startTime;
+  return true;
+}
+
+bool readProcStatIdentity(int fd, std::string &name, uint64_t &startTime)
+{
+  char buf[ProcStatBufferSize];
+
+  auto len = ::pread(fd, buf, sizeof(buf), 0);
+  if (len <= 0) {
+    return false;
+  }
+
+  return parseProcStatIdentity(buf, static_cast<size_t>(len), name, startTime);
+}
+
+bool parseProcSmapsRollup(const char *buf, size_t len, ProcSmapsData &data)
+{
+  const char *end = buf + len;
+  const char *pos = buf;
+  bool hasRss = false;
+  bool hasPss = false;
+
+  while (pos < end) {
+    auto eol = static_cast<const char *>(::memchr(pos, '\n', static_cast<size_t>(end - pos)));
+    if (eol == nullptr) {
+      eol = end;
+    }
+
+    auto colon = static_cast<const char *>(::memchr(pos, ':', static_cast<size_t>(eol - pos)));
+    if (colon != nullptr) {
+      const auto keyLen = static_cast<size_t>(colon - pos);
+      uint64_t *target = nullptr;
+
+      if ((keyLen == 3) && (::memcmp(pos, "Rss", 3) == 0)) {
+        target = &data.rss;
+        hasRss = true;
+      } else if ((keyLen == 3) && (::memcmp(pos, "Pss", 3) == 0)) {
+        target = &data.pss;
+        hasPss = true;
+      }
+
+      if (target != nullptr) {
+        const char *val = colon + 1;
+        if (!scanUnsigned(val, eol, *target)) {
+          return false;
+        }
+      }
+    }
+
+    pos = eol + 1;
+  }
+
+  // Rss and Pss are mandatory
+  return hasRss && hasPss;
+}
+
+bool readProcSmapsRollup(int fd, ProcSmapsData &data)
+{
+  char buf[ProcSmapsBufferSize];
+
+  auto len = ::pread(fd, buf, sizeof(buf), 0);
+  if (len <= 0) {
+    return false;
+  }
+
+  return parseProcSmapsRollup(buf, static_cast<size_t>(len), data);
+}
+
+bool parseProcComm(const char *buf, size_t len, std::string &name)
+{
+  while ((len > 0) && (buf[len - 1] == '\n')) {
+    len--;
+  }
+
+  if (len == 0) {
+    return false;
+  }
+
+  name.assign(buf, len);
+  return true;
+}
+
+bool readProcComm(int fd, std::string &name)
+{
+  char buf[ProcCommBufferSize];
+
+  auto len = ::pread(fd, buf, sizeof(buf), 0);
+  if (len <= 0) {
+    return false;
+  }
+
+  return parseProcComm(buf, static_cast<size_t>(len), name);
+}
+
+bool parseProcCmdlineExe(const char *buf, size_t len, std::string &name)
+{
+  auto argEnd = static_cast<const char *>(::memchr(buf, '\0', len));
+  const size_t argLen = (argEnd != nullptr) ? static_cast<size_t>(argEnd - buf) : len;
+
+  if (argLen == 0) {
+    return false;
+  }
+
+  // Processes may rewrite argv[0] as a title (e.g. "sshd: user@pts/0") so the
+  // directory is only stripped from plain paths
+  const char *start = buf;
+  if (::memchr(buf, ' ', argLen) == nullptr) {
+    for (size_t i = 0; i < argLen; i++) {
+      if ((buf[i] == '/') && (i + 1 < argLen)) {
+        start = buf + i + 1;
+      }
+    }
+  }
+
+  name.assign(start, argLen - static_cast<size_t>(start - buf));
+  return true;
+}
+
+bool readProcCmdlineExe(int fd, std::string &name)
+{
+  char buf[ProcCmdlineBufferSize];
+
+  auto len = ::pread(fd, buf, sizeof(buf), 0);
+  if (len <= 0) {
+    return false;
+  }
+
+  return parseProcCmdlineExe(buf, static_cast<size_t>(len), name);
+}
+
+void parseProcDirents(const char *buf, size_t len, std::vector<int> &pids)
+{
+  // struct linux_dirent64 layout: d_ino(8) d_off(8) d_reclen(2) d_type(1) d_name
+  constexpr size_t recLenOffset = 16;
+  constexpr size_t nameOffset = 19;
+  size_t pos = 0;
+
+  while (pos + nameOffset < len) {
+    uint16_t recLen = 0;
+    ::memcpy(&recLen, buf + pos + recLenOffset, sizeof(recLen));
+    if ((recLen == 0) || (pos + recLen > len)) {
+      break;
+    }
+
+    const char *name = buf + pos + nameOffset;
+    const char *end = buf + pos + recLen;
+    int pid = 0;
+    bool numeric = (name < end) && (*name != '\0');
+
+    for (; (name < end) && (*name != '\0'); name++) {
+      if ((*name < '0') || (*name > '9')) {
+        numeric = false;
+        break;
+      }
+      pid = pid * 10 + (*name - '0');
+    }
+
+    if (numeric) {
+      pids.push_back(pid);
+    }
+    pos += recLen;
+  }
+}
+
+bool readProcPids(int dirFd, std::vector<int> &pids)
+{
+  char buf[ProcDirentBufferSize];
+
+  pids.clear();
+  if (::lseek(dirFd, 0, SEEK_SET) == -1) {
+    return false;
+  }
+
+  while (true) {
+    auto len = ::syscall(SYS_getdents64, dirFd, buf, sizeof(buf));
+    if (len < 0) {
+      return false;
+    }
+    if (len == 0) {
+      break;
+    }
+    parseProcDirents(buf, static_cast<size_t>(len), pids);
+  }
+
+  // procfs lists PIDs in ascending order, sort only if that ever changes
+  if (!std::is_sorted(pids.cbegin(), pids.cend())) {
+    std::sort(pids.begin(), pids.end());
+  }
+
+  return true;
+}
+
+void diffProcPids(const std::vector<int> &current,
+                  const std::vector<int> &known,
+                  std::vector<int> &added,
+                  std::vector<int> &gone)
+{
+  added.clear();
+  gone.clear();
+  std::set_difference(current.cbegin(),
+                      current.cend(),
+                      known.cbegin(),
+                      known.cend(),
+                      std::back_inserter(added));
+  std::set_difference(known.cbegin(),
+                      known.cend(),
+                      current.cbegin(),
+                      current.cend(),
+                      std::back_inserter(gone));
+}
+
+} // namespace tkm::monitor
@@ -0,0 +1,95 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcParser methods
+ * @details   Allocation free parsers for procfs files
+ *-
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tkm::monitor
+{
+
+// Enough for /proc/<pid>/stat lines (comm is at most 64 bytes)
+constexpr size_t ProcStatBufferSize = 1024;
+// Enough for /proc/<pid>/smaps_rollup (about 25 lines)
+constexpr size_t ProcSmapsBufferSize = 2048;
+// Enough for /proc/<pid>/comm (TASK_COMM_LEN is 16, kernel workers use up to 64)
+constexpr size_t ProcCommBufferSize = 64;
+// Enough for the executable path at the start of /proc/<pid>/cmdline
+constexpr size_t ProcCmdlineBufferSize = 4096;
+// getdents64 buffer for /proc (about 400 PID entries per call)
+constexpr size_t ProcDirentBufferSize = 16384;
+
+typedef struct ProcStatData {
+  int pid = 0;
+  char state = '?';
+  int ppid = 0;
+  uint32_t flags = 0;
+  uint64_t minFlt = 0;
+  uint64_t majFlt = 0;
+  uint64_t utime = 0;
+  uint64_t stime = 0;
+  int64_t numThreads = 0;
+  uint64_t startTime = 0;
+  uint64_t vsize = 0;
+  int64_t rss = 0;
+} ProcStatData;
+
+typedef struct ProcSmapsData {
+  uint64_t rss = 0;
+  uint64_t pss = 0;
+} ProcSmapsData;
+
+// Scan an unsigned decimal at pos and advance pos after it. Returns false if no digit found.
+bool scanUnsigned(const char *&pos, const char *end, uint64_t &value);
+// Scan a signed decimal at pos and advance pos after it. Returns false if no digit found.
+bool scanSigned(const char *&pos, const char *end, int64_t &value);
+// Skip count space separated fields starting at pos
+bool skipFields(const char *&pos, const char *end, size_t count);
+
+// Parse a /proc/<pid>/stat line from buf
+bool parseProcStat(const char *buf, size_t len, ProcStatData &data);
+// Read and parse /proc/<pid>/stat from an open file descriptor with a single read
+bool readProcStat(int fd, ProcStatData &data);
+// Parse the process name (comm) and start time from a /proc/<pid>/stat line
+bool parseProcStatIdentity(const char *buf, size_t len, std::string &name, uint64_t &startTime);
+// Read and parse the process name and start time from an open /proc/<pid>/stat descriptor
+bool readProcStatIdentity(int fd, std::string &name, uint64_t &startTime);
+
+// Parse /proc/<pid>/smaps_rollup content from buf
+bool parseProcSmapsRollup(const char *buf, size_t len, ProcSmapsData &data);
+// Read and parse /proc/<pid>/smaps_rollup from an open file descriptor
+bool readProcSmapsRollup(int fd, ProcSmapsData &data);
+
+// Parse /proc/<pid>/comm content (the name ends with a new line)
+bool parseProcComm(const char *buf, size_t len, std::string &name);
+// Read and parse /proc/<pid>/comm from an open file descriptor with a single read
+bool readProcComm(int fd, std::string &name);
+
+// Parse the executable name from /proc/<pid>/cmdline content (NUL separated).
+// Returns false if empty (i.e. kernel threads and zombies).
+bool parseProcCmdlineExe(const char *buf, size_t len, std::string &name);
+// Read and parse the executable name from /proc/<pid>/cmdline
+bool readProcCmdlineExe(int fd, std::string &name);
+
+// Append the numeric (PID) entry names from a getdents64 buffer to pids
+void parseProcDirents(const char *buf, size_t len, std::vector<int> &pids);
+// Read the sorted list of PIDs from an open /proc directory descriptor
+bool readProcPids(int dirFd, std::vector<int> &pids);
+// Merge diff two sorted PID lists. Added are in current only, gone in known only.
+void diffProcPids(const std::vector<int> &current,
+                  const std::vector<int> &known,
+                  std::vector<int> &added,
+                  std::vector<int> &gone);
+
+} // namespace tkm::monitor
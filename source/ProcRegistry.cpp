@@ -9,13 +9,11 @@
  *-
  */
 
-#if __has_include(<filesystem>)
-#include <filesystem>
-namespace fs = std::filesystem;
-#else
-#include <experimental/filesystem>
-namespace fs = std::experimental::filesystem;
-#endif
+#include <algorithm>
+#include <fcntl.h>
+#include <iterator>
+#include <thread>
+#include <unistd.h>
 
 #include "Application.h"
 #include "ProcRegistry.h"
@@ -25,6 +23,8 @@ namespace tkm::monitor
 
 static bool doCommitProcList(const std::shared_ptr<ProcRegistry> mgr);
 static bool doCommitContextList(const std::shared_ptr<ProcRegistry> mgr);
+static bool doSweepProcList(const std::shared_ptr<ProcRegistry> mgr);
+static bool doPublishProcSamples(const std::shared_ptr<ProcRegistry> mgr);
 static bool doCollectAndSendProcAcct(const std::shared_ptr<ProcRegistry> mgr,
                                      const ProcRegistry::Request &rq);
 static bool doCollectAndSendProcInfo(const std::shared_ptr<ProcRegistry> mgr,
@@ -37,6 +37,52 @@ ProcRegistry::ProcRegistry(const std::shared_ptr<Options> options)
 {
   m_queue = std::make_shared<AsyncQueue<Request>>(
       "ProcRegistryEventQueue", [this](const Request &request) { return requestHandler(request); });
+
+  size_t samplingThreads = m_options->getSettings().samplingThreads;
+
+  if (samplingThreads > 0) {
+    const size_t maxThreads = std::max(1U, std::thread::hardware_concurrency());
+    samplingThreads = std::min(samplingThreads, maxThreads);
+    logInfo() << "ProcInfo sampling uses " << samplingThreads << " worker threads";
+    m_samplingPool = std::make_unique<SamplingPool>("ProcRegistrySamplingPool", samplingThreads);
+  }
+
+  if (m_options->hasConfigFile()) {
+    const std::vector<bswi::kf::Property> props =
+        m_options->getConfigFile()->getProperties("blacklist", -1);
+    for (const auto &prop : props) {
+      m_procFilter.addRule(prop.key);
+    }
+    m_procFilter.compile();
+    logDebug() << "Process filter compiled with " << m_procFilter.getRuleCount() << " rules";
+
+    const std::vector<bswi::kf::Property> watchProps =
+        m_options->getConfigFile()->getProperties("threads", -1);
+    for (const auto &prop : watchProps) {
+      m_threadFilter.addRule(prop.key);
+    }
+    m_threadFilter.compile();
+  }
+
+  if (m_options->getSettings().enableProcPidFd) {
+    m_exitWatch = ProcExitWatch::isSupported();
+    if (m_exitWatch) {
+      logInfo() << "Process exit is tracked with pidfd";
+    }
+  }
+
+  m_procDirFd = ::open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (m_procDirFd < 0) {
+    throw std::runtime_error("Fail to open /proc directory");
+  }
+}
+
+ProcRegistry::~ProcRegistry()
+{
+  if (m_procDirFd != -1) {
+    ::close(m_procDirFd);
+    m_procDirFd = -1;
+  }
 }
 
 auto ProcRegistry::pushRequest(Request &request) -> int
@@ -48,7 +94,7 @@ void ProcRegistry::setEventSource(bool enabled)
 {
   if (enabled) {
     App()->addEventSource(m_queue);
-    if (m_options->getFor(Options::Key::ReadProcAtInit) == "true") {
+    if (m_options->getSettings().readProcAtInit) {
       initFromProc();
     }
   } else {
@@ -63,6 +109,10 @@ auto ProcRegistry::requestHandler(const Request &request) -> bool
     return doCommitProcList(getShared());
   case ProcRegistry::Action::CommitContextList:
     return doCommitContextList(getShared());
+  case ProcRegistry::Action::SweepProcList:
+    return doSweepProcList(getShared());
+  case ProcRegistry::Action::PublishProcSamples:
+    return doPublishProcSamples(getShared());
   case ProcRegistry::Action::CollectAndSendProcAcct:
     return doCollectAndSendProcAcct(getShared(), request);
   case ProcRegistry::Action::CollectAndSendProcInfo:
@@ -79,123 +129,88 @@ auto ProcRegistry::requestHandler(const Request &request) -> bool
 
 void ProcRegistry::initFromProc(void)
 {
-  std::string path = "/proc";
-
   logDebug() << "Read existing proc entries";
-  for (const auto &entry : fs::directory_iterator(path)) {
-    int pid = -1;
-
-    try {
-      pid = std::stoi(entry.path().filename());
-    } catch (...) {
-      continue;
-    }
-
-    if (pid != -1) {
-      std::string procName;
-
-      try {
-        procName = getProcNameForPID(pid);
-      } catch (...) {
-        logError() << "Failed to read procname for pid=" << pid;
-        continue;
-      }
-
-      if (!isBlacklisted(procName)) {
-        createProcessEntry(pid, procName);
-      }
-    }
-  }
+  updateProcessList();
 }
 
 auto ProcRegistry::getProcEntry(int pid) -> const std::shared_ptr<ProcEntry>
 {
-  std::shared_ptr<ProcEntry> retEntry = nullptr;
-
-  m_procList.foreach ([pid, &retEntry](const std::shared_ptr<ProcEntry> &entry) {
-    if (entry->getPid() == pid) {
-      retEntry = entry;
-    }
-  });
-
-  return retEntry;
+  return m_procIndex.find(pid);
 }
 
 auto ProcRegistry::getProcEntry(const std::string &name) -> const std::shared_ptr<ProcEntry>
 {
-  std::shared_ptr<ProcEntry> retEntry = nullptr;
-
-  m_procList.foreach ([&name, &retEntry](const std::shared_ptr<ProcEntry> &entry) {
-    if (entry->getName() == name) {
-      retEntry = entry;
-    }
-  });
-
-  return retEntry;
+  return m_procIndex.find(name);
 }
 
 void ProcRegistry::addProcEntry(int pid)
 {
-  auto found = false;
-
-  m_procList.foreach ([&found, pid](const std::shared_ptr<ProcEntry> &entry) {
-    if (entry->getPid() == pid) {
-      found = true;
-    }
-  });
-
-  if (!found) {
-    std::string procName;
+  if (m_procIndex.find(pid) != nullptr) {
+    return;
+  }
 
-    try {
-      procName = getProcNameForPID(pid);
-    } catch (...) {
-      logDebug() << "Proc entry removed before entry added";
-      return;
-    }
+  std::string procName;
+  try {
+    procName = getProcNameForPID(pid);
+  } catch (...) {
+    logDebug() << "Proc entry removed before entry added";
+    return;
+  }
 
-    if (!isBlacklisted(procName)) {
-      createProcessEntry(pid, procName);
-    }
+  if (!isBlacklisted(pid, procName)) {
+    createProcessEntry(pid, procName, true);
   }
 }
 
 void ProcRegistry::updProcEntry(int pid)
 {
-  m_procList.foreach ([this, pid](const std::shared_ptr<ProcEntry> &entry) {
-    if (entry->getPid() == pid) {
-      std::string procName;
+  auto entry = m_procIndex.find(pid);
+  if (entry == nullptr) {
+    return;
+  }
 
-      try {
-        procName = getProcNameForPID(pid);
-      } catch (...) {
-        logWarn() << "Proc entry removed before entry updated";
-        return;
-      }
+  std::string procName;
+  try {
+    procName = getProcNameForPID(pid);
+  } catch (...) {
+    logWarn() << "Proc entry removed before entry updated";
+    return;
+  }
 
-      if (entry->getName() == procName) {
-        return;
-      }
+  if (entry->getName() == procName) {
+    return;
+  }
 
-      if (isBlacklisted(procName)) {
-        m_procList.remove(entry);
-      } else {
-        logDebug() << "Update process name for pid=" << pid << " name=" << procName;
-        entry->setName(procName);
-      }
+  if (isBlacklisted(pid, procName)) {
+    unwatchExit(entry);
+    detachContext(entry);
+    m_procIndex.erase(entry);
+    m_procList.remove(entry, true); // sync commit
+  } else {
+    logDebug() << "Update process name for pid=" << pid << " name=" << procName;
+    const std::string oldName{entry->getName()};
+    entry->setName(procName);
+    m_procIndex.rename(entry, oldName);
+    if ((m_threadFilter.getRuleCount() > 0) && m_threadFilter.matchProcess(pid, procName)) {
+      entry->setThreadMonitor(true);
     }
-  });
-  m_procList.commit(); // sync commit
+  }
+  invalidateDataCache();
 }
 
 void ProcRegistry::remProcEntry(int pid, bool sync)
 {
-  m_procList.foreach ([this, pid](const std::shared_ptr<ProcEntry> &entry) {
-    if (entry->getPid() == pid) {
-      logDebug() << "Found entry to remove with pid " << pid;
-      m_procList.remove(entry);
-    }
-  });
+  auto entry = m_procIndex.find(pid);
+  if (entry == nullptr) {
+    return;
+  }
+
+  logDebug() << "Found entry to remove with pid " << pid;
+  unwatchExit(entry);
+  detachContext(entry);
+  m_procIndex.erase(entry);
+  m_procList.remove(entry);
+  invalidateDataCache();
 
   if (sync) {
     m_procList.commit();
@@ -208,12 +223,19 @@ void ProcRegistry::remProcEntry(int pid, bool sync)
 
 void ProcRegistry::remProcEntry(const std::string &name, bool sync)
 {
-  m_procList.foreach ([this, &name](const std::shared_ptr<ProcEntry> &entry) {
-    if (entry->getName() == name) {
-      logDebug() << "Found entry to remove with pid " << entry->getPid();
-      m_procList.remove(entry);
-    }
-  });
+  auto entries = m_procIndex.findAll(name);
+  if (entries.empty()) {
+    return;
+  }
+
+  for (const auto &entry : entries) {
+    logDebug() << "Found entry to remove with pid " << entry->getPid();
+    unwatchExit(entry);
+    detachContext(entry);
+    m_procIndex.erase(entry);
+    m_procList.remove(entry);
+  }
+  invalidateDataCache();
 
   if (sync) {
     m_procList.commit();
@@ -224,62 +246,142 @@ void ProcRegistry::remProcEntry(const std::string &name, bool sync)
   }
 }
 
-bool ProcRegistry::isBlacklisted(const std::string &name)
+void ProcRegistry::applyProcEvents(const std::vector<int> &exited,
+                                   const std::vector<int> &forked,
+                                   const std::vector<int> &execed)
 {
-  if (m_options->hasConfigFile()) {
-    const std::vector<bswi::kf::Property> props =
-        m_options->getConfigFile()->getProperties("blacklist", -1);
-    for (const auto &prop : props) {
-      if (name.find(prop.key) != std::string::npos) {
-        return true;
-      }
+  // Exits first so a reused PID in the same window gets a fresh entry
+  for (const auto pid : exited) {
+    auto entry = m_procIndex.find(pid);
+    if (entry != nullptr) {
+      entry->markStale();
     }
   }
-  return false;
-}
+  bool changed = (sweepProcList() > 0);
 
-auto ProcRegistry::getProcNameForPID(int pid) -> std::string
-{
-  auto statusPath = fs::path("/proc") / fs::path(std::to_string(pid)) / fs::path("status");
-  std::ifstream statusStream{statusPath};
+  for (const auto pid : forked) {
+    if (m_procIndex.find(pid) != nullptr) {
+      continue;
+    }
 
-  if (!statusStream.is_open()) {
-    logDebug() << "Failed to open status file for pid " << pid;
-    throw std::runtime_error("Fail to open /proc/<pid>/status file");
+    std::string procName;
+    try {
+      procName = getProcNameForPID(pid);
+    } catch (...) {
+      logDebug() << "Proc entry removed before entry added";
+      continue;
+    }
+
+    if (!isBlacklisted(pid, procName) && createProcessEntry(pid, procName, false)) {
+      changed = true;
+    }
   }
 
-  std::string line;
-  while (std::getline(statusStream, line)) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(line);
-    std::string buf;
+  if (changed) {
+    m_procList.commit();
+    invalidateDataCache();
+  }
 
-    if (line.find("Name") == std::string::npos) {
-      break;
+  for (const auto pid : execed) {
+    auto entry = m_procIndex.find(pid);
+    if (entry != nullptr) {
+      entry->setGeneration(m_generation);
+      updProcEntry(pid);
     }
+  }
+}
 
-    while (ss >> buf) {
-      tokens.push_back(buf);
-    }
+void ProcRegistry::markProcExit(const std::shared_ptr<ProcEntry> &entry)
+{
+  entry->markStale();
+  if (m_sweepPending) {
+    return;
+  }
 
-    if (tokens.size() < 2) {
-      logError() << "Proc status file parse error";
-      throw std::runtime_error("Fail to parse /proc/<pid>/status file");
-    }
+  ProcRegistry::Request rq = {.action = ProcRegistry::Action::SweepProcList,
+                              .collector = nullptr};
+  m_sweepPending = pushRequest(rq);
+}
+
+void ProcRegistry::sweepExitedProcs(void)
+{
+  m_sweepPending = false;
+  if (sweepProcList() > 0) {
+    m_procList.commit();
+    invalidateDataCache();
+  }
+}
 
-    std::string name{tokens[1]};
-    for (size_t i = 2; i < tokens.size(); i++) {
-      name.append(" " + tokens[i]);
+auto ProcRegistry::sweepProcList(void) -> size_t
+{
+  m_retiredEntries.clear();
+  m_procList.foreach ([this](const std::shared_ptr<ProcEntry> &entry) {
+    if (entry->getGeneration() < m_generation) {
+      m_retiredEntries.push_back(entry);
     }
+  });
 
-    return name;
+  for (const auto &entry : m_retiredEntries) {
+    logDebug() << "Sweep stale entry with pid " << entry->getPid();
+    unwatchExit(entry);
+    detachContext(entry);
+    m_procIndex.erase(entry);
+    m_procList.remove(entry);
   }
 
-  logError() << "Failed to parse status file for pid " << pid;
-  throw std::runtime_error("Fail to find the process name");
+  m_sweepCount++;
+  m_retiredCount += m_retiredEntries.size();
+
+  // The caller commits the process list once for all changes
+  return m_retiredEntries.size();
 }
 
-void ProcRegistry::createProcessEntry(int pid, const std::string &name)
+bool ProcRegistry::isBlacklisted(int pid, const std::string &name)
+{
+  return m_procFilter.isExcluded(pid, name);
+}
+
+auto ProcRegistry::getProcNameForPID(int pid) -> std::string
+{
+  char path[32];
+
+  // The comm file holds only the task name while status is fully rendered
+  snprintf(path, sizeof(path), "/proc/%d/comm", pid);
+  int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    logDebug() << "Failed to open comm file for pid " << pid;
+    throw std::runtime_error("Fail to open /proc/<pid>/comm file");
+  }
+
+  std::string name;
+  auto status = readProcComm(fd, name);
+  ::close(fd);
+
+  if (!status) {
+    logDebug() << "Failed to read comm file for pid " << pid;
+    throw std::runtime_error("Fail to read the process name");
+  }
+
+  return name;
+}
+
+bool ProcRegistry::readProcIdentity(int pid, std::string &name, uint64_t &startTime)
+{
+  char path[32];
+
+  snprintf(path, sizeof(path), "%d/stat", pid);
+  int fd = ::openat(m_procDirFd, path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  auto status = readProcStatIdentity(fd, name, startTime);
+  ::close(fd);
+
+  return status;
+}
+
+bool ProcRegistry::createProcessEntry(int pid, const std::string &name, bool sync)
 {
   std::shared_ptr<ProcEntry> procEntry = nullptr;
 
@@ -288,50 +390,172 @@ void ProcRegistry::createProcessEntry(int pid, const std::string &name)
   } catch (std::exception &e) {
     logError() << "Cannot create ProcEntry object for pid=" << pid << " name=" << name
                << ". Reason=" << e.what();
-    return;
+    return false;
+  }
+
+  if (m_exitWatch && !watchExit(procEntry)) {
+    logDebug() << "Process exited before entry added for pid=" << pid;
+    return false;
   }
 
   // ProcInfo is on default ProcRegistry interval
   procEntry->setUpdateInterval(getUpdateInterval());
+  procEntry->setGeneration(m_generation);
+  if ((m_threadFilter.getRuleCount() > 0) && m_threadFilter.matchProcess(pid, name)) {
+    procEntry->setThreadMonitor(true);
+  }
 
   logDebug() << "Add process monitoring for pid=" << pid << " name=" << name
              << " context=" << procEntry->getData().ctx_name();
-  m_procList.append(procEntry, true);
+  m_procList.append(procEntry, sync);
+  m_procIndex.insert(procEntry);
+  attachContext(procEntry);
+  invalidateDataCache();
+
+  return true;
+}
 
-  bool found = false;
-  m_contextList.foreach ([&found, &procEntry](const std::shared_ptr<ContextEntry> &ctxEntry) {
-    if (procEntry->getContextId() == ctxEntry->getContextId()) {
-      found = true;
+void ProcRegistry::invalidateDataCache(void)
+{
+  m_procInfoCache.invalidate();
+  m_contextInfoCache.invalidate();
+}
+
+void ProcRegistry::updContextEntry(const std::shared_ptr<ProcEntry> &entry)
+{
+  detachContext(entry);
+  attachContext(entry);
+}
+
+void ProcRegistry::attachContext(const std::shared_ptr<ProcEntry> &entry)
+{
+  std::shared_ptr<ContextEntry> context = nullptr;
+
+  m_contextList.foreach ([&context, &entry](const std::shared_ptr<ContextEntry> &ctxEntry) {
+    if (entry->getContextId() == ctxEntry->getContextId()) {
+      context = ctxEntry;
     }
   });
 
-  if (!found) {
-    std::shared_ptr<ContextEntry> ctxEntry = std::make_shared<ContextEntry>(
-        procEntry->getData().ctx_id(), procEntry->getData().ctx_name());
-    m_contextList.append(ctxEntry, true);
+  if (context == nullptr) {
+    context = std::make_shared<ContextEntry>(entry->getData().ctx_id(),
+                                             entry->getData().ctx_name());
+    if (entry->getData().ctx_name() == "root") {
+      context->setCGroup("/");
+    }
+    m_contextList.append(context, true);
   }
+
+  // The context pressure is read from the common ancestor of its process
+  // cgroups (i.e. the container cgroup above the init.scope of its init)
+  if (hasContextPressure() && (entry->getData().ctx_name() != "root")) {
+    std::string cgroup;
+    if (readProcCGroup(entry->getPid(), cgroup)) {
+      entry->setCGroup(cgroup);
+      context->addProcCGroup(cgroup);
+    }
+  }
+
+  context->addProc(entry->getData());
+  entry->setContext(context);
 }
 
-bool ProcRegistry::update(UpdateLane lane)
+bool ProcRegistry::hasContextPressure(void)
+{
+  // Process cgroups are only read for the per context PSI on cgroup v2
+  const auto pressure = App()->getSysProcPressure();
+  return (pressure != nullptr) && pressure->hasContextPressure();
+}
+
+void ProcRegistry::detachContext(const std::shared_ptr<ProcEntry> &entry)
+{
+  auto context = entry->getContext();
+  if (context == nullptr) {
+    return;
+  }
+
+  context->remProc(entry->getData());
+  entry->setContext(nullptr);
+  if (!entry->getCGroup().empty()) {
+    context->remProcCGroup(entry->getCGroup());
+    entry->setCGroup(std::string{});
+  }
+
+  // Drop the context with its last process
+  if (context->getProcCount() == 0) {
+    m_contextList.remove(context, true);
+  }
+}
+
+bool ProcRegistry::watchExit(const std::shared_ptr<ProcEntry> &entry)
+{
+  std::shared_ptr<ProcExitWatch> watch = nullptr;
+
+  try {
+    watch = std::make_shared<ProcExitWatch>(entry);
+  } catch (std::exception &e) {
+    // Keep the entry without pidfd (e.g. out of file descriptors) if still running
+    logDebug() << e.what();
+    return entry->checkAlive();
+  }
+
+  // The PID may be reused between the entry creation and pidfd_open. The
+  // entry descriptors still point to the original process so if it is alive
+  // now the pidfd refers to the same process.
+  if (!entry->checkAlive()) {
+    return false;
+  }
+
+  entry->setExitWatch(watch);
+  watch->setEventSource();
+
+  return true;
+}
+
+void ProcRegistry::unwatchExit(const std::shared_ptr<ProcEntry> &entry)
+{
+  auto watch = entry->getExitWatch();
+  if (watch == nullptr) {
+    return;
+  }
+
+  watch->setEventSource(false);
+  entry->setExitWatch(nullptr);
+}
+
+void ProcRegistry::refreshProcList(void)
 {
 #ifndef WITH_PROC_EVENT
   updateProcessList();
 #else
-  if (App()->getProcEvent() != nullptr) {
-    if (m_options->getFor(Options::Key::UpdateOnProcEvent) !=
-        tkmDefaults.valFor(Defaults::Val::True)) {
-      updateProcessList();
-    }
-  } else {
+  if ((App()->getProcEvent() == nullptr) || !m_options->getSettings().updateOnProcEvent) {
     updateProcessList();
+    return;
+  }
+
+  // The process list follows the process events, only sweep the entries
+  // found gone by the samplers
+  if (sweepProcList() > 0) {
+    m_procList.commit();
+    invalidateDataCache();
   }
 #endif
+}
+
+bool ProcRegistry::update(UpdateLane lane)
+{
+  refreshProcList();
 
   // We update ProcInfo data on Pace interval and ProcAcct on Slow interval
   if ((lane != UpdateLane::Pace) && (lane != UpdateLane::Slow)) {
     return true;
   }
 
+  if ((lane == UpdateLane::Pace) && (m_samplingPool != nullptr)) {
+    sampleProcList();
+    return true;
+  }
+
   m_procList.foreach ([&lane](const std::shared_ptr<ProcEntry> &entry) {
     if (lane == UpdateLane::Slow) {
 #ifdef WITH_PROC_ACCT
@@ -344,44 +568,169 @@ bool ProcRegistry::update(UpdateLane lane)
     }
   });
 
+#ifdef WITH_PROC_ACCT
+  // Send the remaining queued taskstats requests
+  if ((lane == UpdateLane::Slow) && (App()->getProcAcct() != nullptr)) {
+    App()->getProcAcct()->flushTaskAcct();
+  }
+#endif
+
+  if (lane == UpdateLane::Pace) {
+    invalidateDataCache();
+  }
+
   return true;
 }
 
 bool ProcRegistry::update(void)
 {
-#ifndef WITH_PROC_EVENT
-  updateProcessList();
-#else
-  if (App()->getProcEvent() != nullptr) {
-    if (m_options->getFor(Options::Key::UpdateOnProcEvent) !=
-        tkmDefaults.valFor(Defaults::Val::True)) {
-      updateProcessList();
-    }
-  } else {
-    updateProcessList();
+  refreshProcList();
+  m_procList.foreach ([](const std::shared_ptr<ProcEntry> &entry) { entry->update(); });
+#ifdef WITH_PROC_ACCT
+  if (App()->getProcAcct() != nullptr) {
+    App()->getProcAcct()->flushTaskAcct();
   }
 #endif
-  m_procList.foreach ([](const std::shared_ptr<ProcEntry> &entry) { entry->update(); });
+  invalidateDataCache();
   return true;
 }
 
+void ProcRegistry::sampleProcList(void)
+{
+  // Skip the tick if the workers are still busy with the previous batch
+  if (m_samplingPending) {
+    logDebug() << "ProcInfo sampling batch still in progress";
+    return;
+  }
+
+  m_samplingBatch.clear();
+  m_procList.foreach ([this](const std::shared_ptr<ProcEntry> &entry) {
+    if (entry->prepareSample()) {
+      m_samplingBatch.push_back(entry);
+    }
+  });
+
+  if (m_samplingBatch.empty()) {
+    return;
+  }
+
+  // The workers only touch the entry sample buffers and the batch is not
+  // modified until the publish request is processed on the main loop
+  m_samplingPending = m_samplingPool->run(
+      m_samplingBatch.size(),
+      [this](size_t index) { m_samplingBatch[index]->sampleInfoData(); },
+      [this]() {
+        ProcRegistry::Request rq = {.action = ProcRegistry::Action::PublishProcSamples,
+                                    .collector = nullptr};
+        pushRequest(rq);
+      });
+
+  if (!m_samplingPending) {
+    logError() << "Fail to start ProcInfo sampling batch";
+    for (const auto &entry : m_samplingBatch) {
+      entry->sampleInfoData();
+      entry->publishInfoData();
+    }
+    m_samplingBatch.clear();
+    invalidateDataCache();
+  }
+}
+
+void ProcRegistry::publishProcSamples(void)
+{
+  // All entries are published in the same loop iteration so collector
+  // requests never see a partially updated process list
+  for (const auto &entry : m_samplingBatch) {
+    if (m_procIndex.find(entry->getPid()) != entry) {
+      // Removed while sampling, the sample is dropped
+      continue;
+    }
+    entry->publishInfoData();
+  }
+
+  m_samplingBatch.clear();
+  m_samplingPending = false;
+  invalidateDataCache();
+}
+
 void ProcRegistry::updateProcessList(void)
 {
-  const fs::path procPath{"/proc"};
-  for (auto const &procEntry : fs::directory_iterator{procPath}) {
-#if __has_include(<filesystem>)
-    if (procEntry.is_directory()) {
-#else
-    if (fs::is_directory(procEntry.status())) {
-#endif
-      try {
-        int pid = std::stoi(procEntry.path().filename());
-        addProcEntry(pid);
-      } catch (...) {
+  if (!readProcPids(m_procDirFd, m_scanPids)) {
+    logError() << "Failed to read the process list from /proc";
+    return;
+  }
+  m_generation++;
+
+  m_procIndex.getPids(m_knownPids);
+  diffProcPids(m_scanPids, m_knownPids, m_addedPids, m_gonePids);
+
+  // Drop the rejected processes no longer present
+  m_ignoredProcs.erase(std::remove_if(m_ignoredProcs.begin(),
+                                      m_ignoredProcs.end(),
+                                      [this](const IgnoredProc &ignored) {
+                                        return !std::binary_search(
+                                            m_scanPids.cbegin(), m_scanPids.cend(), ignored.pid);
+                                      }),
+                       m_ignoredProcs.end());
+
+  // Stamp the registered processes still present. Gone PIDs and entries
+  // already found stale keep their generation and are swept.
+  size_t goneIdx = 0;
+  for (const auto pid : m_knownPids) {
+    if ((goneIdx < m_gonePids.size()) && (m_gonePids[goneIdx] == pid)) {
+      goneIdx++;
+      continue;
+    }
+
+    auto entry = m_procIndex.find(pid);
+    if ((entry != nullptr) && !entry->isStale()) {
+      entry->setGeneration(m_generation);
+    }
+  }
+  bool changed = (sweepProcList() > 0);
+
+  auto byPid = [](const IgnoredProc &ignored, int pid) { return ignored.pid < pid; };
+  for (const auto pid : m_addedPids) {
+    uint64_t startTime = 0;
+
+    // Read failures are transient (gone process, EMFILE) and retried next scan
+    if (!readProcIdentity(pid, m_scanName, startTime)) {
+      continue;
+    }
+
+    // Filter decisions hold while the PID is not reused and did not exec
+    auto ignored = std::lower_bound(m_ignoredProcs.begin(), m_ignoredProcs.end(), pid, byPid);
+    if ((ignored != m_ignoredProcs.end()) && (ignored->pid == pid)) {
+      if ((ignored->startTime == startTime) && (ignored->name == m_scanName)) {
         continue;
       }
+      m_ignoredProcs.erase(ignored);
+    }
+
+    if (isBlacklisted(pid, m_scanName)) {
+      m_rejectedProcs.push_back({.pid = pid, .startTime = startTime, .name = m_scanName});
+      continue;
+    }
+
+    if (createProcessEntry(pid, m_scanName, false)) {
+      changed = true;
     }
   }
+
+  if (!m_rejectedProcs.empty()) {
+    const auto middle = static_cast<std::ptrdiff_t>(m_ignoredProcs.size());
+    std::move(m_rejectedProcs.begin(), m_rejectedProcs.end(), std::back_inserter(m_ignoredProcs));
+    std::inplace_merge(m_ignoredProcs.begin(),
+                       m_ignoredProcs.begin() + middle,
+                       m_ignoredProcs.end(),
+                       [](const IgnoredProc &a, const IgnoredProc &b) { return a.pid < b.pid; });
+    m_rejectedProcs.clear();
+  }
+
+  if (changed) {
+    m_procList.commit();
+    invalidateDataCache();
+  }
 }
 
 static bool doCommitProcList(const std::shared_ptr<ProcRegistry> mgr)
@@ -396,6 +745,18 @@ static bool doCommitContextList(const std::shared_ptr<ProcRegistry> mgr)
   return true;
 }
 
+static bool doSweepProcList(const std::shared_ptr<ProcRegistry> mgr)
+{
+  mgr->sweepExitedProcs();
+  return true;
+}
+
+static bool doPublishProcSamples(const std::shared_ptr<ProcRegistry> mgr)
+{
+  mgr->publishProcSamples();
+  return true;
+}
+
 static bool doCollectAndSendProcAcct(const std::shared_ptr<ProcRegistry> mgr,
                                      const ProcRegistry::Request &rq)
 {
@@ -428,23 +789,40 @@ static bool doCollectAndSendProcAcct(const std::shared_ptr<ProcRegistry> mgr,
 static bool doCollectAndSendProcInfo(const std::shared_ptr<ProcRegistry> mgr,
                                      const ProcRegistry::Request &rq)
 {
-  tkm::msg::monitor::ProcInfo procInfo;
-  tkm::msg::monitor::Data data;
+  auto envelope = mgr->getProcInfoCache().get();
 
-  data.set_what(tkm::msg::monitor::Data_What_ProcInfo);
+  if (envelope == nullptr) {
+    tkm::msg::monitor::ProcInfo procInfo;
+    tkm::msg::monitor::Data data;
 
-  struct timespec currentTime;
-  clock_gettime(CLOCK_REALTIME, &currentTime);
-  data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
-  clock_gettime(CLOCK_MONOTONIC, &currentTime);
-  data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+    data.set_what(tkm::msg::monitor::Data_What_ProcInfo);
 
-  mgr->getProcList().foreach ([&procInfo](const std::shared_ptr<ProcEntry> &entry) {
-    procInfo.add_entry()->CopyFrom(entry->getData());
-  });
+    struct timespec currentTime;
+    clock_gettime(CLOCK_REALTIME, &currentTime);
+    data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+    data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+
+    const bool resolveExeName = App()->getOptions()->getSettings().resolveProcExeName;
+    mgr->getProcList().foreach (
+        [&procInfo, resolveExeName](const std::shared_ptr<ProcEntry> &entry) {
+          if (entry->isStale()) {
+            return;
+          }
+          auto procEntry = procInfo.add_entry();
+          procEntry->CopyFrom(entry->getData());
+          if (resolveExeName) {
+            procEntry->set_comm(entry->getExeName());
+          }
+        });
+
+    data.mutable_payload()->PackFrom(procInfo);
+
+    envelope = ICollector::makeDataEnvelope(data);
+    mgr->getProcInfoCache().store(envelope);
+  }
 
-  data.mutable_payload()->PackFrom(procInfo);
-  rq.collector->sendData(data);
+  rq.collector->writeEnvelope(*envelope);
 
   return true;
 }
@@ -452,53 +830,32 @@ static bool doCollectAndSendProcInfo(const std::shared_ptr<ProcRegistry> mgr,
 static bool doCollectAndSendContextInfo(const std::shared_ptr<ProcRegistry> mgr,
                                         const ProcRegistry::Request &rq)
 {
-  tkm::msg::monitor::ContextInfo contextInfo;
-  tkm::msg::monitor::Data data;
-
-  data.set_what(tkm::msg::monitor::Data_What_ContextInfo);
-
-  struct timespec currentTime;
-  clock_gettime(CLOCK_REALTIME, &currentTime);
-  data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
-  clock_gettime(CLOCK_MONOTONIC, &currentTime);
-  data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
-
-  // Update Context data
-  mgr->getContextList().foreach ([&mgr](const std::shared_ptr<ContextEntry> &ctxEntry) {
-    // Reset data
-    ctxEntry->resetData();
-
-    bool found = false;
-    mgr->getProcList().foreach ([&ctxEntry, &found](const std::shared_ptr<ProcEntry> &procEntry) {
-      if (ctxEntry->getContextId() == procEntry->getContextId()) {
-        auto totalCPUTime = ctxEntry->getData().total_cpu_time() + procEntry->getData().cpu_time();
-        ctxEntry->getData().set_total_cpu_time(totalCPUTime);
-        auto totalCPUPercent =
-            ctxEntry->getData().total_cpu_percent() + procEntry->getData().cpu_percent();
-        ctxEntry->getData().set_total_cpu_percent(totalCPUPercent);
-        auto totalMEMrss = ctxEntry->getData().total_mem_rss() + procEntry->getData().mem_rss();
-        ctxEntry->getData().set_total_mem_rss(totalMEMrss);
-        auto totalMEMpss = ctxEntry->getData().total_mem_pss() + procEntry->getData().mem_pss();
-        ctxEntry->getData().set_total_mem_pss(totalMEMpss);
-        found = true;
-      }
+  auto envelope = mgr->getContextInfoCache().get();
+
+  if (envelope == nullptr) {
+    tkm::msg::monitor::ContextInfo contextInfo;
+    tkm::msg::monitor::Data data;
+
+    data.set_what(tkm::msg::monitor::Data_What_ContextInfo);
+
+    struct timespec currentTime;
+    clock_gettime(CLOCK_REALTIME, &currentTime);
+    data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+    data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+
+    // Context totals are kept up to date on process add, sample and remove
+    mgr->getContextList().foreach ([&contextInfo](const std::shared_ptr<ContextEntry> &entry) {
+      contextInfo.add_entry()->CopyFrom(entry->getData());
     });
 
-    // If no process belongs to the context we remove the context
-    if (!found) {
-      mgr->getContextList().remove(ctxEntry);
-    }
-  });
-  ProcRegistry::Request crq = {.action = ProcRegistry::Action::CommitContextList,
-                               .collector = nullptr};
-  mgr->pushRequest(crq);
+    data.mutable_payload()->PackFrom(contextInfo);
 
-  mgr->getContextList().foreach ([&contextInfo](const std::shared_ptr<ContextEntry> &entry) {
-    contextInfo.add_entry()->CopyFrom(entry->getData());
-  });
+    envelope = ICollector::makeDataEnvelope(data);
+    mgr->getContextInfoCache().store(envelope);
+  }
 
-  data.mutable_payload()->PackFrom(contextInfo);
-  rq.collector->sendData(data);
+  rq.collector->writeEnvelope(*envelope);
 
   return true;
 }
@@ -11,12 +11,19 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "ContextEntry.h"
+#include "DataCache.h"
 #include "ICollector.h"
 #include "Options.h"
 #include "ProcEntry.h"
+#include "ProcExitWatch.h"
+#include "ProcFilter.h"
+#include "ProcIndex.h"
+#include "SamplingPool.h"
 
 #include "../bswinfra/source/AsyncQueue.h"
 #include "../bswinfra/source/SafeList.h"
@@ -29,9 +36,18 @@ namespace tkm::monitor
 class ProcRegistry : public IDataSource, public std::enable_shared_from_this<ProcRegistry>
 {
 public:
+  // Process rejected by the filter, valid while the PID identity is unchanged
+  typedef struct IgnoredProc {
+    int pid;
+    uint64_t startTime;
+    std::string name;
+  } IgnoredProc;
+
   enum class Action {
     CommitProcList,
     CommitContextList,
+    SweepProcList,
+    PublishProcSamples,
     CollectAndSendProcAcct,
     CollectAndSendProcInfo,
     CollectAndSendContextInfo
@@ -43,7 +59,7 @@ public:
 
 public:
   explicit ProcRegistry(const std::shared_ptr<Options> options);
-  virtual ~ProcRegistry() = default;
+  virtual ~ProcRegistry();
 
 public:
   ProcRegistry(ProcRegistry const &) = delete;
@@ -58,12 +74,23 @@ public:
   void updProcEntry(int pid);
   void remProcEntry(int pid, bool sync = false);
   void remProcEntry(const std::string &name, bool sync = false);
+  // Apply coalesced process events with a single process list commit
+  void applyProcEvents(const std::vector<int> &exited,
+                       const std::vector<int> &forked,
+                       const std::vector<int> &execed);
+  // Mark an exited entry stale, all exits queued until the sweep share one commit
+  void markProcExit(const std::shared_ptr<ProcEntry> &entry);
+  void sweepExitedProcs(void);
+  void updContextEntry(const std::shared_ptr<ProcEntry> &entry);
   auto getProcEntry(int pid) -> const std::shared_ptr<ProcEntry>;
   auto getProcEntry(const std::string &name) -> const std::shared_ptr<ProcEntry>;
   auto getProcList(void) -> bswi::util::SafeList<std::shared_ptr<ProcEntry>> &
   {
     return m_procList;
   }
+  auto getProcIndex(void) -> ProcIndex<ProcEntry> & { return m_procIndex; }
+  auto getProcInfoCache(void) -> DataCache & { return m_procInfoCache; }
+  auto getContextInfoCache(void) -> DataCache & { return m_contextInfoCache; }
   auto getContextList(void) -> bswi::util::SafeList<std::shared_ptr<ContextEntry>> &
   {
     return m_contextList;
@@ -71,20 +98,59 @@ public:
 
   auto pushRequest(ProcRegistry::Request &request) -> int;
   void updateProcessList(void);
+  auto getGeneration(void) -> uint64_t { return m_generation; }
+  auto getSweepCount(void) -> uint64_t { return m_sweepCount; }
+  auto getRetiredCount(void) -> uint64_t { return m_retiredCount; }
+  void publishProcSamples(void);
   bool update(UpdateLane lane) final;
   bool update(void) final;
 
 private:
   bool requestHandler(const Request &request);
   auto getProcNameForPID(int pid) -> std::string;
-  bool isBlacklisted(const std::string &name);
-  void createProcessEntry(int pid, const std::string &name);
+  bool readProcIdentity(int pid, std::string &name, uint64_t &startTime);
+  bool isBlacklisted(int pid, const std::string &name);
+  bool createProcessEntry(int pid, const std::string &name, bool sync);
+  void attachContext(const std::shared_ptr<ProcEntry> &entry);
+  void detachContext(const std::shared_ptr<ProcEntry> &entry);
+  bool hasContextPressure(void);
+  void refreshProcList(void);
+  auto sweepProcList(void) -> size_t;
+  bool watchExit(const std::shared_ptr<ProcEntry> &entry);
+  void unwatchExit(const std::shared_ptr<ProcEntry> &entry);
+  void sampleProcList(void);
+  void invalidateDataCache(void);
 
 private:
   bswi::util::SafeList<std::shared_ptr<ContextEntry>> m_contextList{"ProcRegistryContextList"};
   bswi::util::SafeList<std::shared_ptr<ProcEntry>> m_procList{"ProcRegistryProcList"};
+  ProcIndex<ProcEntry> m_procIndex{"ProcRegistryProcIndex"};
+  ProcFilter m_procFilter{"ProcRegistryProcFilter"};
+  ProcFilter m_threadFilter{"ProcRegistryThreadFilter"};
   std::shared_ptr<AsyncQueue<Request>> m_queue = nullptr;
   std::shared_ptr<Options> m_options = nullptr;
+  DataCache m_procInfoCache{"ProcRegistryProcInfoCache"};
+  DataCache m_contextInfoCache{"ProcRegistryContextInfoCache"};
+  std::vector<std::shared_ptr<ProcEntry>> m_samplingBatch{};
+  // Process list scan state, kept to avoid allocations on each scan
+  std::vector<int> m_scanPids{};
+  std::vector<int> m_knownPids{};
+  std::vector<int> m_addedPids{};
+  std::vector<int> m_gonePids{};
+  std::vector<IgnoredProc> m_ignoredProcs{};
+  std::vector<IgnoredProc> m_rejectedProcs{};
+  std::string m_scanName{};
+  // Entries removed by the last sweep, kept to avoid allocations on each sweep
+  std::vector<std::shared_ptr<ProcEntry>> m_retiredEntries{};
+  uint64_t m_generation = ProcEntry::StaleGeneration + 1;
+  uint64_t m_sweepCount = 0;
+  uint64_t m_retiredCount = 0;
+  bool m_sweepPending = false;
+  int m_procDirFd = -1;
+  bool m_samplingPending = false;
+  bool m_exitWatch = false;
+  // Keep last so the workers are joined before the batch is released
+  std::unique_ptr<SamplingPool> m_samplingPool = nullptr;
 };
 
 } // namespace tkm::monitor
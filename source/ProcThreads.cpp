@@ -0,0 +1,121 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcThreads Class
+ * @details   Per thread CPU usage for a monitored process
+ *-
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ProcParser.h"
+#include "ProcThreads.h"
+
+namespace tkm::monitor
+{
+
+ProcThreads::ProcThreads(int pid, int taskDirFd, size_t topCount)
+: m_topCount(std::max<size_t>(topCount, 1))
+, m_taskDirFd(taskDirFd)
+, m_pid(pid)
+{
+}
+
+ProcThreads::~ProcThreads()
+{
+  if (m_taskDirFd >= 0) {
+    ::close(m_taskDirFd);
+    m_taskDirFd = -1;
+  }
+}
+
+void ProcThreads::reset(void)
+{
+  m_threads.clear();
+  m_hotThreads.clear();
+  m_lastSampleTime = {};
+}
+
+bool ProcThreads::sample(void)
+{
+  if ((m_taskDirFd < 0) || !readProcPids(m_taskDirFd, m_tids)) {
+    return false;
+  }
+
+  using USec = std::chrono::microseconds;
+  const auto now = std::chrono::steady_clock::now();
+  const bool hasBaseline = (m_lastSampleTime.time_since_epoch().count() != 0);
+  const auto durationUs =
+      hasBaseline ? std::chrono::duration_cast<USec>(now - m_lastSampleTime).count() : 0;
+
+  m_generation++;
+  m_hotThreads.clear();
+
+  for (const auto tid : m_tids) {
+    ProcStatData data{};
+    char path[32];
+
+    snprintf(path, sizeof(path), "%d/stat", tid);
+    int fd = ::openat(m_taskDirFd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      continue;
+    }
+    auto status = readProcStat(fd, data);
+    ::close(fd);
+    if (!status) {
+      continue;
+    }
+
+    const uint64_t cpuTime = data.utime + data.stime;
+    auto [it, inserted] = m_threads.try_emplace(tid);
+    auto &thread = it->second;
+
+    if (inserted) {
+      // Thread names are read once, a new TID gets a new entry anyway
+      snprintf(path, sizeof(path), "%d/comm", tid);
+      fd = ::openat(m_taskDirFd, path, O_RDONLY | O_CLOEXEC);
+      if (fd >= 0) {
+        readProcComm(fd, thread.name);
+        ::close(fd);
+      }
+    } else if ((durationUs > 0) && (cpuTime > thread.cpuTime)) {
+      m_hotThreads.push_back(
+          {tid,
+           thread.name,
+           static_cast<uint32_t>(((cpuTime - thread.cpuTime) * 1000000) /
+                                 static_cast<uint64_t>(durationUs))});
+    }
+
+    thread.cpuTime = cpuTime;
+    thread.generation = m_generation;
+  }
+
+  // Drop the exited threads
+  for (auto it = m_threads.begin(); it != m_threads.end();) {
+    if (it->second.generation != m_generation) {
+      it = m_threads.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  const auto topCount = std::min(m_topCount, m_hotThreads.size());
+  std::partial_sort(m_hotThreads.begin(),
+                    m_hotThreads.begin() + static_cast<std::ptrdiff_t>(topCount),
+                    m_hotThreads.end(),
+                    [](const HotThread &a, const HotThread &b) {
+                      return a.cpuPercent > b.cpuPercent;
+                    });
+  m_hotThreads.resize(topCount);
+  m_lastSampleTime = now;
+
+  return true;
+}
+
+} // namespace tkm::monitor
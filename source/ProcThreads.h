@@ -0,0 +1,76 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcThreads Class
+ * @details   Per thread CPU usage for a monitored process
+ *-
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tkm::monitor
+{
+
+/*
+ * Scan /proc/<pid>/task and keep the CPU time of each thread between two
+ * samples. Each sample ranks the threads by CPU usage and keeps the top
+ * entries. The first sample of a thread is only a baseline so a reset
+ * restarts the deltas.
+ */
+class ProcThreads
+{
+public:
+  typedef struct HotThread {
+    int tid = 0;
+    std::string name{};
+    // Same scale as ProcInfoEntry cpu_percent
+    uint32_t cpuPercent = 0;
+  } HotThread;
+
+  static constexpr size_t DefaultTopCount = 5;
+
+public:
+  // Takes ownership of taskDirFd, an open /proc/<pid>/task directory
+  explicit ProcThreads(int pid, int taskDirFd, size_t topCount = DefaultTopCount);
+  ~ProcThreads();
+
+public:
+  ProcThreads(ProcThreads const &) = delete;
+  void operator=(ProcThreads const &) = delete;
+
+public:
+  bool sample(void);
+  void reset(void);
+
+  auto getHotThreads(void) const -> const std::vector<HotThread> & { return m_hotThreads; }
+  auto getThreadCount(void) const -> size_t { return m_threads.size(); }
+  auto getPid(void) const -> int { return m_pid; }
+
+private:
+  typedef struct Thread {
+    std::string name{};
+    uint64_t cpuTime = 0;
+    uint64_t generation = 0;
+  } Thread;
+
+private:
+  std::unordered_map<int, Thread> m_threads{};
+  std::vector<HotThread> m_hotThreads{};
+  std::vector<int> m_tids{};
+  std::chrono::time_point<std::chrono::steady_clock> m_lastSampleTime{};
+  uint64_t m_generation = 0;
+  size_t m_topCount = DefaultTopCount;
+  int m_taskDirFd = -1;
+  int m_pid = -1;
+};
+
+} // namespace tkm::monitor
@@ -0,0 +1,256 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcfsFile Class
+ * @details   Persistent procfs file reader with a zero copy line tokenizer
+ *-
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ProcfsFile.h"
+
+namespace tkm::monitor
+{
+
+static inline bool isSeparator(char c)
+{
+  return (c == ' ') || (c == '\t');
+}
+
+static inline bool isDigit(char c)
+{
+  return (c >= '0') && (c <= '9');
+}
+
+bool ProcfsLine::nextField(std::string_view &field)
+{
+  while ((m_pos < m_end) && isSeparator(*m_pos)) {
+    m_pos++;
+  }
+  if (m_pos >= m_end) {
+    return false;
+  }
+
+  const char *start = m_pos;
+  while ((m_pos < m_end) && !isSeparator(*m_pos)) {
+    m_pos++;
+  }
+
+  field = std::string_view(start, static_cast<size_t>(m_pos - start));
+  return true;
+}
+
+bool ProcfsLine::nextKeyValue(std::string_view &key, std::string_view &value)
+{
+  std::string_view field;
+  if (!nextField(field)) {
+    return false;
+  }
+
+  const auto sep = field.find('=');
+  if (sep == std::string_view::npos) {
+    return false;
+  }
+
+  key = field.substr(0, sep);
+  value = field.substr(sep + 1);
+  return true;
+}
+
+bool ProcfsLine::nextUnsigned(uint64_t &value)
+{
+  std::string_view field;
+  if (!nextField(field) || !isDigit(field.front())) {
+    return false;
+  }
+
+  uint64_t result = 0;
+  for (const auto c : field) {
+    if (!isDigit(c)) {
+      break;
+    }
+    result = result * 10 + static_cast<uint64_t>(c - '0');
+  }
+
+  value = result;
+  return true;
+}
+
+bool ProcfsLine::nextSigned(int64_t &value)
+{
+  std::string_view field;
+  if (!nextField(field)) {
+    return false;
+  }
+
+  const bool negative = (field.front() == '-');
+  if (negative) {
+    field.remove_prefix(1);
+  }
+  if (field.empty() || !isDigit(field.front())) {
+    return false;
+  }
+
+  uint64_t result = 0;
+  for (const auto c : field) {
+    if (!isDigit(c)) {
+      break;
+    }
+    result = result * 10 + static_cast<uint64_t>(c - '0');
+  }
+
+  value = negative ? -static_cast<int64_t>(result) : static_cast<int64_t>(result);
+  return true;
+}
+
+bool ProcfsLine::skipFields(size_t count)
+{
+  std::string_view field;
+
+  for (size_t i = 0; i < count; i++) {
+    if (!nextField(field)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+auto ProcfsLine::countFields(void) const -> size_t
+{
+  size_t count = 0;
+  bool inField = false;
+
+  for (const char *pos = m_pos; pos < m_end; pos++) {
+    if (isSeparator(*pos)) {
+      inField = false;
+    } else if (!inField) {
+      inField = true;
+      count++;
+    }
+  }
+
+  return count;
+}
+
+bool ProcfsLine::toUnsigned(std::string_view str, uint64_t &value)
+{
+  if (str.empty()) {
+    return false;
+  }
+
+  uint64_t result = 0;
+  for (const auto c : str) {
+    if (!isDigit(c)) {
+      return false;
+    }
+    result = result * 10 + static_cast<uint64_t>(c - '0');
+  }
+
+  value = result;
+  return true;
+}
+
+bool ProcfsLine::toDecimal(std::string_view str, float &value)
+{
+  const auto dot = str.find('.');
+  uint64_t integral = 0;
+
+  if (!toUnsigned(str.substr(0, dot), integral)) {
+    return false;
+  }
+
+  float result = static_cast<float>(integral);
+  if (dot != std::string_view::npos) {
+    float scale = 0.1f;
+    for (const auto c : str.substr(dot + 1)) {
+      if (!isDigit(c)) {
+        return false;
+      }
+      result += static_cast<float>(c - '0') * scale;
+      scale /= 10;
+    }
+  }
+
+  value = result;
+  return true;
+}
+
+ProcfsFile::ProcfsFile(const std::string &path, size_t bufferSize)
+: m_path(path)
+{
+  m_buffer.resize(std::max<size_t>(bufferSize, 64));
+  m_fd = ::open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+ProcfsFile::~ProcfsFile()
+{
+  if (m_fd >= 0) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
+
+bool ProcfsFile::read(void)
+{
+  m_size = 0;
+  m_pos = 0;
+
+  if (m_fd < 0) {
+    return false;
+  }
+
+  // Procfs may return less than requested, read until EOF
+  while (true) {
+    if (m_size == m_buffer.size()) {
+      m_buffer.resize(m_buffer.size() * 2);
+    }
+
+    auto len = ::pread(m_fd,
+                       m_buffer.data() + m_size,
+                       m_buffer.size() - m_size,
+                       static_cast<off_t>(m_size));
+    if (len < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      m_size = 0;
+      return false;
+    }
+    if (len == 0) {
+      break;
+    }
+    m_size += static_cast<size_t>(len);
+  }
+
+  return true;
+}
+
+bool ProcfsFile::nextLine(ProcfsLine &line)
+{
+  if (m_pos >= m_size) {
+    return false;
+  }
+
+  const char *start = m_buffer.data() + m_pos;
+  const char *end = m_buffer.data() + m_size;
+  auto eol = static_cast<const char *>(::memchr(start, '\n', static_cast<size_t>(end - start)));
+  if (eol == nullptr) {
+    eol = end;
+  }
+
+  line = ProcfsLine(start, eol);
+  m_pos = static_cast<size_t>(eol - m_buffer.data()) + 1;
+
+  return true;
+}
+
+} // namespace tkm::monitor
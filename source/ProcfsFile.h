@@ -0,0 +1,108 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcfsFile Class
+ * @details   Persistent procfs file reader with a zero copy line tokenizer
+ *-
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tkm::monitor
+{
+
+// Initial buffer size, grown on demand (i.e. /proc/stat on many cores)
+constexpr size_t ProcfsFileBufferSize = 8192;
+
+/*
+ * View over one line of a ProcfsFile buffer. Fields are separated by spaces
+ * or tabs and are consumed from the start of the line. The views are valid
+ * until the next ProcfsFile::read().
+ */
+class ProcfsLine
+{
+public:
+  ProcfsLine() = default;
+  ProcfsLine(const char *begin, const char *end)
+  : m_begin(begin)
+  , m_pos(begin)
+  , m_end(end)
+  {
+  }
+
+public:
+  auto view(void) const -> std::string_view
+  {
+    return std::string_view(m_begin, static_cast<size_t>(m_end - m_begin));
+  }
+  bool startsWith(std::string_view prefix) const
+  {
+    return view().compare(0, prefix.size(), prefix) == 0;
+  }
+  bool contains(std::string_view str) const { return view().find(str) != std::string_view::npos; }
+  void rewind(void) { m_pos = m_begin; }
+
+  // Next field, false at the end of line
+  bool nextField(std::string_view &field);
+  // Next field split at the first '=' (i.e. PSI "avg10=0.00")
+  bool nextKeyValue(std::string_view &key, std::string_view &value);
+  // Leading integer of the next field, the rest of the field (i.e. "70." or "0,") is skipped
+  bool nextUnsigned(uint64_t &value);
+  bool nextSigned(int64_t &value);
+  bool skipFields(size_t count);
+  // Number of fields left from the current position
+  auto countFields(void) const -> size_t;
+
+  static bool toUnsigned(std::string_view str, uint64_t &value);
+  // Fixed point decimal without exponent (i.e. "12.34")
+  static bool toDecimal(std::string_view str, float &value);
+
+private:
+  const char *m_begin = nullptr;
+  const char *m_pos = nullptr;
+  const char *m_end = nullptr;
+};
+
+/*
+ * Keep a procfs file open and read it again from the start with pread into a
+ * reused buffer. Lines are iterated in place without copies.
+ */
+class ProcfsFile
+{
+public:
+  explicit ProcfsFile(const std::string &path, size_t bufferSize = ProcfsFileBufferSize);
+  ~ProcfsFile();
+
+public:
+  ProcfsFile(ProcfsFile const &) = delete;
+  void operator=(ProcfsFile const &) = delete;
+
+public:
+  // Read the full file content and reset the line iterator
+  bool read(void);
+  // Next line of the last read, false after the last line
+  bool nextLine(ProcfsLine &line);
+
+  bool isOpen(void) const { return m_fd >= 0; }
+  auto getPath(void) const -> const std::string & { return m_path; }
+  auto getSize(void) const -> size_t { return m_size; }
+  auto getData(void) const -> std::string_view { return std::string_view(m_buffer.data(), m_size); }
+
+private:
+  std::vector<char> m_buffer{};
+  std::string m_path{};
+  size_t m_size = 0;
+  size_t m_pos = 0;
+  int m_fd = -1;
+};
+
+} // namespace tkm::monitor
@@ -0,0 +1,117 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     SamplingPool Class
+ * @details   Worker threads to sample data sources off the main loop
+ *-
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "SamplingPool.h"
+
+namespace tkm::monitor
+{
+
+SamplingPool::SamplingPool(const std::string &name, size_t threads)
+: m_name(name)
+{
+  if (threads == 0) {
+    throw std::runtime_error("Sampling pool needs at least one thread");
+  }
+
+  for (size_t i = 0; i < threads; i++) {
+    m_threads.emplace_back([this]() { worker(); });
+  }
+}
+
+SamplingPool::~SamplingPool()
+{
+  {
+    std::scoped_lock lk(m_mutex);
+    m_stop = true;
+  }
+  m_cond.notify_all();
+
+  for (auto &thread : m_threads) {
+    thread.join();
+  }
+}
+
+bool SamplingPool::run(size_t count, const Job &job, const Done &done)
+{
+  if (count == 0) {
+    return false;
+  }
+
+  {
+    std::scoped_lock lk(m_mutex);
+
+    if (m_busy.load() || m_stop) {
+      return false;
+    }
+
+    m_job = job;
+    m_done = done;
+    m_count = count;
+    m_running = m_threads.size();
+    m_next.store(0);
+    m_busy.store(true);
+    m_generation++;
+  }
+  m_cond.notify_all();
+
+  return true;
+}
+
+void SamplingPool::worker(void)
+{
+  uint64_t generation = 0;
+
+  while (true) {
+    Job job = nullptr;
+    size_t count = 0;
+
+    {
+      std::unique_lock lk(m_mutex);
+      m_cond.wait(lk, [this, &generation]() { return m_stop || (m_generation != generation); });
+      if (m_stop) {
+        return;
+      }
+      generation = m_generation;
+      job = m_job;
+      count = m_count;
+    }
+
+    // Pick chunks until the batch is exhausted
+    size_t start = m_next.fetch_add(ChunkSize);
+    while (start < count) {
+      const size_t end = std::min(start + ChunkSize, count);
+      for (size_t i = start; i < end; i++) {
+        job(i);
+      }
+      start = m_next.fetch_add(ChunkSize);
+    }
+
+    Done done = nullptr;
+    {
+      std::scoped_lock lk(m_mutex);
+      if (--m_running == 0) {
+        done = std::move(m_done);
+        m_done = nullptr;
+        m_job = nullptr;
+        m_busy.store(false);
+      }
+    }
+
+    if (done != nullptr) {
+      done();
+    }
+  }
+}
+
+} // namespace tkm::monitor
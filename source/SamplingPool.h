@@ -0,0 +1,74 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     SamplingPool Class
+ * @details   Worker threads to sample data sources off the main loop
+ *-
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tkm::monitor
+{
+
+/*
+ * Fixed size thread pool running one batch at a time. The batch items are
+ * split in chunks which the workers pick until the batch is exhausted. The
+ * completion callback is called once per batch from the last worker thread
+ * so the owner has to hand the results back to its event loop.
+ */
+class SamplingPool
+{
+public:
+  using Job = std::function<void(size_t index)>;
+  using Done = std::function<void(void)>;
+
+public:
+  explicit SamplingPool(const std::string &name, size_t threads);
+  ~SamplingPool();
+
+public:
+  SamplingPool(SamplingPool const &) = delete;
+  void operator=(SamplingPool const &) = delete;
+
+public:
+  bool run(size_t count, const Job &job, const Done &done);
+  bool isBusy(void) { return m_busy.load(); }
+  auto getName(void) -> const std::string & { return m_name; }
+  auto getThreadCount(void) -> size_t { return m_threads.size(); }
+
+private:
+  void worker(void);
+
+private:
+  static constexpr size_t ChunkSize = 32;
+
+private:
+  std::vector<std::thread> m_threads{};
+  std::condition_variable m_cond{};
+  std::mutex m_mutex{};
+  std::atomic<size_t> m_next{0};
+  std::atomic<bool> m_busy{false};
+  std::string m_name{};
+  Job m_job = nullptr;
+  Done m_done = nullptr;
+  uint64_t m_generation = 0;
+  size_t m_count = 0;
+  size_t m_running = 0;
+  bool m_stop = false;
+};
+
+} // namespace tkm::monitor
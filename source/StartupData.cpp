@@ -32,7 +32,7 @@ StartupData::StartupData(const std::shared_ptr<Options> options)
     return false;
   });
 
-  auto timeout = std::stoul(options->getFor(Options::Key::StartupDataCleanupTime));
+  auto timeout = static_cast<uint64_t>(options->getSettings().startupDataCleanupTime.count());
   logDebug() << "Startup data will expire in " << timeout << " usec";
   expireTimer->start(timeout, false);
   App()->addEventSource(expireTimer);
@@ -43,7 +43,7 @@ StateManager::StateManager(const std::shared_ptr<Options> options)
 : m_options(options)
 {
   const auto collectorTimeout =
-      std::stoul(m_options->getFor(Options::Key::CollectorInactiveTimeout));
+      static_cast<uint64_t>(m_options->getSettings().collectorInactiveTimeout.count());
 
   m_queue = std::make_shared<AsyncQueue<Request>>(
       "StateManagerEventQueue", [this](const Request &request) { return requestHandler(request); });
@@ -159,8 +159,7 @@ static bool doRemoveCollector(const std::shared_ptr<StateManager> mgr,
 static bool doUpdateWakeLock(const std::shared_ptr<StateManager> mgr)
 {
 #ifdef WITH_WAKE_LOCK
-  if (App()->getOptions()->getFor(Options::Key::TCPActiveWakeLock) ==
-      tkmDefaults.valFor(Defaults::Val::True)) {
+  if (App()->getOptions()->getSettings().tcpActiveWakeLock) {
     bool haveTcpCollector = false;
 
     mgr->getActiveCollectorList().foreach (
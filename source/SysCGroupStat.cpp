@@ -0,0 +1,185 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     SysCGroupStat Class
+ * @details   Collect and report cgroup v2 resource usage
+ *-
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Application.h"
+#include "SysCGroupStat.h"
+
+namespace tkm::monitor
+{
+
+static auto normalizePath(const std::string &path) -> std::string
+{
+  const auto first = path.find_first_not_of('/');
+  if (first == std::string::npos) {
+    return std::string{"."};
+  }
+  const auto last = path.find_last_not_of('/');
+  return path.substr(first, last - first + 1);
+}
+
+SysCGroupStat::SysCGroupStat(const std::shared_ptr<Options> options)
+: m_options(options)
+{
+  m_rootFd = ::open(CGroupRootPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (m_rootFd < 0) {
+    throw std::runtime_error("Fail to open cgroup root directory");
+  }
+
+  if (m_options->hasConfigFile()) {
+    const std::vector<bswi::kf::Property> props =
+        m_options->getConfigFile()->getProperties("cgroups", -1);
+    for (const auto &prop : props) {
+      m_subtrees.push_back(normalizePath(prop.key));
+    }
+  }
+
+  if (m_subtrees.empty()) {
+    logWarn() << "No cgroup subtree configured, monitor the root cgroup children";
+    m_subtrees.push_back(".");
+  }
+
+  m_queue = std::make_shared<AsyncQueue<Request>>(
+      "SysCGroupStatQueue", [this](const Request &request) { return requestHandler(request); });
+}
+
+SysCGroupStat::~SysCGroupStat()
+{
+  // Close the cgroup files before the root directory
+  m_cgroups.clear();
+
+  if (m_rootFd != -1) {
+    ::close(m_rootFd);
+    m_rootFd = -1;
+  }
+}
+
+auto SysCGroupStat::pushRequest(Request &request) -> int
+{
+  return m_queue->push(request);
+}
+
+void SysCGroupStat::setEventSource(bool enabled)
+{
+  if (enabled) {
+    App()->addEventSource(m_queue);
+  } else {
+    App()->remEventSource(m_queue);
+  }
+}
+
+bool SysCGroupStat::update()
+{
+  if (getUpdatePending()) {
+    return true;
+  }
+
+  SysCGroupStat::Request request = {.action = SysCGroupStat::Action::UpdateStats,
+                                    .collector = nullptr};
+  bool status = pushRequest(request);
+
+  if (status) {
+    setUpdatePending(true);
+  }
+
+  return status;
+}
+
+auto SysCGroupStat::requestHandler(const Request &request) -> bool
+{
+  bool status = false;
+
+  switch (request.action) {
+  case SysCGroupStat::Action::UpdateStats:
+    status = updateStats();
+    setUpdatePending(false);
+    break;
+  default:
+    logError() << "Unknown action request";
+    break;
+  }
+
+  return status;
+}
+
+void SysCGroupStat::addCGroup(const std::string &path, int dirFd)
+{
+  auto it = m_cgroups.find(path);
+
+  if (it == m_cgroups.end()) {
+    if (dirFd < 0) {
+      return;
+    }
+    it = m_cgroups.emplace(path, std::make_unique<CGroupStat>(path, dirFd)).first;
+  } else if (dirFd >= 0) {
+    ::close(dirFd);
+  }
+
+  it->second->setGeneration(m_generation);
+}
+
+void SysCGroupStat::scanSubtree(const std::string &path)
+{
+  int fd = ::openat(m_rootFd, path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+
+  DIR *dir = ::fdopendir(fd);
+  if (dir == nullptr) {
+    ::close(fd);
+    return;
+  }
+
+  // Only open the subtree root and new children, known cgroups keep their fds
+  const auto known = [this](const std::string &name) { return m_cgroups.count(name) > 0; };
+  addCGroup(path, known(path) ? -1 : ::dup(fd));
+
+  struct dirent *entry = nullptr;
+  while ((entry = ::readdir(dir)) != nullptr) {
+    if ((entry->d_type != DT_DIR) || (entry->d_name[0] == '.')) {
+      continue;
+    }
+
+    const std::string child = (path == ".") ? entry->d_name : (path + "/" + entry->d_name);
+    addCGroup(child,
+              known(child) ? -1
+                           : ::openat(fd, entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+  }
+
+  ::closedir(dir);
+}
+
+bool SysCGroupStat::updateStats(void)
+{
+  m_generation++;
+  for (const auto &path : m_subtrees) {
+    scanSubtree(path);
+  }
+
+  for (auto it = m_cgroups.begin(); it != m_cgroups.end();) {
+    auto &cgroup = it->second;
+
+    // Removed cgroups are not found by the scan or fail to read (ENODEV)
+    if ((cgroup->getGeneration() != m_generation) || !cgroup->update()) {
+      it = m_cgroups.erase(it);
+      continue;
+    }
+    ++it;
+  }
+
+  return true;
+}
+
+} // namespace tkm::monitor
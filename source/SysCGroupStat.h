@@ -0,0 +1,86 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     SysCGroupStat Class
+ * @details   Collect and report cgroup v2 resource usage
+ *-
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <taskmonitor/taskmonitor.h>
+
+#include "CGroupStat.h"
+#include "ICollector.h"
+#include "IDataSource.h"
+#include "Options.h"
+
+#include "../bswinfra/source/AsyncQueue.h"
+
+using namespace bswi::event;
+
+namespace tkm::monitor
+{
+
+/*
+ * Monitor the cgroups configured in the [cgroups] section and their direct
+ * children (i.e. the services of system.slice or the containers of a
+ * machine.slice). The interface files of each cgroup stay open so an update
+ * costs one pread per file and cgroup. The records are internal and read
+ * with getCGroups(): cgroup inodes and registry context ids don't share an id
+ * space, and the subtree roots overlap the registry root context, so they
+ * are not reported as ContextInfo entries.
+ */
+class SysCGroupStat : public IDataSource, public std::enable_shared_from_this<SysCGroupStat>
+{
+public:
+  enum class Action { UpdateStats };
+  typedef struct Request {
+    Action action;
+    std::shared_ptr<ICollector> collector;
+  } Request;
+
+  static constexpr const char *CGroupRootPath = "/sys/fs/cgroup";
+
+  explicit SysCGroupStat(const std::shared_ptr<Options> options);
+  virtual ~SysCGroupStat();
+
+public:
+  SysCGroupStat(SysCGroupStat const &) = delete;
+  void operator=(SysCGroupStat const &) = delete;
+
+public:
+  auto getShared() -> std::shared_ptr<SysCGroupStat> { return shared_from_this(); }
+  auto pushRequest(SysCGroupStat::Request &request) -> int;
+  auto getCGroups(void) -> const std::map<std::string, std::unique_ptr<CGroupStat>> &
+  {
+    return m_cgroups;
+  }
+  auto getSubtrees(void) -> const std::vector<std::string> & { return m_subtrees; }
+  void setEventSource(bool enabled = true);
+  bool update(void) final;
+  bool updateStats(void);
+
+private:
+  bool requestHandler(const Request &request);
+  void scanSubtree(const std::string &path);
+  void addCGroup(const std::string &path, int dirFd);
+
+private:
+  std::map<std::string, std::unique_ptr<CGroupStat>> m_cgroups{};
+  std::vector<std::string> m_subtrees{};
+  std::shared_ptr<AsyncQueue<Request>> m_queue = nullptr;
+  std::shared_ptr<Options> m_options = nullptr;
+  uint64_t m_generation = 0;
+  int m_rootFd = -1;
+};
+
+} // namespace tkm::monitor
@@ -64,6 +64,7 @@ auto SysProcBuddyInfo::requestHandler(const Request &request) -> bool
   switch (request.action) {
   case SysProcBuddyInfo::Action::UpdateStats:
     status = doUpdateStats(getShared());
+    m_dataCache.invalidate();
     setUpdatePending(false);
     break;
   case SysProcBuddyInfo::Action::CollectAndSend:
@@ -79,56 +80,46 @@ auto SysProcBuddyInfo::requestHandler(const Request &request) -> bool
 
 static bool doUpdateStats(const std::shared_ptr<SysProcBuddyInfo> mgr)
 {
-  std::ifstream statStream{"/proc/buddyinfo"};
+  auto &file = mgr->getProcFile();
 
-  if (!statStream.is_open()) {
-    throw std::runtime_error("Fail to open /proc/buddyinfo file");
+  if (!file.read()) {
+    throw std::runtime_error("Fail to read /proc/buddyinfo file");
   }
 
-  std::string line;
-  while (std::getline(statStream, line)) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(line);
-    std::string buf;
-
-    if (line.find("zone") == std::string::npos) {
+  ProcfsLine line;
+  while (file.nextLine(line)) {
+    if (!line.contains("zone")) {
       continue;
     }
 
-    size_t cnt = 0;
-    size_t zoneMarker = 0;
-    while (ss >> buf) {
-      if ((zoneMarker == 0) && (buf == "zone")) {
-        zoneMarker = cnt;
-      }
-      cnt++;
-      tokens.push_back(buf);
+    // Lines are "Node 0, zone   Normal   1   2 ..."
+    std::string nameToken{};
+    std::string_view field;
+    while (line.nextField(field) && (field != "zone")) {
+      nameToken.append(field);
+    }
+    // remove comma after name
+    if (!nameToken.empty()) {
+      nameToken.pop_back();
     }
 
-    if (cnt < zoneMarker + 3) {
+    std::string_view zoneField;
+    if ((field != "zone") || !line.nextField(zoneField) || (line.countFields() == 0)) {
       logError() << "Proc buddyinfo file parse error";
       return false;
     }
+    const std::string zoneToken{zoneField};
 
-    auto updateBuddyInfoEntry = [zoneMarker, &tokens](const std::shared_ptr<BuddyInfo> &entry) {
+    auto updateBuddyInfoEntry = [line](const std::shared_ptr<BuddyInfo> &entry) {
+      ProcfsLine orders = line;
       std::string data{};
-      for (size_t i = zoneMarker + 2; i < tokens.size(); i++) {
-        data += tokens[i] + " ";
+      std::string_view order;
+      while (orders.nextField(order)) {
+        data.append(order).append(" ");
       }
       entry->getData().set_data(data);
     };
 
-    std::string nameToken{};
-    for (size_t i = 0; i < zoneMarker; i++) {
-      nameToken += tokens[i];
-    }
-    // remove comma after name
-    if (!nameToken.empty()) {
-      nameToken.pop_back();
-    }
-
-    const auto &zoneToken = tokens[zoneMarker + 1];
-
     auto found = false;
     mgr->getBuddyInfoList().foreach ([&nameToken, &zoneToken, &found, updateBuddyInfoEntry](
                                          const std::shared_ptr<BuddyInfo> &entry) {
@@ -153,23 +144,31 @@ static bool doUpdateStats(const std::shared_ptr<SysProcBuddyInfo> mgr)
 static bool doCollectAndSend(const std::shared_ptr<SysProcBuddyInfo> mgr,
                              const SysProcBuddyInfo::Request &request)
 {
-  tkm::msg::monitor::SysProcBuddyInfo info;
-  tkm::msg::monitor::Data data;
+  auto envelope = mgr->getDataCache().get();
 
-  data.set_what(tkm::msg::monitor::Data_What_SysProcBuddyInfo);
+  if (envelope == nullptr) {
+    tkm::msg::monitor::SysProcBuddyInfo info;
+    tkm::msg::monitor::Data data;
 
-  struct timespec currentTime;
-  clock_gettime(CLOCK_REALTIME, &currentTime);
-  data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
-  clock_gettime(CLOCK_MONOTONIC, &currentTime);
-  data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+    data.set_what(tkm::msg::monitor::Data_What_SysProcBuddyInfo);
 
-  mgr->getBuddyInfoList().foreach ([&info](const std::shared_ptr<BuddyInfo> &entry) {
-    info.add_node()->CopyFrom(entry->getData());
-  });
+    struct timespec currentTime;
+    clock_gettime(CLOCK_REALTIME, &currentTime);
+    data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+    data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+
+    mgr->getBuddyInfoList().foreach ([&info](const std::shared_ptr<BuddyInfo> &entry) {
+      info.add_node()->CopyFrom(entry->getData());
+    });
+
+    data.mutable_payload()->PackFrom(info);
+
+    envelope = ICollector::makeDataEnvelope(data);
+    mgr->getDataCache().store(envelope);
+  }
 
-  data.mutable_payload()->PackFrom(info);
-  request.collector->sendData(data);
+  request.collector->writeEnvelope(*envelope);
 
   return true;
 }
@@ -13,9 +13,11 @@
 
 #include <taskmonitor/taskmonitor.h>
 
+#include "DataCache.h"
 #include "ICollector.h"
 #include "IDataSource.h"
 #include "Options.h"
+#include "ProcfsFile.h"
 
 #include "../bswinfra/source/AsyncQueue.h"
 #include "../bswinfra/source/SafeList.h"
@@ -66,7 +68,9 @@ public:
 
 public:
   auto getShared() -> std::shared_ptr<SysProcBuddyInfo> { return shared_from_this(); }
+  auto getDataCache(void) -> DataCache & { return m_dataCache; }
   auto getBuddyInfoList() -> bswi::util::SafeList<std::shared_ptr<BuddyInfo>> & { return m_nodes; }
+  auto getProcFile(void) -> ProcfsFile & { return m_procFile; }
   auto pushRequest(SysProcBuddyInfo::Request &request) -> int;
   void setEventSource(bool enabled = true);
   bool update(void) final;
@@ -78,6 +82,8 @@ private:
   bswi::util::SafeList<std::shared_ptr<BuddyInfo>> m_nodes{"BuddyInfoList"};
   std::shared_ptr<AsyncQueue<Request>> m_queue = nullptr;
   std::shared_ptr<Options> m_options = nullptr;
+  DataCache m_dataCache{"SysProcBuddyInfoCache"};
+  ProcfsFile m_procFile{"/proc/buddyinfo"};
 };
 
 } // namespace tkm::monitor
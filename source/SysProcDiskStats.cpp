@@ -12,6 +12,8 @@
 #include "SysProcDiskStats.h"
 #include "Application.h"
 
+#include <array>
+
 namespace tkm::monitor
 {
 
@@ -64,6 +66,7 @@ auto SysProcDiskStats::requestHandler(const Request &request) -> bool
   switch (request.action) {
   case SysProcDiskStats::Action::UpdateStats:
     status = doUpdateStats(getShared());
+    m_dataCache.invalidate();
     setUpdatePending(false);
     break;
   case SysProcDiskStats::Action::CollectAndSend:
@@ -79,43 +82,53 @@ auto SysProcDiskStats::requestHandler(const Request &request) -> bool
 
 static bool doUpdateStats(const std::shared_ptr<SysProcDiskStats> mgr)
 {
-  std::ifstream diskStatsStream{"/proc/diskstats"};
+  auto &file = mgr->getProcFile();
 
-  if (!diskStatsStream.is_open()) {
-    throw std::runtime_error("Fail to open /proc/diskstats file");
+  if (!file.read()) {
+    throw std::runtime_error("Fail to read /proc/diskstats file");
   }
 
-  std::string line;
-  while (std::getline(diskStatsStream, line)) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(line);
-    std::string buf;
+  ProcfsLine line;
+  while (file.nextLine(line)) {
+    // Fields after the device name, see Documentation/admin-guide/iostats.rst
+    std::array<uint64_t, 11> values{};
+    uint64_t majorValue = 0, minorValue = 0;
+    std::string_view name;
 
-    while (ss >> buf) {
-      tokens.push_back(buf);
+    if (line.countFields() < 20) {
+      logError() << "Proc diskstats file parse error";
+      return false;
     }
 
-    if (tokens.size() < 20) {
+    bool status = line.nextUnsigned(majorValue) && line.nextUnsigned(minorValue) &&
+                  line.nextField(name);
+    for (size_t i = 0; status && (i < values.size()); i++) {
+      status = line.nextUnsigned(values[i]);
+    }
+    if (!status) {
       logError() << "Proc diskstats file parse error";
       return false;
     }
 
-    auto major = static_cast<uint32_t>(std::stoul(tokens[0]));
-    auto minor = static_cast<uint32_t>(std::stoul(tokens[1]));
+    auto major = static_cast<uint32_t>(majorValue);
+    auto minor = static_cast<uint32_t>(minorValue);
 
-    auto updateDiskStatEntry = [&tokens, &major, &minor](const std::shared_ptr<DiskStat> &entry) {
+    auto updateDiskStatEntry = [&values, &name, &major, &minor](
+                                   const std::shared_ptr<DiskStat> &entry) {
       entry->getData().set_node_major(major);
       entry->getData().set_node_minor(minor);
-      entry->getData().set_name(tokens[2]);
-      entry->getData().set_reads_completed(std::stoul(tokens[3]));
-      entry->getData().set_reads_merged(std::stoul(tokens[4]));
-      entry->getData().set_reads_spent_ms(std::stoul(tokens[6]));
-      entry->getData().set_writes_completed(std::stoul(tokens[7]));
-      entry->getData().set_writes_merged(std::stoul(tokens[8]));
-      entry->getData().set_writes_spent_ms(std::stoul(tokens[10]));
-      entry->getData().set_io_in_progress(std::stoul(tokens[11]));
-      entry->getData().set_io_spent_ms(std::stoul(tokens[12]));
-      entry->getData().set_io_weighted_ms(std::stoul(tokens[13]));
+      if (entry->getData().name() != name) {
+        entry->getData().set_name(std::string(name));
+      }
+      entry->getData().set_reads_completed(values[0]);
+      entry->getData().set_reads_merged(values[1]);
+      entry->getData().set_reads_spent_ms(values[3]);
+      entry->getData().set_writes_completed(values[4]);
+      entry->getData().set_writes_merged(values[5]);
+      entry->getData().set_writes_spent_ms(values[7]);
+      entry->getData().set_io_in_progress(values[8]);
+      entry->getData().set_io_spent_ms(values[9]);
+      entry->getData().set_io_weighted_ms(values[10]);
     };
 
     auto found = false;
@@ -128,8 +141,7 @@ static bool doUpdateStats(const std::shared_ptr<SysProcDiskStats> mgr)
     });
 
     if (!found) {
-      std::shared_ptr<DiskStat> entry =
-          std::make_shared<DiskStat>(tokens[2], std::stoul(tokens[0]), std::stoul(tokens[1]));
+      std::shared_ptr<DiskStat> entry = std::make_shared<DiskStat>(std::string(name), major, minor);
 
       logDebug() << "Adding new diskstat entry '" << entry->getData().name() << "' for statistics";
       mgr->getDiskStatList().append(entry);
@@ -144,23 +156,31 @@ static bool doUpdateStats(const std::shared_ptr<SysProcDiskStats> mgr)
 static bool doCollectAndSend(const std::shared_ptr<SysProcDiskStats> mgr,
                              const SysProcDiskStats::Request &request)
 {
-  tkm::msg::monitor::SysProcDiskStats diskStats;
-  tkm::msg::monitor::Data data;
+  auto envelope = mgr->getDataCache().get();
 
-  data.set_what(tkm::msg::monitor::Data_What_SysProcDiskStats);
+  if (envelope == nullptr) {
+    tkm::msg::monitor::SysProcDiskStats diskStats;
+    tkm::msg::monitor::Data data;
 
-  struct timespec currentTime;
-  clock_gettime(CLOCK_REALTIME, &currentTime);
-  data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
-  clock_gettime(CLOCK_MONOTONIC, &currentTime);
-  data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+    data.set_what(tkm::msg::monitor::Data_What_SysProcDiskStats);
 
-  mgr->getDiskStatList().foreach ([&diskStats](const std::shared_ptr<DiskStat> &entry) {
-    diskStats.add_disk()->CopyFrom(entry->getData());
-  });
+    struct timespec currentTime;
+    clock_gettime(CLOCK_REALTIME, &currentTime);
+    data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+    data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+
+    mgr->getDiskStatList().foreach ([&diskStats](const std::shared_ptr<DiskStat> &entry) {
+      diskStats.add_disk()->CopyFrom(entry->getData());
+    });
+
+    data.mutable_payload()->PackFrom(diskStats);
+
+    envelope = ICollector::makeDataEnvelope(data);
+    mgr->getDataCache().store(envelope);
+  }
 
-  data.mutable_payload()->PackFrom(diskStats);
-  request.collector->sendData(data);
+  request.collector->writeEnvelope(*envelope);
 
   return true;
 }
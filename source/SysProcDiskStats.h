@@ -13,9 +13,11 @@
 
 #include <taskmonitor/taskmonitor.h>
 
+#include "DataCache.h"
 #include "ICollector.h"
 #include "IDataSource.h"
 #include "Options.h"
+#include "ProcfsFile.h"
 
 #include "../bswinfra/source/AsyncQueue.h"
 #include "../bswinfra/source/SafeList.h"
@@ -62,7 +64,9 @@ public:
 
 public:
   auto getShared() -> std::shared_ptr<SysProcDiskStats> { return shared_from_this(); }
+  auto getDataCache(void) -> DataCache & { return m_dataCache; }
   auto getDiskStatList() -> bswi::util::SafeList<std::shared_ptr<DiskStat>> & { return m_disks; }
+  auto getProcFile(void) -> ProcfsFile & { return m_procFile; }
   auto pushRequest(SysProcDiskStats::Request &request) -> int;
   void setEventSource(bool enabled = true);
   bool update(void) final;
@@ -74,6 +78,8 @@ private:
   bswi::util::SafeList<std::shared_ptr<DiskStat>> m_disks{"DiskStatList"};
   std::shared_ptr<AsyncQueue<Request>> m_queue = nullptr;
   std::shared_ptr<Options> m_options = nullptr;
+  DataCache m_dataCache{"SysProcDiskStatsCache"};
+  ProcfsFile m_procFile{"/proc/diskstats"};
   tkm::msg::monitor::SysProcDiskStats m_diskStats;
 };
 
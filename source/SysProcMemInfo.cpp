@@ -19,9 +19,43 @@ static bool doUpdateStats(const std::shared_ptr<SysProcMemInfo> mgr);
 static bool doCollectAndSend(const std::shared_ptr<SysProcMemInfo> mgr,
                              const SysProcMemInfo::Request &request);
 
+// Fields collected without a [meminfo] section, the ones with a message field
+static constexpr const char *DefaultFields[] = {"MemTotal",
+                                                "MemFree",
+                                                "MemAvailable",
+                                                "Cached",
+                                                "Active",
+                                                "Inactive",
+                                                "Slab",
+                                                "KReclaimable",
+                                                "SReclaimable",
+                                                "SUnreclaim",
+                                                "KernelStack",
+                                                "SwapTotal",
+                                                "SwapFree",
+                                                "SwapCached",
+                                                "CmaTotal",
+                                                "CmaFree"};
+
 SysProcMemInfo::SysProcMemInfo(const std::shared_ptr<Options> options)
 : m_options(options)
 {
+  if (m_options->hasConfigFile()) {
+    const std::vector<bswi::kf::Property> props =
+        m_options->getConfigFile()->getProperties("meminfo", -1);
+    for (const auto &prop : props) {
+      if (!m_fields.select(prop.key)) {
+        logWarn() << "Unknown meminfo field " << prop.key;
+      }
+    }
+  }
+
+  if (m_fields.getSelectedCount() == 0) {
+    for (const auto key : DefaultFields) {
+      m_fields.select(key);
+    }
+  }
+
   m_queue = std::make_shared<AsyncQueue<Request>>(
       "SysProcMemInfoQueue", [this](const Request &request) { return requestHandler(request); });
 }
@@ -64,6 +98,7 @@ auto SysProcMemInfo::requestHandler(const Request &request) -> bool
   switch (request.action) {
   case SysProcMemInfo::Action::UpdateStats:
     status = doUpdateStats(getShared());
+    m_dataCache.invalidate();
     setUpdatePending(false);
     break;
   case SysProcMemInfo::Action::CollectAndSend:
@@ -77,140 +112,95 @@ auto SysProcMemInfo::requestHandler(const Request &request) -> bool
   return status;
 }
 
+static void setMessageField(tkm::msg::monitor::SysProcMemInfo &memInfo,
+                            int index,
+                            uint64_t value)
+{
+  switch (index) {
+  case MemInfoKeyTable.find("MemTotal"):
+    memInfo.set_mem_total(value);
+    break;
+  case MemInfoKeyTable.find("MemFree"):
+    memInfo.set_mem_free(value);
+    break;
+  case MemInfoKeyTable.find("MemAvailable"):
+    memInfo.set_mem_available(value);
+    break;
+  case MemInfoKeyTable.find("Cached"):
+    memInfo.set_mem_cached(value);
+    break;
+  case MemInfoKeyTable.find("Active"):
+    memInfo.set_active(value);
+    break;
+  case MemInfoKeyTable.find("Inactive"):
+    memInfo.set_inactive(value);
+    break;
+  case MemInfoKeyTable.find("Slab"):
+    memInfo.set_slab(value);
+    break;
+  case MemInfoKeyTable.find("KReclaimable"):
+    memInfo.set_kreclaimable(value);
+    break;
+  case MemInfoKeyTable.find("SReclaimable"):
+    memInfo.set_sreclaimable(value);
+    break;
+  case MemInfoKeyTable.find("SUnreclaim"):
+    memInfo.set_sunreclaim(value);
+    break;
+  case MemInfoKeyTable.find("KernelStack"):
+    memInfo.set_kernel_stack(value);
+    break;
+  case MemInfoKeyTable.find("SwapTotal"):
+    memInfo.set_swap_total(value);
+    break;
+  case MemInfoKeyTable.find("SwapFree"):
+    memInfo.set_swap_free(value);
+    break;
+  case MemInfoKeyTable.find("SwapCached"):
+    memInfo.set_swap_cached(value);
+    break;
+  case MemInfoKeyTable.find("CmaTotal"):
+    memInfo.set_cma_total(value);
+    break;
+  case MemInfoKeyTable.find("CmaFree"):
+    memInfo.set_cma_free(value);
+    break;
+  default:
+    break;
+  }
+}
+
 static bool doUpdateStats(const std::shared_ptr<SysProcMemInfo> mgr)
 {
-  std::ifstream memInfoStream{"/proc/meminfo"};
-
-  typedef enum _LineData {
-    Unknown,
-    MemTotal,
-    MemFree,
-    MemAvailable,
-    MemCached,
-    Active,
-    Inactive,
-    Slab,
-    KReclaimable,
-    SReclaimable,
-    SUnreclaim,
-    KernelStack,
-    SwapTotal,
-    SwapFree,
-    SwapCached,
-    CmaTotal,
-    CmaFree
-  } LineData;
-
-  if (!memInfoStream.is_open()) {
-    throw std::runtime_error("Fail to open /proc/meminfo file");
+  auto &file = mgr->getProcFile();
+  auto &fields = mgr->getFields();
+
+  if (!file.read()) {
+    throw std::runtime_error("Fail to read /proc/meminfo file");
   }
 
-  std::string line;
-  while (std::getline(memInfoStream, line)) {
-    LineData lineData = LineData::Unknown;
-    std::vector<std::string> tokens;
-    std::stringstream ss(line);
-    std::string buf;
-
-    if (line.rfind("MemTotal:", 0) != std::string::npos) {
-      lineData = LineData::MemTotal;
-    } else if (line.rfind("MemFree:", 0) != std::string::npos) {
-      lineData = LineData::MemFree;
-    } else if (line.rfind("MemAvailable:", 0) != std::string::npos) {
-      lineData = LineData::MemAvailable;
-    } else if (line.rfind("Cached:", 0) != std::string::npos) {
-      lineData = LineData::MemCached;
-    } else if (line.rfind("Active:", 0) != std::string::npos) {
-      lineData = LineData::Active;
-    } else if (line.rfind("Inactive:", 0) != std::string::npos) {
-      lineData = LineData::Inactive;
-    } else if (line.rfind("Slab:", 0) != std::string::npos) {
-      lineData = LineData::Slab;
-    } else if (line.rfind("KReclaimable:", 0) != std::string::npos) {
-      lineData = LineData::KReclaimable;
-    } else if (line.rfind("SReclaimable:", 0) != std::string::npos) {
-      lineData = LineData::SReclaimable;
-    } else if (line.rfind("SUnreclaim:", 0) != std::string::npos) {
-      lineData = LineData::SUnreclaim;
-    } else if (line.rfind("KernelStack:", 0) != std::string::npos) {
-      lineData = LineData::KernelStack;
-    } else if (line.rfind("SwapTotal:", 0) != std::string::npos) {
-      lineData = LineData::SwapTotal;
-    } else if (line.rfind("SwapFree:", 0) != std::string::npos) {
-      lineData = LineData::SwapFree;
-    } else if (line.rfind("SwapCached:", 0) != std::string::npos) {
-      lineData = LineData::SwapCached;
-    } else if (line.rfind("CmaTotal:", 0) != std::string::npos) {
-      lineData = LineData::CmaTotal;
-    } else if (line.rfind("CmaFree:", 0) != std::string::npos) {
-      lineData = LineData::CmaFree;
-    }
+  ProcfsLine line;
+  while (file.nextLine(line)) {
+    std::string_view key;
+    uint64_t value = 0;
 
-    if (lineData == LineData::Unknown) {
+    if (!line.nextField(key) || (key.back() != ':')) {
       continue;
     }
+    key.remove_suffix(1);
 
-    while (ss >> buf) {
-      tokens.push_back(buf);
+    const auto index = fields.lookup(key);
+    if (index == MemInfoKeyTable.NoKey) {
+      continue;
     }
 
-    if (tokens.size() < 2) {
+    if (!line.nextUnsigned(value)) {
       logError() << "Proc meminfo file parse error";
       return false;
     }
 
-    switch (lineData) {
-    case LineData::MemTotal:
-      mgr->getProcMemInfo().set_mem_total(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::MemFree:
-      mgr->getProcMemInfo().set_mem_free(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::MemAvailable:
-      mgr->getProcMemInfo().set_mem_available(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::MemCached:
-      mgr->getProcMemInfo().set_mem_cached(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::Active:
-      mgr->getProcMemInfo().set_active(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::Inactive:
-      mgr->getProcMemInfo().set_inactive(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::Slab:
-      mgr->getProcMemInfo().set_slab(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::KReclaimable:
-      mgr->getProcMemInfo().set_kreclaimable(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::SReclaimable:
-      mgr->getProcMemInfo().set_sreclaimable(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::SUnreclaim:
-      mgr->getProcMemInfo().set_sunreclaim(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::KernelStack:
-      mgr->getProcMemInfo().set_kernel_stack(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::SwapTotal:
-      mgr->getProcMemInfo().set_swap_total(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::SwapFree:
-      mgr->getProcMemInfo().set_swap_free(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::SwapCached:
-      mgr->getProcMemInfo().set_swap_cached(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::CmaTotal:
-      mgr->getProcMemInfo().set_cma_total(std::stoul(tokens[1].c_str()));
-      break;
-    case LineData::CmaFree:
-      mgr->getProcMemInfo().set_cma_free(std::stoul(tokens[1].c_str()));
-      break;
-    default:
-      break;
-    }
+    fields.setValue(index, value);
+    setMessageField(mgr->getProcMemInfo(), index, value);
   }
 
   if (mgr->getProcMemInfo().mem_total() > 0) {
@@ -238,18 +228,26 @@ static bool doUpdateStats(const std::shared_ptr<SysProcMemInfo> mgr)
 static bool doCollectAndSend(const std::shared_ptr<SysProcMemInfo> mgr,
                              const SysProcMemInfo::Request &request)
 {
-  tkm::msg::monitor::Data data;
+  auto envelope = mgr->getDataCache().get();
 
-  data.set_what(tkm::msg::monitor::Data_What_SysProcMemInfo);
+  if (envelope == nullptr) {
+    tkm::msg::monitor::Data data;
 
-  struct timespec currentTime;
-  clock_gettime(CLOCK_REALTIME, &currentTime);
-  data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
-  clock_gettime(CLOCK_MONOTONIC, &currentTime);
-  data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+    data.set_what(tkm::msg::monitor::Data_What_SysProcMemInfo);
+
+    struct timespec currentTime;
+    clock_gettime(CLOCK_REALTIME, &currentTime);
+    data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+    data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+
+    data.mutable_payload()->PackFrom(mgr->getProcMemInfo());
+
+    envelope = ICollector::makeDataEnvelope(data);
+    mgr->getDataCache().store(envelope);
+  }
 
-  data.mutable_payload()->PackFrom(mgr->getProcMemInfo());
-  request.collector->sendData(data);
+  request.collector->writeEnvelope(*envelope);
 
   return true;
 }
@@ -13,9 +13,12 @@
 
 #include <taskmonitor/taskmonitor.h>
 
+#include "DataCache.h"
 #include "ICollector.h"
 #include "IDataSource.h"
 #include "Options.h"
+#include "ProcKeyTable.h"
+#include "ProcfsFile.h"
 
 #include "../bswinfra/source/AsyncQueue.h"
 
@@ -23,6 +26,9 @@ using namespace bswi::event;
 
 namespace tkm::monitor
 {
+
+using MemInfoFields = ProcKeyFields<decltype(MemInfoKeyTable)>;
+
 class SysProcMemInfo : public IDataSource, public std::enable_shared_from_this<SysProcMemInfo>
 {
 public:
@@ -42,6 +48,11 @@ public:
 
 public:
   auto getShared() -> std::shared_ptr<SysProcMemInfo> { return shared_from_this(); }
+  auto getDataCache(void) -> DataCache & { return m_dataCache; }
+  auto getProcFile(void) -> ProcfsFile & { return m_procFile; }
+  // Fields selected by the [meminfo] section. The ones without a message field
+  // are only available here, they are not sent or logged
+  auto getFields(void) -> MemInfoFields & { return m_fields; }
   auto getProcMemInfo() -> tkm::msg::monitor::SysProcMemInfo & { return m_memInfo; }
   auto pushRequest(SysProcMemInfo::Request &request) -> int;
   void setEventSource(bool enabled = true);
@@ -53,6 +64,9 @@ private:
 private:
   std::shared_ptr<AsyncQueue<Request>> m_queue = nullptr;
   std::shared_ptr<Options> m_options = nullptr;
+  DataCache m_dataCache{"SysProcMemInfoCache"};
+  ProcfsFile m_procFile{"/proc/meminfo"};
+  MemInfoFields m_fields{MemInfoKeyTable};
   tkm::msg::monitor::SysProcMemInfo m_memInfo;
 };
 
@@ -17,6 +17,11 @@ namespace fs = std::filesystem;
 namespace fs = std::experimental::filesystem;
 #endif
 
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "Application.h"
 #include "SysProcPressure.h"
 
@@ -26,70 +31,44 @@ namespace tkm::monitor
 static bool doUpdateStats(const std::shared_ptr<SysProcPressure> mgr);
 static bool doCollectAndSend(const std::shared_ptr<SysProcPressure> mgr,
                              const SysProcPressure::Request &request);
-
-static auto tokenize(const std::string &str, const char &ch) -> std::vector<std::string>
-{
-  std::string next;
-  std::vector<std::string> result;
-
-  for (std::string::const_iterator it = str.begin(); it != str.end(); it++) {
-    if (*it == ch) {
-      if (!next.empty()) {
-        result.push_back(next);
-        next.clear();
-      }
-    } else {
-      next += *it;
-    }
-  }
-
-  if (!next.empty())
-    result.push_back(next);
-
-  return result;
-}
+static bool doNotifyTrigger(const std::shared_ptr<SysProcPressure> mgr);
 
 void PressureStat::updateStats(void)
 {
-  std::ifstream file("/proc/pressure/" + m_name);
-
-  if (file.is_open()) {
-    std::string line;
-    while (std::getline(file, line)) {
-      std::vector<std::string> tokens;
-      std::stringstream ss(line);
-      std::string buf;
+  if (!m_file.read()) {
+    logError() << "Cannot read pressure file: " << m_file.getPath();
+    return;
+  }
 
-      while (ss >> buf) {
-        tokens.push_back(buf);
-      }
+  ProcfsLine line;
+  while (m_file.nextLine(line)) {
+    // Lines are "some|full avg10=0.00 avg60=0.00 avg300=0.00 total=0"
+    std::string_view type, key, value;
+    if (!line.nextField(type)) {
+      continue;
+    }
 
-      tkm::msg::monitor::PSIData data;
-      for (size_t i = 1; i < tokens.size(); i++) {
-        std::vector<std::string> keyVal = tokenize(tokens[i], '=');
-
-        if (keyVal.size() == 2) {
-          if (keyVal[0] == "avg10") {
-            data.set_avg10(std::stof(keyVal[1]));
-          } else if (keyVal[0] == "avg60") {
-            data.set_avg60(std::stof(keyVal[1]));
-          } else if (keyVal[0] == "avg300") {
-            data.set_avg300(std::stof(keyVal[1]));
-          } else if (keyVal[0] == "total") {
-            data.set_total(std::stoull(keyVal[1]));
-          }
-        }
+    tkm::msg::monitor::PSIData data;
+    while (line.nextKeyValue(key, value)) {
+      float avg = 0;
+      uint64_t total = 0;
+
+      if ((key == "avg10") && ProcfsLine::toDecimal(value, avg)) {
+        data.set_avg10(avg);
+      } else if ((key == "avg60") && ProcfsLine::toDecimal(value, avg)) {
+        data.set_avg60(avg);
+      } else if ((key == "avg300") && ProcfsLine::toDecimal(value, avg)) {
+        data.set_avg300(avg);
+      } else if ((key == "total") && ProcfsLine::toUnsigned(value, total)) {
+        data.set_total(total);
       }
+    }
 
-      if (tokens[0] == "some") {
-        m_dataSome = data;
-      } else {
-        m_dataFull = data;
-      }
+    if (type == "some") {
+      m_dataSome = data;
+    } else {
+      m_dataFull = data;
     }
-  } else {
-    logError() << "Cannot open pressure file: "
-               << "/proc/pressure/" + m_name;
   }
 }
 
@@ -110,10 +89,47 @@ SysProcPressure::SysProcPressure(const std::shared_ptr<Options> options)
   }
   m_entries.commit();
 
+  // Per context pressure needs the unified hierarchy
+  if (fs::exists(std::string(CGroupRootPath) + "/cgroup.controllers")) {
+    m_cgroupRootFd = ::open(CGroupRootPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  }
+
+  if (m_options->hasConfigFile()) {
+    const std::vector<bswi::kf::Property> props =
+        m_options->getConfigFile()->getProperties("pressure", -1);
+    for (const auto &prop : props) {
+      PressureTriggerSpec spec;
+
+      if (!parsePressureTrigger(prop.key, spec)) {
+        logWarn() << "Invalid pressure trigger " << prop.key;
+        continue;
+      }
+
+      if (m_trigger == nullptr) {
+        m_trigger = std::make_unique<PressureTrigger>();
+      }
+      if (!m_trigger->addTrigger("/proc/pressure/" + spec.resource, spec)) {
+        logWarn() << "Fail to register pressure trigger " << prop.key
+                  << ". Error: " << ::strerror(errno);
+      }
+    }
+  }
+
   m_queue = std::make_shared<AsyncQueue<Request>>(
       "SysProcPressureQueue", [this](const Request &request) { return requestHandler(request); });
 }
 
+SysProcPressure::~SysProcPressure()
+{
+  // Close the cgroup files before the root directory
+  m_cgroups.clear();
+
+  if (m_cgroupRootFd >= 0) {
+    ::close(m_cgroupRootFd);
+    m_cgroupRootFd = -1;
+  }
+}
+
 auto SysProcPressure::pushRequest(Request &request) -> int
 {
   return m_queue->push(request);
@@ -123,11 +139,126 @@ void SysProcPressure::setEventSource(bool enabled)
 {
   if (enabled) {
     App()->addEventSource(m_queue);
+    if ((m_trigger != nullptr) && !m_trigger->getTriggers().empty()) {
+      // Called from the watcher thread, the queue hands the event to our lane
+      m_trigger->start([this](size_t) {
+        SysProcPressure::Request request = {.action = SysProcPressure::Action::NotifyTrigger,
+                                            .collector = nullptr};
+        pushRequest(request);
+      });
+    }
   } else {
+    if (m_trigger != nullptr) {
+      m_trigger->stop();
+    }
     App()->remEventSource(m_queue);
   }
 }
 
+void SysProcPressure::addSubscriber(const std::shared_ptr<ICollector> &collector)
+{
+  for (const auto &subscriber : m_subscribers) {
+    if (subscriber.lock() == collector) {
+      return;
+    }
+  }
+  m_subscribers.push_back(collector);
+}
+
+static void copyPSIData(const tkm::msg::monitor::PSIData &from, CGroupPSIData &to)
+{
+  to.avg10 = from.avg10();
+  to.avg60 = from.avg60();
+  to.avg300 = from.avg300();
+  to.total = from.total();
+}
+
+// Stalls of one context are logged at most once per interval
+static constexpr std::chrono::seconds ContextStallLogInterval{60};
+
+static void logContextStall(const std::shared_ptr<ContextEntry> &context,
+                            const CGroupPressureData &data)
+{
+  const auto &prev = context->getPressure();
+
+  // Only contexts with new full stalls since the last update
+  if ((data.cpuFull.total <= prev.cpuFull.total) && (data.memFull.total <= prev.memFull.total) &&
+      (data.ioFull.total <= prev.ioFull.total)) {
+    return;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  const auto last = context->getStallLogTime();
+  if ((last.time_since_epoch().count() != 0) && (now - last < ContextStallLogInterval)) {
+    return;
+  }
+  context->setStallLogTime(now);
+
+  logInfo() << "Context " << context->getData().ctx_name() << " (" << context->getCGroup()
+            << ") pressure full avg10 cpu=" << data.cpuFull.avg10
+            << " mem=" << data.memFull.avg10 << " io=" << data.ioFull.avg10
+            << " some avg10 cpu=" << data.cpuSome.avg10 << " mem=" << data.memSome.avg10
+            << " io=" << data.ioSome.avg10;
+}
+
+void SysProcPressure::updateContexts(void)
+{
+  if ((m_cgroupRootFd < 0) || (App()->getProcRegistry() == nullptr)) {
+    return;
+  }
+
+  // The root context gets the system wide pressure read by the entries
+  CGroupPressureData systemData{};
+  copyPSIData(m_psiData.cpu_some(), systemData.cpuSome);
+  copyPSIData(m_psiData.cpu_full(), systemData.cpuFull);
+  copyPSIData(m_psiData.mem_some(), systemData.memSome);
+  copyPSIData(m_psiData.mem_full(), systemData.memFull);
+  copyPSIData(m_psiData.io_some(), systemData.ioSome);
+  copyPSIData(m_psiData.io_full(), systemData.ioFull);
+
+  m_generation++;
+  App()->getProcRegistry()->getContextList().foreach (
+      [this, &systemData](const std::shared_ptr<ContextEntry> &context) {
+        const auto &path = context->getCGroup();
+        if (path.empty()) {
+          return;
+        }
+        if (path == "/") {
+          context->setPressure(systemData);
+          return;
+        }
+
+        // Contexts sharing a cgroup read its files once per update
+        auto it = m_cgroups.find(path);
+        if (it == m_cgroups.end()) {
+          // A cgroup without PSI files stays cached as not open
+          auto cgroup = std::make_unique<CGroupPressure>(m_cgroupRootFd, path.substr(1));
+          it = m_cgroups.emplace(path, std::move(cgroup)).first;
+        }
+
+        auto &cgroup = it->second;
+        if (cgroup->getGeneration() != m_generation) {
+          cgroup->setGeneration(m_generation);
+          if (cgroup->isOpen()) {
+            cgroup->update();
+          }
+        }
+        if (cgroup->isOpen()) {
+          logContextStall(context, cgroup->getData());
+          context->setPressure(cgroup->getData());
+        }
+      });
+
+  // Close the files of cgroups without context
+  for (auto it = m_cgroups.begin(); it != m_cgroups.end();) {
+    if (it->second->getGeneration() != m_generation) {
+      it = m_cgroups.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 bool SysProcPressure::update()
 {
   if (getUpdatePending()) {
@@ -152,11 +283,15 @@ auto SysProcPressure::requestHandler(const Request &request) -> bool
   switch (request.action) {
   case SysProcPressure::Action::UpdateStats:
     status = doUpdateStats(getShared());
+    m_dataCache.invalidate();
     setUpdatePending(false);
     break;
   case SysProcPressure::Action::CollectAndSend:
     status = doCollectAndSend(getShared(), request);
     break;
+  case SysProcPressure::Action::NotifyTrigger:
+    status = doNotifyTrigger(getShared());
+    break;
   default:
     logError() << "Unknown action request";
     break;
@@ -180,6 +315,7 @@ static bool doUpdateStats(const std::shared_ptr<SysProcPressure> mgr)
       mgr->getProcPressure().mutable_io_full()->CopyFrom(entry->getDataFull());
     }
   });
+  mgr->updateContexts();
 
 #ifdef WITH_STARTUP_DATA
   if (App()->getStartupData() != nullptr) {
@@ -192,21 +328,55 @@ static bool doUpdateStats(const std::shared_ptr<SysProcPressure> mgr)
   return true;
 }
 
+static auto getEnvelope(const std::shared_ptr<SysProcPressure> mgr)
+    -> std::shared_ptr<const tkm::msg::Envelope>
+{
+  auto envelope = mgr->getDataCache().get();
+
+  if (envelope == nullptr) {
+    tkm::msg::monitor::Data data;
+
+    data.set_what(tkm::msg::monitor::Data_What_SysProcPressure);
+
+    struct timespec currentTime;
+    clock_gettime(CLOCK_REALTIME, &currentTime);
+    data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+    data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+
+    data.mutable_payload()->PackFrom(mgr->getProcPressure());
+
+    envelope = ICollector::makeDataEnvelope(data);
+    mgr->getDataCache().store(envelope);
+  }
+
+  return envelope;
+}
+
 static bool doCollectAndSend(const std::shared_ptr<SysProcPressure> mgr,
                              const SysProcPressure::Request &request)
 {
-  tkm::msg::monitor::Data data;
+  // Collectors asking for pressure data get the trigger events too
+  mgr->addSubscriber(request.collector);
+  request.collector->writeEnvelope(*getEnvelope(mgr));
 
-  data.set_what(tkm::msg::monitor::Data_What_SysProcPressure);
+  return true;
+}
 
-  struct timespec currentTime;
-  clock_gettime(CLOCK_REALTIME, &currentTime);
-  data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
-  clock_gettime(CLOCK_MONOTONIC, &currentTime);
-  data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+static bool doNotifyTrigger(const std::shared_ptr<SysProcPressure> mgr)
+{
+  auto &subscribers = mgr->getSubscribers();
+
+  // Fresh data for the stall, the pending pace lane update is not awaited
+  doUpdateStats(mgr);
+  mgr->getDataCache().invalidate();
+
+  if (subscribers.empty()) {
+    return true;
+  }
 
-  data.mutable_payload()->PackFrom(mgr->getProcPressure());
-  request.collector->sendData(data);
+  // Packed once from the data cache and shared by all subscribers
+  ICollector::broadcastEnvelope(*getEnvelope(mgr), subscribers);
 
   return true;
 }
@@ -11,11 +11,18 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
 #include <taskmonitor/taskmonitor.h>
+#include <vector>
 
+#include "CGroupStat.h"
+#include "DataCache.h"
 #include "ICollector.h"
 #include "IDataSource.h"
 #include "Options.h"
+#include "PressureTrigger.h"
+#include "ProcfsFile.h"
 
 #include "../bswinfra/source/AsyncQueue.h"
 #include "../bswinfra/source/SafeList.h"
@@ -28,7 +35,8 @@ namespace tkm::monitor
 struct PressureStat : public std::enable_shared_from_this<PressureStat> {
 public:
   explicit PressureStat(const std::string &name)
-  : m_name(name){};
+  : m_file("/proc/pressure/" + name)
+  , m_name(name){};
   ~PressureStat() = default;
 
 public:
@@ -43,20 +51,32 @@ public:
 private:
   tkm::msg::monitor::PSIData m_dataSome;
   tkm::msg::monitor::PSIData m_dataFull;
+  ProcfsFile m_file;
   std::string m_name;
 };
 
+/*
+ * PSI triggers from the [pressure] section update the data as soon as a stall
+ * threshold is crossed and push it to the collectors which requested the
+ * pressure data before, without waiting for the next pace lane update.
+ * On cgroup v2 the pressure of each registry context is read from the
+ * context cgroup with the PSI files kept open per cgroup. ContextInfo has no
+ * PSI fields, the data is kept in ContextEntry::getPressure() and contexts
+ * with new full stalls are logged at most once per minute.
+ */
 class SysProcPressure : public IDataSource, public std::enable_shared_from_this<SysProcPressure>
 {
 public:
-  enum class Action { UpdateStats, CollectAndSend };
+  enum class Action { UpdateStats, CollectAndSend, NotifyTrigger };
   typedef struct Request {
     Action action;
     std::shared_ptr<ICollector> collector;
   } Request;
 
+  static constexpr const char *CGroupRootPath = "/sys/fs/cgroup";
+
   explicit SysProcPressure(const std::shared_ptr<Options> options);
-  virtual ~SysProcPressure() = default;
+  virtual ~SysProcPressure();
 
 public:
   SysProcPressure(SysProcPressure const &) = delete;
@@ -64,12 +84,25 @@ public:
 
 public:
   auto getShared() -> std::shared_ptr<SysProcPressure> { return shared_from_this(); }
+  auto getDataCache(void) -> DataCache & { return m_dataCache; }
   auto pushRequest(SysProcPressure::Request &request) -> int;
   auto getProcPressure() -> tkm::msg::monitor::SysProcPressure & { return m_psiData; }
   auto getProcEntries() -> bswi::util::SafeList<std::shared_ptr<PressureStat>> &
   {
     return m_entries;
   }
+  // Collectors notified on trigger events, expired ones are dropped on notify
+  auto getSubscribers(void) -> std::vector<std::weak_ptr<ICollector>> & { return m_subscribers; }
+  void addSubscriber(const std::shared_ptr<ICollector> &collector);
+  auto getTrigger(void) -> PressureTrigger * { return m_trigger.get(); }
+  // Per context pressure needs the cgroup v2 unified hierarchy
+  bool hasContextPressure(void) { return m_cgroupRootFd >= 0; }
+  auto getCGroupPressure(void) -> const std::map<std::string, std::unique_ptr<CGroupPressure>> &
+  {
+    return m_cgroups;
+  }
+  // Update the pressure of the registry contexts
+  void updateContexts(void);
   void setEventSource(bool enabled = true);
   bool update(void) final;
 
@@ -78,9 +111,16 @@ private:
 
 private:
   bswi::util::SafeList<std::shared_ptr<PressureStat>> m_entries{"StatPressureList"};
+  std::vector<std::weak_ptr<ICollector>> m_subscribers{};
+  std::map<std::string, std::unique_ptr<CGroupPressure>> m_cgroups{};
   std::shared_ptr<AsyncQueue<Request>> m_queue = nullptr;
+  // Declared after the queue, the watcher thread is stopped before the queue is released
+  std::unique_ptr<PressureTrigger> m_trigger = nullptr;
   std::shared_ptr<Options> m_options = nullptr;
+  DataCache m_dataCache{"SysProcPressureCache"};
   tkm::msg::monitor::SysProcPressure m_psiData;
+  uint64_t m_generation = 0;
+  int m_cgroupRootFd = -1;
 };
 
 } // namespace tkm::monitor
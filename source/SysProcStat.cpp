@@ -13,6 +13,7 @@
 #include "Application.h"
 #include <cstring>
 #include <string>
+#include <unistd.h>
 
 namespace tkm::monitor
 {
@@ -27,6 +28,10 @@ void CPUStat::updateStats(const CPUStatData &data)
     m_last.copyFrom(data);
   } else {
     auto diffData = data.getDiff(m_last);
+    // Two reads within the same tick
+    if (diffData.getTotalTime() == 0) {
+      return;
+    }
     auto usr = static_cast<uint32_t>(diffData.getPercent(CPUStatData::DataField::UserTime));
     auto sys = static_cast<uint32_t>(diffData.getPercent(CPUStatData::DataField::SystemTime));
     auto iow = static_cast<uint32_t>(diffData.getPercent(CPUStatData::DataField::IOWaitTime));
@@ -38,6 +43,14 @@ void CPUStat::updateStats(const CPUStatData &data)
       m_data.set_sys(sys);
       m_data.set_iow(iow);
       m_data.set_all(usr + sys + iow);
+      m_extra.irq = static_cast<uint32_t>(diffData.getPercent(CPUStatData::DataField::IRQTime));
+      m_extra.softIRQ =
+          static_cast<uint32_t>(diffData.getPercent(CPUStatData::DataField::SoftIRQTime));
+      m_extra.steal =
+          static_cast<uint32_t>(diffData.getPercent(CPUStatData::DataField::StealTime));
+      m_extra.guest =
+          static_cast<uint32_t>(diffData.getPercent(CPUStatData::DataField::GuestTime) +
+                                diffData.getPercent(CPUStatData::DataField::GuestNiceTime));
     } else {
       m_last.clear();
     }
@@ -47,6 +60,10 @@ void CPUStat::updateStats(const CPUStatData &data)
 SysProcStat::SysProcStat(const std::shared_ptr<Options> options)
 : m_options(options)
 {
+  // Cores are indexed by number, avoid growing the vector during updates
+  const auto cores = ::sysconf(_SC_NPROCESSORS_CONF);
+  m_cores.resize((cores > 0) ? static_cast<size_t>(cores) : 1, nullptr);
+
   m_queue = std::make_shared<AsyncQueue<Request>>(
       "SysProcStat", [this](const Request &request) { return requestHandler(request); });
 }
@@ -83,15 +100,52 @@ bool SysProcStat::update(void)
 
 auto SysProcStat::getCPUStat(const std::string &name) -> const std::shared_ptr<CPUStat>
 {
-  std::shared_ptr<CPUStat> cpuStat = nullptr;
+  uint64_t index = 0;
 
-  m_cpus.foreach ([&name, &cpuStat](const std::shared_ptr<CPUStat> &entry) {
-    if (entry->getName() == name) {
-      cpuStat = entry;
-    }
-  });
+  if (name == "cpu") {
+    return m_cpu;
+  }
+  if ((name.compare(0, 3, "cpu") != 0) || !ProcfsLine::toUnsigned(name.substr(3), index)) {
+    return nullptr;
+  }
+
+  return getCore(index);
+}
+
+auto SysProcStat::getCore(size_t index) -> const std::shared_ptr<CPUStat>
+{
+  return (index < m_cores.size()) ? m_cores[index] : nullptr;
+}
+
+void SysProcStat::setCore(size_t index, const std::shared_ptr<CPUStat> &core)
+{
+  if (index >= m_cores.size()) {
+    m_cores.resize(index + 1, nullptr);
+  }
+  m_cores[index] = core;
+}
+
+void SysProcStat::updateSystemStats(const SysStatData &data)
+{
+  const auto now = std::chrono::steady_clock::now();
+  const auto elapsed =
+      std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastSysUpdate).count();
+
+  // Counters reset on resume from hibernation, skip the rates for one update
+  const auto rate = [elapsed](uint64_t current, uint64_t last) -> uint64_t {
+    return (current >= last) ? ((current - last) * 1000) / static_cast<uint64_t>(elapsed) : 0;
+  };
+
+  if ((m_sysData.ctxt > 0) && (elapsed > 0)) {
+    m_sysRates.ctxtPerSec = rate(data.ctxt, m_sysData.ctxt);
+    m_sysRates.intrPerSec = rate(data.intr, m_sysData.intr);
+    m_sysRates.forksPerSec = rate(data.processes, m_sysData.processes);
+  }
+  m_sysRates.procsRunning = data.procsRunning;
+  m_sysRates.procsBlocked = data.procsBlocked;
 
-  return cpuStat;
+  m_sysData = data;
+  m_lastSysUpdate = now;
 }
 
 auto SysProcStat::requestHandler(const Request &request) -> bool
@@ -101,6 +155,7 @@ auto SysProcStat::requestHandler(const Request &request) -> bool
   switch (request.action) {
   case SysProcStat::Action::UpdateStats:
     status = doUpdateStats(getShared());
+    m_dataCache.invalidate();
     setUpdatePending(false);
     break;
   case SysProcStat::Action::CollectAndSend:
@@ -116,70 +171,75 @@ auto SysProcStat::requestHandler(const Request &request) -> bool
 
 static bool doUpdateStats(const std::shared_ptr<SysProcStat> mgr)
 {
-  std::ifstream statStream{"/proc/stat"};
+  auto &file = mgr->getProcFile();
 
-  if (!statStream.is_open()) {
-    throw std::runtime_error("Fail to open /proc/stat file");
+  if (!file.read()) {
+    throw std::runtime_error("Fail to read /proc/stat file");
   }
 
-  std::string line;
-  while (std::getline(statStream, line)) {
-    // cpu lines are at the start
-    if (line.find("cpu") == std::string::npos) {
-      break;
-    }
+  SysStatData sysData{};
+  ProcfsLine line;
+  while (file.nextLine(line)) {
+    std::string_view name;
 
-    char name[64] = {0};
-    CPUStatData data{};
-    auto cnt = ::sscanf(line.c_str(),
-                        "%s   %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu",
-                        name,
-                        &data.userTime,
-                        &data.niceTime,
-                        &data.systemTime,
-                        &data.idleTime,
-                        &data.ioWaitTime,
-                        &data.irqTime,
-                        &data.softIRQTime,
-                        &data.stealTime,
-                        &data.guestTime,
-                        &data.guestNiceTime);
-
-    if (cnt < 11) {
-      logError() << "Proc stat file parse error";
-      return false;
+    if (!line.nextField(name)) {
+      continue;
     }
 
-    auto found = false;
-    mgr->getCPUStatList().foreach ([&data, &name, &found](const std::shared_ptr<CPUStat> &entry) {
-      if (entry->getName() == name) {
-        entry->updateStats(data);
-        found = true;
+    if (name.compare(0, 3, "cpu") == 0) {
+      CPUStatData data{};
+      uint64_t index = 0;
+      bool status = line.nextUnsigned(data.userTime) && line.nextUnsigned(data.niceTime) &&
+                    line.nextUnsigned(data.systemTime) && line.nextUnsigned(data.idleTime) &&
+                    line.nextUnsigned(data.ioWaitTime) && line.nextUnsigned(data.irqTime) &&
+                    line.nextUnsigned(data.softIRQTime) && line.nextUnsigned(data.stealTime) &&
+                    line.nextUnsigned(data.guestTime) && line.nextUnsigned(data.guestNiceTime);
+
+      if (!status || ((name.size() > 3) && !ProcfsLine::toUnsigned(name.substr(3), index))) {
+        logError() << "Proc stat file parse error";
+        return false;
       }
-    });
 
-    if (!found) {
-      std::shared_ptr<CPUStat> entry = std::make_shared<CPUStat>(name);
+      auto entry = (name.size() == 3) ? mgr->getCPU() : mgr->getCore(index);
+      if (entry == nullptr) {
+        entry = std::make_shared<CPUStat>(std::string(name));
+        logDebug() << "Adding new cpu core '" << entry->getName() << "' for statistics";
+        if (name.size() == 3) {
+          mgr->setCPU(entry);
+        } else {
+          mgr->setCore(index, entry);
+        }
+      }
       entry->updateStats(data);
-
-      logDebug() << "Adding new cpu core '" << entry->getName() << "' for statistics";
-      mgr->getCPUStatList().append(entry);
-      mgr->getCPUStatList().commit();
+    } else if (name == "ctxt") {
+      line.nextUnsigned(sysData.ctxt);
+    } else if (name == "intr") {
+      // Only the total, the per interrupt counters follow
+      line.nextUnsigned(sysData.intr);
+    } else if (name == "processes") {
+      line.nextUnsigned(sysData.processes);
+    } else if (name == "procs_running") {
+      line.nextUnsigned(sysData.procsRunning);
+    } else if (name == "procs_blocked") {
+      line.nextUnsigned(sysData.procsBlocked);
     }
   }
 
+  mgr->updateSystemStats(sysData);
+
 #ifdef WITH_STARTUP_DATA
   if (App()->getStartupData() != nullptr) {
     if (!App()->getStartupData()->expired()) {
       tkm::msg::monitor::SysProcStat statData;
 
-      mgr->getCPUStatList().foreach ([&statData](const std::shared_ptr<CPUStat> &entry) {
-        if (entry->getType() == CPUStat::StatType::Cpu) {
-          statData.mutable_cpu()->CopyFrom(entry->getData());
-        } else {
-          statData.add_core()->CopyFrom(entry->getData());
+      if (mgr->getCPU() != nullptr) {
+        statData.mutable_cpu()->CopyFrom(mgr->getCPU()->getData());
+      }
+      for (const auto &core : mgr->getCores()) {
+        if (core != nullptr) {
+          statData.add_core()->CopyFrom(core->getData());
         }
-      });
+      }
 
       App()->getStartupData()->addCpuData(statData);
     }
@@ -192,27 +252,36 @@ static bool doUpdateStats(const std::shared_ptr<SysProcStat> mgr)
 static bool doCollectAndSend(const std::shared_ptr<SysProcStat> mgr,
                              const SysProcStat::Request &request)
 {
-  tkm::msg::monitor::SysProcStat statEvent;
-  tkm::msg::monitor::Data data;
+  auto envelope = mgr->getDataCache().get();
 
-  data.set_what(tkm::msg::monitor::Data_What_SysProcStat);
+  if (envelope == nullptr) {
+    tkm::msg::monitor::SysProcStat statEvent;
+    tkm::msg::monitor::Data data;
 
-  struct timespec currentTime;
-  clock_gettime(CLOCK_REALTIME, &currentTime);
-  data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
-  clock_gettime(CLOCK_MONOTONIC, &currentTime);
-  data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+    data.set_what(tkm::msg::monitor::Data_What_SysProcStat);
 
-  mgr->getCPUStatList().foreach ([&statEvent](const std::shared_ptr<CPUStat> &entry) {
-    if (entry->getType() == CPUStat::StatType::Cpu) {
-      statEvent.mutable_cpu()->CopyFrom(entry->getData());
-    } else {
-      statEvent.add_core()->CopyFrom(entry->getData());
+    struct timespec currentTime;
+    clock_gettime(CLOCK_REALTIME, &currentTime);
+    data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+    data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+
+    if (mgr->getCPU() != nullptr) {
+      statEvent.mutable_cpu()->CopyFrom(mgr->getCPU()->getData());
+    }
+    for (const auto &core : mgr->getCores()) {
+      if (core != nullptr) {
+        statEvent.add_core()->CopyFrom(core->getData());
+      }
     }
-  });
 
-  data.mutable_payload()->PackFrom(statEvent);
-  request.collector->sendData(data);
+    data.mutable_payload()->PackFrom(statEvent);
+
+    envelope = ICollector::makeDataEnvelope(data);
+    mgr->getDataCache().store(envelope);
+  }
+
+  request.collector->writeEnvelope(*envelope);
 
   return true;
 }
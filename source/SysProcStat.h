@@ -11,15 +11,18 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <taskmonitor/taskmonitor.h>
+#include <vector>
 
+#include "DataCache.h"
 #include "ICollector.h"
 #include "IDataSource.h"
 #include "Options.h"
+#include "ProcfsFile.h"
 
 #include "../bswinfra/source/AsyncQueue.h"
-#include "../bswinfra/source/SafeList.h"
 
 using namespace bswi::event;
 
@@ -129,6 +132,34 @@ struct CPUStatData {
   }
 };
 
+// Percentages without a CPUStat message field. Internal only, they are not
+// sent to collectors until the libtkm CPUStat message gets matching fields.
+struct CPUStatExtra {
+  uint32_t irq = 0;
+  uint32_t softIRQ = 0;
+  uint32_t steal = 0;
+  uint32_t guest = 0;
+};
+
+// System wide counters following the cpu lines
+struct SysStatData {
+  uint64_t ctxt = 0;
+  uint64_t intr = 0;
+  uint64_t processes = 0;
+  uint64_t procsRunning = 0;
+  uint64_t procsBlocked = 0;
+};
+
+// Counters as per second rates, procs_running and procs_blocked are gauges.
+// Internal only, the SysProcStat message has no fields for them.
+struct SysStatRates {
+  uint64_t ctxtPerSec = 0;
+  uint64_t intrPerSec = 0;
+  uint64_t forksPerSec = 0;
+  uint64_t procsRunning = 0;
+  uint64_t procsBlocked = 0;
+};
+
 struct CPUStat : public std::enable_shared_from_this<CPUStat> {
 public:
   enum class StatType { Cpu, Core };
@@ -151,10 +182,12 @@ public:
   auto getType(void) -> StatType { return m_type; }
   void updateStats(const CPUStatData &data);
   auto getData(void) -> tkm::msg::monitor::CPUStat & { return m_data; }
+  auto getExtra(void) -> const CPUStatExtra & { return m_extra; }
 
 private:
   std::chrono::time_point<std::chrono::steady_clock> m_lastUpdateTime{};
   tkm::msg::monitor::CPUStat m_data;
+  CPUStatExtra m_extra{};
   StatType m_type = StatType::Cpu;
   CPUStatData m_last;
 };
@@ -178,8 +211,17 @@ public:
 
 public:
   auto getShared() -> std::shared_ptr<SysProcStat> { return shared_from_this(); }
+  auto getDataCache(void) -> DataCache & { return m_dataCache; }
+  auto getProcFile(void) -> ProcfsFile & { return m_procFile; }
   auto getCPUStat(const std::string &name) -> const std::shared_ptr<CPUStat>;
-  auto getCPUStatList() -> bswi::util::SafeList<std::shared_ptr<CPUStat>> & { return m_cpus; }
+  // Aggregated cpu line and cpuN lines indexed by core number (nullptr for offline cores)
+  auto getCPU(void) -> const std::shared_ptr<CPUStat> & { return m_cpu; }
+  auto getCore(size_t index) -> const std::shared_ptr<CPUStat>;
+  auto getCores(void) -> const std::vector<std::shared_ptr<CPUStat>> & { return m_cores; }
+  void setCPU(const std::shared_ptr<CPUStat> &cpu) { m_cpu = cpu; }
+  void setCore(size_t index, const std::shared_ptr<CPUStat> &core);
+  auto getSystemRates(void) -> const SysStatRates & { return m_sysRates; }
+  void updateSystemStats(const SysStatData &data);
   auto pushRequest(SysProcStat::Request &request) -> int;
   void setEventSource(bool enabled = true);
   bool update(void) final;
@@ -188,9 +230,15 @@ private:
   bool requestHandler(const Request &request);
 
 private:
-  bswi::util::SafeList<std::shared_ptr<CPUStat>> m_cpus{"StatCPUList"};
+  std::chrono::time_point<std::chrono::steady_clock> m_lastSysUpdate{};
+  std::vector<std::shared_ptr<CPUStat>> m_cores{};
+  std::shared_ptr<CPUStat> m_cpu = nullptr;
+  SysStatData m_sysData{};
+  SysStatRates m_sysRates{};
   std::shared_ptr<AsyncQueue<Request>> m_queue = nullptr;
   std::shared_ptr<Options> m_options = nullptr;
+  DataCache m_dataCache{"SysProcStatCache"};
+  ProcfsFile m_procFile{"/proc/stat"};
 };
 
 } // namespace tkm::monitor
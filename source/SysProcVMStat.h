@@ -13,9 +13,12 @@
 
 #include <taskmonitor/taskmonitor.h>
 
+#include "DataCache.h"
 #include "ICollector.h"
 #include "IDataSource.h"
 #include "Options.h"
+#include "ProcKeyTable.h"
+#include "ProcfsFile.h"
 
 #include "../bswinfra/source/AsyncQueue.h"
 
@@ -23,6 +26,9 @@ using namespace bswi::event;
 
 namespace tkm::monitor
 {
+
+using VMStatFields = ProcKeyFields<decltype(VMStatKeyTable)>;
+
 class SysProcVMStat : public IDataSource, public std::enable_shared_from_this<SysProcVMStat>
 {
 public:
@@ -42,6 +48,11 @@ public:
 
 public:
   auto getShared() -> std::shared_ptr<SysProcVMStat> { return shared_from_this(); }
+  auto getDataCache(void) -> DataCache & { return m_dataCache; }
+  auto getProcFile(void) -> ProcfsFile & { return m_procFile; }
+  // Fields selected by the [vmstat] section. The ones without a message field
+  // are only available here, they are not sent or logged
+  auto getFields(void) -> VMStatFields & { return m_fields; }
   auto getProcVMStat() -> tkm::msg::monitor::SysProcVMStat & { return m_data; }
   auto pushRequest(SysProcVMStat::Request &request) -> int;
   void setEventSource(bool enabled = true);
@@ -53,6 +64,9 @@ private:
 private:
   std::shared_ptr<AsyncQueue<Request>> m_queue = nullptr;
   std::shared_ptr<Options> m_options = nullptr;
+  DataCache m_dataCache{"SysProcVMStatCache"};
+  ProcfsFile m_procFile{"/proc/vmstat"};
+  VMStatFields m_fields{VMStatKeyTable};
   tkm::msg::monitor::SysProcVMStat m_data;
 };
 
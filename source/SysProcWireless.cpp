@@ -12,6 +12,8 @@
 #include "SysProcWireless.h"
 #include "Application.h"
 
+#include <array>
+
 namespace tkm::monitor
 {
 
@@ -64,6 +66,7 @@ auto SysProcWireless::requestHandler(const Request &request) -> bool
   switch (request.action) {
   case SysProcWireless::Action::UpdateStats:
     status = doUpdateStats(getShared());
+    m_dataCache.invalidate();
     setUpdatePending(false);
     break;
   case SysProcWireless::Action::CollectAndSend:
@@ -79,62 +82,58 @@ auto SysProcWireless::requestHandler(const Request &request) -> bool
 
 static bool doUpdateStats(const std::shared_ptr<SysProcWireless> mgr)
 {
-  std::ifstream statStream{"/proc/net/wireless"};
+  auto &file = mgr->getProcFile();
 
-  if (!statStream.is_open()) {
-    throw std::runtime_error("Fail to open /proc/net/wireless file");
+  if (!file.read()) {
+    throw std::runtime_error("Fail to read /proc/net/wireless file");
   }
 
-  std::string line;
+  ProcfsLine line;
   auto lines = 0;
-  while (std::getline(statStream, line)) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(line);
-    std::string buf;
-
+  while (file.nextLine(line)) {
     // skip header lines
     if (lines++ < 2) {
       continue;
     }
 
-    while (ss >> buf) {
-      tokens.push_back(buf);
+    if (line.countFields() < 11) {
+      logError() << "Proc wireless file parse error";
+      return false;
     }
 
-    if (tokens.size() < 11) {
+    // Quality values have a trailing '.' which the integer scanner skips
+    std::array<int64_t, 3> quality{};
+    std::array<uint64_t, 6> counters{};
+    std::string_view name, status;
+
+    bool valid = line.nextField(name) && line.nextField(status);
+    for (size_t i = 0; valid && (i < quality.size()); i++) {
+      valid = line.nextSigned(quality[i]);
+    }
+    for (size_t i = 0; valid && (i < counters.size()); i++) {
+      valid = line.nextUnsigned(counters[i]);
+    }
+    if (!valid) {
       logError() << "Proc wireless file parse error";
       return false;
     }
 
-    auto &name = tokens[0];
     if (!name.empty()) {
-      name.pop_back();
+      name.remove_suffix(1);
     }
 
-    auto updateWlanInterfaceEntry = [&tokens](const std::shared_ptr<WlanInterface> &entry) {
-      entry->getData().set_status(tokens[1]);
-
-      if (tokens[2].back() == '.') {
-        tokens[2].pop_back();
-      }
-      entry->getData().set_quality_link(std::stoi(tokens[2]));
-
-      if (tokens[3].back() == '.') {
-        tokens[3].pop_back();
-      }
-      entry->getData().set_quality_level(std::stoi(tokens[3]));
-
-      if (tokens[4].back() == '.') {
-        tokens[4].pop_back();
-      }
-      entry->getData().set_quality_noise(std::stoi(tokens[4]));
-
-      entry->getData().set_discarded_nwid(static_cast<uint32_t>(std::stoul(tokens[5])));
-      entry->getData().set_discarded_crypt(static_cast<uint32_t>(std::stoul(tokens[6])));
-      entry->getData().set_discarded_frag(static_cast<uint32_t>(std::stoul(tokens[7])));
-      entry->getData().set_discarded_retry(static_cast<uint32_t>(std::stoul(tokens[8])));
-      entry->getData().set_discarded_misc(static_cast<uint32_t>(std::stoul(tokens[9])));
-      entry->getData().set_missed_beacon(static_cast<uint32_t>(std::stoul(tokens[10])));
+    auto updateWlanInterfaceEntry = [&status, &quality, &counters](
+                                        const std::shared_ptr<WlanInterface> &entry) {
+      entry->getData().set_status(std::string(status));
+      entry->getData().set_quality_link(static_cast<int32_t>(quality[0]));
+      entry->getData().set_quality_level(static_cast<int32_t>(quality[1]));
+      entry->getData().set_quality_noise(static_cast<int32_t>(quality[2]));
+      entry->getData().set_discarded_nwid(static_cast<uint32_t>(counters[0]));
+      entry->getData().set_discarded_crypt(static_cast<uint32_t>(counters[1]));
+      entry->getData().set_discarded_frag(static_cast<uint32_t>(counters[2]));
+      entry->getData().set_discarded_retry(static_cast<uint32_t>(counters[3]));
+      entry->getData().set_discarded_misc(static_cast<uint32_t>(counters[4]));
+      entry->getData().set_missed_beacon(static_cast<uint32_t>(counters[5]));
     };
 
     auto found = false;
@@ -147,7 +146,7 @@ static bool doUpdateStats(const std::shared_ptr<SysProcWireless> mgr)
         });
 
     if (!found) {
-      std::shared_ptr<WlanInterface> entry = std::make_shared<WlanInterface>(name);
+      std::shared_ptr<WlanInterface> entry = std::make_shared<WlanInterface>(std::string(name));
       logDebug() << "Adding new wlan inteface with name=" << name;
       mgr->getWlanInterfaceList().append(entry);
       mgr->getWlanInterfaceList().commit();
@@ -161,24 +160,32 @@ static bool doUpdateStats(const std::shared_ptr<SysProcWireless> mgr)
 static bool doCollectAndSend(const std::shared_ptr<SysProcWireless> mgr,
                              const SysProcWireless::Request &request)
 {
-  tkm::msg::monitor::SysProcWireless sysProcWireless;
-  tkm::msg::monitor::Data data;
+  auto envelope = mgr->getDataCache().get();
 
-  data.set_what(tkm::msg::monitor::Data_What_SysProcWireless);
+  if (envelope == nullptr) {
+    tkm::msg::monitor::SysProcWireless sysProcWireless;
+    tkm::msg::monitor::Data data;
 
-  struct timespec currentTime;
-  clock_gettime(CLOCK_REALTIME, &currentTime);
-  data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
-  clock_gettime(CLOCK_MONOTONIC, &currentTime);
-  data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+    data.set_what(tkm::msg::monitor::Data_What_SysProcWireless);
 
-  mgr->getWlanInterfaceList().foreach (
-      [&sysProcWireless](const std::shared_ptr<WlanInterface> &entry) {
-        sysProcWireless.add_ifw()->CopyFrom(entry->getData());
-      });
+    struct timespec currentTime;
+    clock_gettime(CLOCK_REALTIME, &currentTime);
+    data.set_system_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+    data.set_monotonic_time_sec(static_cast<uint64_t>(currentTime.tv_sec));
+
+    mgr->getWlanInterfaceList().foreach (
+        [&sysProcWireless](const std::shared_ptr<WlanInterface> &entry) {
+          sysProcWireless.add_ifw()->CopyFrom(entry->getData());
+        });
+
+    data.mutable_payload()->PackFrom(sysProcWireless);
+
+    envelope = ICollector::makeDataEnvelope(data);
+    mgr->getDataCache().store(envelope);
+  }
 
-  data.mutable_payload()->PackFrom(sysProcWireless);
-  request.collector->sendData(data);
+  request.collector->writeEnvelope(*envelope);
 
   return true;
 }
@@ -13,9 +13,11 @@
 
 #include <taskmonitor/taskmonitor.h>
 
+#include "DataCache.h"
 #include "ICollector.h"
 #include "IDataSource.h"
 #include "Options.h"
+#include "ProcfsFile.h"
 
 #include "../bswinfra/source/AsyncQueue.h"
 #include "../bswinfra/source/SafeList.h"
@@ -59,6 +61,8 @@ public:
 
 public:
   auto getShared() -> std::shared_ptr<SysProcWireless> { return shared_from_this(); }
+  auto getDataCache(void) -> DataCache & { return m_dataCache; }
+  auto getProcFile(void) -> ProcfsFile & { return m_procFile; }
   auto getWlanInterfaceList() -> bswi::util::SafeList<std::shared_ptr<WlanInterface>> &
   {
     return m_nodes;
@@ -74,6 +78,8 @@ private:
   bswi::util::SafeList<std::shared_ptr<WlanInterface>> m_nodes{"WlanInterfaceList"};
   std::shared_ptr<AsyncQueue<Request>> m_queue = nullptr;
   std::shared_ptr<Options> m_options = nullptr;
+  DataCache m_dataCache{"SysProcWirelessCache"};
+  ProcfsFile m_procFile{"/proc/net/wireless"};
 };
 
 } // namespace tkm::monitor
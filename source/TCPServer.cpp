@@ -98,7 +98,7 @@ TCPServer::~TCPServer()
 
 void TCPServer::bindAndListen()
 {
-  int port = -1;
+  const auto port = m_options->getSettings().tcpServerPort;
 
   if (m_bound) {
     logWarn() << "TCPServer already listening";
@@ -108,19 +108,14 @@ void TCPServer::bindAndListen()
   m_addr.sin_family = AF_INET;
   m_addr.sin_addr.s_addr = INADDR_ANY;
 
-  if (m_options->getFor(Options::Key::TCPServerAddress) != "any") {
-    std::string serverAddress = m_options->getFor(Options::Key::TCPServerAddress);
+  const auto &serverAddress = m_options->getSettings().tcpServerAddress;
+  if (serverAddress != "any") {
     struct hostent *server = gethostbyname(serverAddress.c_str());
     memcpy(&m_addr.sin_addr.s_addr, server->h_addr, (size_t) server->h_length);
   }
 
-  try {
-    port = std::stoi(m_options->getFor(Options::Key::TCPServerPort));
-  } catch (const std::exception &e) {
-    port = std::stoi(tkmDefaults.getFor(Defaults::Default::TCPServerPort));
-    logWarn() << "Cannot convert port number from config: " << e.what();
-  }
-  m_addr.sin_port = htons(static_cast<uint16_t>(port));
+  // Validated by Options, invalid values fall back to the default port
+  m_addr.sin_port = htons(port);
 
   if (bind(m_sockFd, (struct sockaddr *) &m_addr, sizeof(struct sockaddr_in)) != -1) {
     setPrepare([]() { return true; });
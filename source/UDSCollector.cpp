@@ -169,9 +169,9 @@ static bool doCreateSession(const std::shared_ptr<UDSCollector> collector)
   collector->getSessionInfo().set_core_count(static_cast<uint32_t>(sysconf(_SC_NPROCESSORS_ONLN)));
   logDebug() << "Send new sessionID=" << collector->getSessionInfo().hash();
 
-  auto keepAliveInterval =
-      std::stoul(App()->getOptions()->getFor(Options::Key::CollectorInactiveTimeout));
-  collector->getSessionInfo().set_keep_alive_interval(keepAliveInterval);
+  auto keepAliveInterval = App()->getOptions()->getSettings().collectorInactiveTimeout;
+  collector->getSessionInfo().set_keep_alive_interval(
+      static_cast<uint64_t>(keepAliveInterval.count()));
 
   collector->getSessionInfo().set_fast_lane_interval(App()->getFastLaneInterval());
   collector->getSessionInfo().set_pace_lane_interval(App()->getPaceLaneInterval());
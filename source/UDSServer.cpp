@@ -67,8 +67,7 @@ UDSServer::UDSServer(const std::shared_ptr<Options> options)
         collector->setEventSource();
 
         // Request StateManager to monitor collector for inactivity
-        if (options->getFor(Options::Key::UDSMonitorCollectorInactivity) ==
-            tkmDefaults.valFor(Defaults::Val::True)) {
+        if (options->getSettings().udsMonitorCollectorInactivity) {
           StateManager::Request monitorRequest = {.action = StateManager::Action::MonitorCollector,
                                                   .collector = collector};
           App()->getStateManager()->pushRequest(monitorRequest);
@@ -100,7 +99,7 @@ UDSServer::~UDSServer()
 
 void UDSServer::start()
 {
-  fs::path sockPath(m_options->getFor(Options::Key::UDSServerSocketPath));
+  fs::path sockPath(m_options->getSettings().udsServerSocketPath);
 
   m_addr.sun_family = AF_UNIX;
   strncpy(m_addr.sun_path, sockPath.c_str(), sizeof(m_addr.sun_path) - 1);
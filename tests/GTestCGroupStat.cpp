@@ -0,0 +1,234 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     CGroupStat Class Unit Tets
+ * @details   GTests for CGroupStat class
+ *-
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+
+#include "../source/CGroupStat.h"
+
+using namespace tkm::monitor;
+
+static const char *cpuStat = "usage_usec 5413320\n"
+                             "user_usec 3861234\n"
+                             "system_usec 1552086\n"
+                             "nr_periods 120\n"
+                             "nr_throttled 17\n"
+                             "throttled_usec 804233\n";
+
+static const char *memoryStat = "anon 104857600\n"
+                                "file 52428800\n"
+                                "kernel 4194304\n"
+                                "kernel_stack 458752\n"
+                                "shmem 1048576\n"
+                                "file_mapped 20971520\n"
+                                "sock 4096\n";
+
+static const char *ioStat = "8:0 rbytes=1048576 wbytes=4096 rios=16 wios=1 dbytes=0 dios=0\n"
+                            "259:0 rbytes=2048 wbytes=8192 rios=2 wios=4 dbytes=0 dios=0\n";
+
+static const char *cpuPressure = "some avg10=1.25 avg60=0.50 avg300=0.07 total=8144152\n"
+                                 "full avg10=0.00 avg60=0.00 avg300=0.00 total=1002\n";
+
+class GTestCGroupStat : public ::testing::Test
+{
+protected:
+  GTestCGroupStat() = default;
+  virtual ~GTestCGroupStat();
+
+  void SetUp() override
+  {
+    char tmpl[] = "/tmp/GTestCGroupStat.XXXXXX";
+    ASSERT_NE(::mkdtemp(tmpl), nullptr);
+    m_path = tmpl;
+  }
+
+  void TearDown() override
+  {
+    for (const auto name : {"cpu.stat", "memory.current", "memory.stat", "io.stat",
+                            "cpu.pressure", "memory.pressure", "io.pressure"}) {
+      ::unlink((m_path + "/" + name).c_str());
+    }
+    ::rmdir(m_path.c_str());
+  }
+
+  void writeFile(const std::string &name, const char *content)
+  {
+    FILE *file = ::fopen((m_path + "/" + name).c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    ::fputs(content, file);
+    ::fclose(file);
+  }
+
+  auto openDir(void) -> int { return ::open(m_path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC); }
+
+protected:
+  std::string m_path{};
+};
+
+GTestCGroupStat::~GTestCGroupStat() {}
+
+TEST_F(GTestCGroupStat, ParseCpuStat)
+{
+  CGroupStatData data{};
+
+  EXPECT_TRUE(parseCGroupCpuStat(cpuStat, strlen(cpuStat), data));
+  EXPECT_EQ(data.usageUsec, 5413320);
+  EXPECT_EQ(data.userUsec, 3861234);
+  EXPECT_EQ(data.systemUsec, 1552086);
+  EXPECT_EQ(data.nrPeriods, 120);
+  EXPECT_EQ(data.nrThrottled, 17);
+  EXPECT_EQ(data.throttledUsec, 804233);
+
+  const char *invalid = "usage\n";
+  EXPECT_FALSE(parseCGroupCpuStat(invalid, strlen(invalid), data));
+}
+
+TEST_F(GTestCGroupStat, ParseMemoryStat)
+{
+  CGroupStatData data{};
+
+  EXPECT_TRUE(parseCGroupMemoryStat(memoryStat, strlen(memoryStat), data));
+  EXPECT_EQ(data.memAnon, 104857600);
+  EXPECT_EQ(data.memFile, 52428800);
+  EXPECT_EQ(data.memKernel, 4194304);
+  EXPECT_EQ(data.memShmem, 1048576);
+  EXPECT_EQ(data.memSock, 4096);
+}
+
+TEST_F(GTestCGroupStat, ParseIOStat)
+{
+  CGroupStatData data{};
+
+  EXPECT_TRUE(parseCGroupIOStat(ioStat, strlen(ioStat), data));
+  EXPECT_EQ(data.ioRBytes, 1050624);
+  EXPECT_EQ(data.ioWBytes, 12288);
+  EXPECT_EQ(data.ioRIOs, 18);
+  EXPECT_EQ(data.ioWIOs, 5);
+
+  // Counters are not accumulated between parses
+  EXPECT_TRUE(parseCGroupIOStat(ioStat, strlen(ioStat), data));
+  EXPECT_EQ(data.ioRIOs, 18);
+  EXPECT_TRUE(parseCGroupIOStat("", 0, data));
+  EXPECT_EQ(data.ioRIOs, 0);
+}
+
+TEST_F(GTestCGroupStat, ParsePressure)
+{
+  CGroupPSIData some{};
+  CGroupPSIData full{};
+
+  EXPECT_TRUE(parseCGroupPressure(cpuPressure, strlen(cpuPressure), some, full));
+  EXPECT_FLOAT_EQ(some.avg10, 1.25f);
+  EXPECT_FLOAT_EQ(some.avg60, 0.5f);
+  EXPECT_FLOAT_EQ(some.avg300, 0.07f);
+  EXPECT_EQ(some.total, 8144152);
+  EXPECT_FLOAT_EQ(full.avg10, 0.0f);
+  EXPECT_EQ(full.total, 1002);
+
+  const char *invalid = "some avg10=x\n";
+  EXPECT_FALSE(parseCGroupPressure(invalid, strlen(invalid), some, full));
+}
+
+TEST_F(GTestCGroupStat, UpdateFromFiles)
+{
+  writeFile("cpu.stat", cpuStat);
+  writeFile("memory.current", "167772160\n");
+  writeFile("memory.stat", memoryStat);
+  writeFile("cpu.pressure", cpuPressure);
+
+  CGroupStat cgroup{"test.slice", openDir()};
+
+  EXPECT_NE(cgroup.getId(), 0);
+  EXPECT_TRUE(cgroup.hasFile(CGroupStat::File::CpuStat));
+  EXPECT_FALSE(cgroup.hasFile(CGroupStat::File::IOStat));
+  EXPECT_TRUE(cgroup.update());
+
+  const auto &data = cgroup.getData();
+  EXPECT_EQ(data.nrThrottled, 17);
+  EXPECT_EQ(data.throttledUsec, 804233);
+  EXPECT_EQ(data.memCurrent, 167772160);
+  EXPECT_EQ(data.memAnon, 104857600);
+  EXPECT_EQ(data.cpuSome.total, 8144152);
+  EXPECT_EQ(cgroup.getCPUPercent(), 0);
+
+  // Files are kept open and read again from the start
+  writeFile("cpu.stat", "usage_usec 9999999\nuser_usec 1\nsystem_usec 1\n");
+  EXPECT_TRUE(cgroup.update());
+  EXPECT_EQ(cgroup.getData().usageUsec, 9999999);
+}
+
+TEST_F(GTestCGroupStat, InvalidDirectory)
+{
+  CGroupStat cgroup{"none", -1};
+
+  EXPECT_FALSE(cgroup.hasFile(CGroupStat::File::CpuStat));
+  EXPECT_FALSE(cgroup.update());
+}
+
+TEST_F(GTestCGroupStat, PressureFromFiles)
+{
+  writeFile("cpu.pressure", cpuPressure);
+  writeFile("memory.pressure", "some avg10=4.00 avg60=2.00 avg300=1.00 total=42\n"
+                               "full avg10=3.00 avg60=1.00 avg300=0.50 total=21\n");
+
+  int rootFd = openDir();
+  CGroupPressure cgroup{rootFd, "."};
+  ::close(rootFd);
+
+  EXPECT_TRUE(cgroup.isOpen());
+  EXPECT_TRUE(cgroup.hasFile(CGroupPressure::File::MemPressure));
+  EXPECT_FALSE(cgroup.hasFile(CGroupPressure::File::IOPressure));
+  EXPECT_TRUE(cgroup.update());
+
+  const auto &data = cgroup.getData();
+  EXPECT_EQ(data.cpuSome.total, 8144152);
+  EXPECT_FLOAT_EQ(data.memSome.avg10, 4.0f);
+  EXPECT_EQ(data.memFull.total, 21);
+  EXPECT_EQ(data.ioSome.total, 0);
+
+  // Files are kept open and read again from the start
+  writeFile("memory.pressure", "some avg10=0.00 avg60=0.00 avg300=0.00 total=43\n");
+  EXPECT_TRUE(cgroup.update());
+  EXPECT_EQ(cgroup.getData().memSome.total, 43);
+
+  CGroupPressure none{-1, "none"};
+  EXPECT_FALSE(none.isOpen());
+  EXPECT_FALSE(none.update());
+}
+
+TEST_F(GTestCGroupStat, ReadRootCGroup)
+{
+  int fd = ::open("/sys/fs/cgroup/cgroup.controllers", O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    GTEST_SKIP() << "No cgroup v2 hierarchy";
+  }
+  ::close(fd);
+
+  CGroupStat cgroup{"/", ::open("/sys/fs/cgroup", O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+  if (!cgroup.hasFile(CGroupStat::File::CpuStat)) {
+    GTEST_SKIP() << "No cpu.stat in root cgroup";
+  }
+
+  EXPECT_TRUE(cgroup.update());
+  EXPECT_GT(cgroup.getData().usageUsec, 0);
+  EXPECT_TRUE(cgroup.update());
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -55,6 +55,85 @@ TEST_F(GTestContextEntry, ResetData)
   EXPECT_EQ(entry->getData().total_cpu_time(), 0);
 }
 
+TEST_F(GTestContextEntry, ProcTotals)
+{
+  std::shared_ptr<ContextEntry> entry = nullptr;
+  entry = std::make_shared<ContextEntry>(0xABABABAB, "TestEntry");
+
+  tkm::msg::monitor::ProcInfoEntry first;
+  first.set_cpu_time(100);
+  first.set_cpu_percent(10);
+  first.set_mem_rss(2048);
+  first.set_mem_pss(1024);
+
+  tkm::msg::monitor::ProcInfoEntry second;
+  second.set_cpu_time(50);
+  second.set_cpu_percent(5);
+  second.set_mem_rss(512);
+  second.set_mem_pss(256);
+
+  entry->addProc(first);
+  entry->addProc(second);
+  EXPECT_EQ(entry->getProcCount(), 2);
+  EXPECT_EQ(entry->getData().total_cpu_time(), 150);
+  EXPECT_EQ(entry->getData().total_cpu_percent(), 15);
+  EXPECT_EQ(entry->getData().total_mem_rss(), 2560);
+  EXPECT_EQ(entry->getData().total_mem_pss(), 1280);
+
+  // Sample update is applied as a delta
+  entry->subProcData(first);
+  first.set_cpu_time(120);
+  first.set_mem_rss(4096);
+  entry->addProcData(first);
+  EXPECT_EQ(entry->getData().total_cpu_time(), 170);
+  EXPECT_EQ(entry->getData().total_mem_rss(), 4608);
+
+  entry->remProc(first);
+  EXPECT_EQ(entry->getProcCount(), 1);
+  EXPECT_EQ(entry->getData().total_cpu_time(), 50);
+  EXPECT_EQ(entry->getData().total_mem_pss(), 256);
+
+  // Totals saturate instead of wrapping around
+  entry->remProc(first);
+  EXPECT_EQ(entry->getProcCount(), 0);
+  EXPECT_EQ(entry->getData().total_cpu_time(), 0);
+  EXPECT_EQ(entry->getData().total_mem_rss(), 0);
+}
+
+TEST_F(GTestContextEntry, CommonCGroup)
+{
+  EXPECT_EQ(commonCGroup("/machine.slice/c1/init.scope", "/machine.slice/c1/app"),
+            "/machine.slice/c1");
+  EXPECT_EQ(commonCGroup("/machine.slice/c1", "/machine.slice/c1/app"), "/machine.slice/c1");
+  EXPECT_EQ(commonCGroup("/machine.slice/c1", "/machine.slice/c1"), "/machine.slice/c1");
+  EXPECT_EQ(commonCGroup("/machine.slice/c1", "/machine.slice/c10"), "/machine.slice");
+  EXPECT_EQ(commonCGroup("/system.slice", "/user.slice"), "/");
+  EXPECT_EQ(commonCGroup("/", "/user.slice"), "/");
+}
+
+TEST_F(GTestContextEntry, ProcCGroups)
+{
+  std::shared_ptr<ContextEntry> entry = nullptr;
+  entry = std::make_shared<ContextEntry>(0xABABABAB, "TestEntry");
+
+  EXPECT_TRUE(entry->getCGroup().empty());
+  entry->addProcCGroup("/machine.slice/c1/app");
+  EXPECT_EQ(entry->getCGroup(), "/machine.slice/c1/app");
+  entry->addProcCGroup("/machine.slice/c1/app");
+  entry->addProcCGroup("/machine.slice/c1/init.scope");
+  EXPECT_EQ(entry->getCGroup(), "/machine.slice/c1");
+
+  // Narrows back once the processes of the other cgroup are gone
+  entry->remProcCGroup("/machine.slice/c1/init.scope");
+  EXPECT_EQ(entry->getCGroup(), "/machine.slice/c1/app");
+  entry->remProcCGroup("/machine.slice/c1/app");
+  EXPECT_EQ(entry->getCGroup(), "/machine.slice/c1/app");
+  entry->remProcCGroup("/machine.slice/c1/app");
+  EXPECT_TRUE(entry->getCGroup().empty());
+  entry->remProcCGroup("/unknown");
+  EXPECT_TRUE(entry->getCGroup().empty());
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,71 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     DataCache Class Unit Tets
+ * @details   GTests for DataCache class
+ *-
+ */
+
+#include <gtest/gtest.h>
+#include <memory>
+
+#include "../source/DataCache.h"
+
+using namespace tkm::monitor;
+
+class GTestDataCache : public ::testing::Test
+{
+protected:
+  GTestDataCache() = default;
+  virtual ~GTestDataCache();
+};
+
+GTestDataCache::~GTestDataCache() {}
+
+TEST_F(GTestDataCache, StoreAndInvalidate)
+{
+  DataCache cache{"TestCache"};
+
+  EXPECT_EQ(cache.get(), nullptr);
+  EXPECT_EQ(cache.getMisses(), 1);
+
+  auto envelope = std::make_shared<tkm::msg::Envelope>();
+  envelope->set_target(tkm::msg::Envelope_Recipient_Collector);
+  cache.store(envelope);
+
+  // Same generation requests share the stored envelope
+  EXPECT_EQ(cache.get(), envelope);
+  EXPECT_EQ(cache.get(), envelope);
+  EXPECT_EQ(cache.getHits(), 2);
+
+  auto generation = cache.getGeneration();
+  cache.invalidate();
+  EXPECT_EQ(cache.getGeneration(), generation + 1);
+  EXPECT_EQ(cache.get(), nullptr);
+  EXPECT_EQ(cache.getMisses(), 2);
+}
+
+TEST_F(GTestDataCache, EnvelopeOutlivesInvalidate)
+{
+  DataCache cache{"TestCache"};
+
+  auto envelope = std::make_shared<tkm::msg::Envelope>();
+  envelope->set_target(tkm::msg::Envelope_Recipient_Collector);
+  cache.store(envelope);
+
+  // A writer holding the envelope is not affected by the invalidation
+  auto held = cache.get();
+  envelope.reset();
+  cache.invalidate();
+  ASSERT_NE(held, nullptr);
+  EXPECT_EQ(held->target(), tkm::msg::Envelope_Recipient_Collector);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
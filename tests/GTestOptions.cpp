@@ -9,8 +9,10 @@
  *-
  */
 
+#include <chrono>
 #include <fstream>
 #include <gtest/gtest.h>
+#include <iostream>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -75,8 +77,16 @@ TEST_F(GTestOptions, Options_Defaults)
                    tkmDefaults.getFor(Defaults::Default::EnableProcEvent).c_str());
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::UpdateOnProcEvent).c_str(),
                    tkmDefaults.getFor(Defaults::Default::UpdateOnProcEvent).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::EnableProcPidFd).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::EnableProcPidFd).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ResolveProcExeName).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::ResolveProcExeName).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::EnableCGroupStat).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::EnableCGroupStat).c_str());
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::EnableProcAcct).c_str(),
                    tkmDefaults.getFor(Defaults::Default::EnableProcAcct).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::EnableProcExitAcct).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::EnableProcExitAcct).c_str());
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::EnableTCPServer).c_str(),
                    tkmDefaults.getFor(Defaults::Default::EnableTCPServer).c_str());
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::EnableUDSServer).c_str(),
@@ -91,6 +101,22 @@ TEST_F(GTestOptions, Options_Defaults)
                    tkmDefaults.getFor(Defaults::Default::TCPServerPort).c_str());
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::UDSServerSocketPath).c_str(),
                    tkmDefaults.getFor(Defaults::Default::UDSServerSocketPath).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::SamplingThreads).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::SamplingThreads).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ProcAcctBatchSize).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::ProcAcctBatchSize).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::SmapsSampleInterval).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::SmapsSampleInterval).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::SmapsRSSThreshold).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::SmapsRSSThreshold).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ProcEventBatchSize).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::ProcEventBatchSize).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ProcEventCoalesceInterval).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::ProcEventCoalesceInterval).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ThreadCPUThreshold).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::ThreadCPUThreshold).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ThreadTopCount).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::ThreadTopCount).c_str());
 }
 
 TEST_F(GTestOptions, Options_HasConfig)
@@ -124,7 +150,11 @@ TEST_F(GTestOptions, Options_NotDefaults)
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::ReadProcAtInit).c_str(), "false");
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::EnableProcEvent).c_str(), "false");
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::UpdateOnProcEvent).c_str(), "false");
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::EnableProcPidFd).c_str(), "true");
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ResolveProcExeName).c_str(), "true");
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::EnableCGroupStat).c_str(), "true");
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::EnableProcAcct).c_str(), "false");
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::EnableProcExitAcct).c_str(), "true");
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::EnableTCPServer).c_str(), "false");
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::EnableUDSServer).c_str(), "true");
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::EnableStartupData).c_str(), "true");
@@ -133,6 +163,14 @@ TEST_F(GTestOptions, Options_NotDefaults)
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::TCPServerPort).c_str(), "3358");
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::UDSServerSocketPath).c_str(),
                    "/tmp/taskmonitor.sock");
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::SamplingThreads).c_str(), "4");
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ProcAcctBatchSize).c_str(), "256");
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::SmapsSampleInterval).c_str(), "4");
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::SmapsRSSThreshold).c_str(), "1024");
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ProcEventBatchSize).c_str(), "128");
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ProcEventCoalesceInterval).c_str(), "0");
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ThreadCPUThreshold).c_str(), "20");
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ThreadTopCount).c_str(), "3");
 }
 
 TEST_F(GTestOptions, Options_SmallIntervals_UseDefaults)
@@ -179,6 +217,130 @@ TEST_F(GTestOptions, Options_InvalidIntervals_UseDefaults)
                    tkmDefaults.getFor(Defaults::Default::ProfModeSlowLaneInt).c_str());
   EXPECT_STRCASEEQ(opts->getFor(Options::Key::StartupDataCleanupTime).c_str(),
                    tkmDefaults.getFor(Defaults::Default::StartupDataCleanupTime).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::SamplingThreads).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::SamplingThreads).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::SmapsSampleInterval).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::SmapsSampleInterval).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ProcEventBatchSize).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::ProcEventBatchSize).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ProcEventCoalesceInterval).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::ProcEventCoalesceInterval).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ThreadCPUThreshold).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::ThreadCPUThreshold).c_str());
+  EXPECT_STRCASEEQ(opts->getFor(Options::Key::ThreadTopCount).c_str(),
+                   tkmDefaults.getFor(Defaults::Default::ThreadTopCount).c_str());
+}
+
+TEST_F(GTestOptions, Settings_Defaults)
+{
+  std::unique_ptr<Options> opts = nullptr;
+
+  opts = std::make_unique<Options>(std::string());
+  const auto &settings = opts->getSettings();
+
+  EXPECT_EQ(settings.containersPath, tkmDefaults.getFor(Defaults::Default::ContainersPath));
+  EXPECT_EQ(settings.prodModeFastLaneInt.count(),
+            std::stoll(tkmDefaults.getFor(Defaults::Default::ProdModeFastLaneInt)));
+  EXPECT_EQ(settings.updateOnProcEvent,
+            tkmDefaults.getFor(Defaults::Default::UpdateOnProcEvent) ==
+                tkmDefaults.valFor(Defaults::Val::True));
+  EXPECT_EQ(settings.enableCGroupStat,
+            tkmDefaults.getFor(Defaults::Default::EnableCGroupStat) ==
+                tkmDefaults.valFor(Defaults::Val::True));
+  EXPECT_EQ(settings.samplingThreads,
+            std::stoul(tkmDefaults.getFor(Defaults::Default::SamplingThreads)));
+  EXPECT_EQ(settings.procEventBatchSize,
+            std::stoul(tkmDefaults.getFor(Defaults::Default::ProcEventBatchSize)));
+  EXPECT_EQ(settings.procEventCoalesceInterval.count(),
+            std::stoll(tkmDefaults.getFor(Defaults::Default::ProcEventCoalesceInterval)));
+  EXPECT_EQ(settings.threadTopCount,
+            std::stoul(tkmDefaults.getFor(Defaults::Default::ThreadTopCount)));
+  EXPECT_EQ(settings.tcpServerPort,
+            std::stoul(tkmDefaults.getFor(Defaults::Default::TCPServerPort)));
+}
+
+TEST_F(GTestOptions, Settings_NotDefaults)
+{
+  std::unique_ptr<Options> opts = nullptr;
+
+  opts = std::make_unique<Options>("assets/taskmonitor_var0.conf");
+  EXPECT_EQ(opts->hasConfigFile(), true);
+  const auto &settings = opts->getSettings();
+
+  EXPECT_EQ(settings.containersPath, "/tmp/lib/lxc");
+  EXPECT_EQ(settings.prodModeFastLaneInt, std::chrono::seconds(20));
+  EXPECT_EQ(settings.profModeFastLaneInt, std::chrono::seconds(2));
+  EXPECT_FALSE(settings.updateOnProcEvent);
+  EXPECT_TRUE(settings.enableProcPidFd);
+  EXPECT_TRUE(settings.resolveProcExeName);
+  EXPECT_TRUE(settings.enableCGroupStat);
+  EXPECT_TRUE(settings.enableProcExitAcct);
+  EXPECT_EQ(settings.samplingThreads, 4);
+  EXPECT_EQ(settings.procAcctBatchSize, 256);
+  EXPECT_EQ(settings.smapsSampleInterval, 4);
+  EXPECT_EQ(settings.smapsRSSThreshold, 1024);
+  EXPECT_EQ(settings.procEventBatchSize, 128);
+  EXPECT_EQ(settings.procEventCoalesceInterval.count(), 0);
+  EXPECT_EQ(settings.threadCPUThreshold, 20);
+  EXPECT_EQ(settings.threadTopCount, 3);
+  EXPECT_EQ(settings.tcpServerPort, 3358);
+}
+
+TEST_F(GTestOptions, Settings_Invalid_UseDefaults)
+{
+  std::unique_ptr<Options> opts = nullptr;
+
+  opts = std::make_unique<Options>("assets/taskmonitor_var2.conf");
+  EXPECT_EQ(opts->hasConfigFile(), true);
+  const auto &settings = opts->getSettings();
+
+  EXPECT_EQ(settings.prodModeFastLaneInt.count(),
+            std::stoll(tkmDefaults.getFor(Defaults::Default::ProdModeFastLaneInt)));
+  EXPECT_EQ(settings.samplingThreads,
+            std::stoul(tkmDefaults.getFor(Defaults::Default::SamplingThreads)));
+  EXPECT_EQ(settings.smapsSampleInterval,
+            std::stoul(tkmDefaults.getFor(Defaults::Default::SmapsSampleInterval)));
+  EXPECT_EQ(settings.procEventBatchSize,
+            std::stoul(tkmDefaults.getFor(Defaults::Default::ProcEventBatchSize)));
+  EXPECT_EQ(settings.procEventCoalesceInterval.count(),
+            std::stoll(tkmDefaults.getFor(Defaults::Default::ProcEventCoalesceInterval)));
+  EXPECT_EQ(settings.threadTopCount,
+            std::stoul(tkmDefaults.getFor(Defaults::Default::ThreadTopCount)));
+  // Negative values are not wrapped around
+  EXPECT_EQ(settings.procAcctBatchSize,
+            std::stoul(tkmDefaults.getFor(Defaults::Default::ProcAcctBatchSize)));
+}
+
+TEST_F(GTestOptions, BenchmarkSettings)
+{
+  constexpr int64_t iterations = 100000;
+  using NSec = std::chrono::nanoseconds;
+  std::unique_ptr<Options> opts = std::make_unique<Options>("assets/taskmonitor.conf");
+  size_t sink = 0;
+
+  // The per event check done by the ProcEvent handler before the settings
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < iterations; i++) {
+    if (opts->getFor(Options::Key::UpdateOnProcEvent) == tkmDefaults.valFor(Defaults::Val::True)) {
+      sink++;
+    }
+  }
+  auto lookupNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+  start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < iterations; i++) {
+    const volatile bool enabled = opts->getSettings().updateOnProcEvent;
+    if (enabled) {
+      sink++;
+    }
+  }
+  auto settingsNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+  std::cout << "[ BENCH    ] UpdateOnProcEvent lookup=" << lookupNs.count() / iterations
+            << "ns/op settings=" << settingsNs.count() / iterations << "ns/op" << std::endl;
+
+  EXPECT_EQ(sink, static_cast<size_t>(2 * iterations));
+  EXPECT_LT(settingsNs.count(), lookupNs.count());
 }
 
 TEST_F(GTestOptions, InvalidKey)
@@ -0,0 +1,128 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     PressureTrigger Class Unit Tets
+ * @details   GTests for PressureTrigger class
+ *-
+ */
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../source/PressureTrigger.h"
+
+using namespace tkm::monitor;
+
+class GTestPressureTrigger : public ::testing::Test
+{
+protected:
+  GTestPressureTrigger() = default;
+  virtual ~GTestPressureTrigger();
+};
+
+GTestPressureTrigger::~GTestPressureTrigger() {}
+
+TEST_F(GTestPressureTrigger, ParseSpec)
+{
+  PressureTriggerSpec spec;
+
+  EXPECT_TRUE(parsePressureTrigger("memory:some:150000:1000000", spec));
+  EXPECT_EQ(spec.resource, "memory");
+  EXPECT_EQ(spec.type, "some");
+  EXPECT_EQ(spec.stallUsec, 150000);
+  EXPECT_EQ(spec.windowUsec, 1000000);
+
+  EXPECT_TRUE(parsePressureTrigger("io:full:500000:500000", spec));
+  EXPECT_EQ(spec.resource, "io");
+  EXPECT_EQ(spec.type, "full");
+}
+
+TEST_F(GTestPressureTrigger, ParseInvalid)
+{
+  PressureTriggerSpec spec;
+
+  EXPECT_FALSE(parsePressureTrigger("", spec));
+  EXPECT_FALSE(parsePressureTrigger("memory:some:150000", spec));
+  EXPECT_FALSE(parsePressureTrigger("disk:some:150000:1000000", spec));
+  EXPECT_FALSE(parsePressureTrigger("memory:all:150000:1000000", spec));
+  EXPECT_FALSE(parsePressureTrigger("memory:some:15ms:1000000", spec));
+  EXPECT_FALSE(parsePressureTrigger("memory:some:0:1000000", spec));
+  // Stall above window and window out of the kernel limits
+  EXPECT_FALSE(parsePressureTrigger("memory:some:2000000:1000000", spec));
+  EXPECT_FALSE(parsePressureTrigger("memory:some:1000:100000", spec));
+  EXPECT_FALSE(parsePressureTrigger("memory:some:150000:20000000", spec));
+}
+
+TEST_F(GTestPressureTrigger, StartStop)
+{
+  PressureTrigger trigger;
+  PressureTriggerSpec spec;
+
+  // Nothing to watch without triggers
+  EXPECT_FALSE(trigger.start([](size_t) {}));
+  EXPECT_FALSE(trigger.addTrigger("/proc/pressure/none", spec));
+
+  ASSERT_TRUE(parsePressureTrigger("cpu:some:500000:2000000", spec));
+  if (!trigger.addTrigger("/proc/pressure/cpu", spec)) {
+    GTEST_SKIP() << "PSI triggers not available";
+  }
+  EXPECT_EQ(trigger.getTriggers().size(), 1);
+
+  EXPECT_TRUE(trigger.start([](size_t) {}));
+  EXPECT_TRUE(trigger.isRunning());
+  EXPECT_FALSE(trigger.start([](size_t) {}));
+  // No new triggers once the watcher runs
+  EXPECT_FALSE(trigger.addTrigger("/proc/pressure/cpu", spec));
+
+  trigger.stop();
+  EXPECT_FALSE(trigger.isRunning());
+}
+
+TEST_F(GTestPressureTrigger, CPUStallEvent)
+{
+  PressureTrigger trigger;
+  PressureTriggerSpec spec;
+  std::atomic<size_t> events{0};
+
+  // 1ms cpu stall within 2s, unprivileged triggers need a multiple of 2s window
+  ASSERT_TRUE(parsePressureTrigger("cpu:some:1000:2000000", spec));
+  if (!trigger.addTrigger("/proc/pressure/cpu", spec)) {
+    GTEST_SKIP() << "PSI triggers not available";
+  }
+  EXPECT_TRUE(trigger.start([&events](size_t index) {
+    EXPECT_EQ(index, 0);
+    events++;
+  }));
+
+  // Busy threads for more than one window to get runnable tasks waiting
+  const auto threadCount = std::thread::hardware_concurrency() * 2;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(3000);
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < threadCount; i++) {
+    threads.emplace_back([&deadline, &events]() {
+      while ((std::chrono::steady_clock::now() < deadline) && (events.load() == 0)) {
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  trigger.stop();
+  EXPECT_EQ(trigger.getEventCount(), events.load());
+  EXPECT_GT(events.load(), 0);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -99,6 +99,7 @@ TEST_F(GTestProcEntry, Update)
   EXPECT_STRCASEEQ(testEntry->getName().c_str(), "GTestProcEntry");
   EXPECT_STRCASEEQ(testEntry->getData().comm().c_str(), "GTestProcEntry");
   EXPECT_EQ(testEntry->getData().pid(), getpid());
+  EXPECT_GT(testEntry->getData().mem_rss(), 0);
 
   if (getuid() == 0) {
 #ifdef WITH_PROC_ACCT
@@ -114,6 +115,23 @@ TEST_F(GTestProcEntry, Update)
   }
 }
 
+TEST_F(GTestProcEntry, SmapsSampleInterval)
+{
+  App()->getProcRegistry()->addProcEntry(getpid());
+  const std::shared_ptr<ProcEntry> testEntry = App()->getProcRegistry()->getProcEntry(getpid());
+  EXPECT_NE(testEntry, nullptr);
+
+  // First update always samples smaps_rollup
+  testEntry->update(tkmDefaults.valFor(Defaults::Val::ProcInfo));
+  const auto pss = testEntry->getSmapsData().pss;
+  EXPECT_GT(pss, 0);
+
+  // The test config samples every 4th update so PSS is kept from the first one
+  testEntry->update(tkmDefaults.valFor(Defaults::Val::ProcInfo));
+  EXPECT_EQ(testEntry->getSmapsData().pss, pss);
+  EXPECT_EQ(testEntry->getData().mem_pss(), pss);
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -18,8 +18,10 @@
 #include <taskmonitor/taskmonitor.h>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "../tests/dummy/Application.h"
+#include "../source/ProcEventSet.h"
 
 using namespace tkm::monitor;
 
@@ -101,6 +103,64 @@ TEST_F(GTestProcEvent, Update)
   }
 }
 
+TEST_F(GTestProcEvent, BatchReceive)
+{
+  if (getuid() == 0) {
+    EXPECT_EQ(App()->getProcEvent()->getBatchSize(), 32);
+    const auto batchCount = App()->getProcEvent()->getBatchCount();
+
+    system("uname -a");
+    sleep(1);
+
+    // fork, exec and exit events are received in one or more batches
+    EXPECT_GT(App()->getProcEvent()->getBatchCount(), batchCount);
+    EXPECT_GE(App()->getProcEvent()->getMaxBatchLength(), 1);
+    EXPECT_LE(App()->getProcEvent()->getMaxBatchLength(), 32);
+  }
+}
+
+TEST_F(GTestProcEvent, CoalesceShortLived)
+{
+  if (getuid() == 0) {
+    const auto cancelCount = App()->getProcEvent()->getCancelCount();
+
+    // Each shell exits well within the default coalescing window
+    for (int i = 0; i < 16; i++) {
+      system("true");
+    }
+    sleep(1);
+
+    EXPECT_GT(App()->getProcEvent()->getCancelCount(), cancelCount);
+    EXPECT_EQ(App()->getProcEvent()->getPendingCount(), 0);
+  }
+}
+
+TEST_F(GTestProcEvent, PendingSet)
+{
+  ProcEventSet pending;
+  std::vector<int> exited, forked, execed;
+
+  // Short lived child cancels out
+  pending.add(100, proc_event::what::PROC_EVENT_FORK);
+  pending.add(100, proc_event::what::PROC_EVENT_EXEC);
+  pending.add(100, proc_event::what::PROC_EVENT_EXIT);
+  EXPECT_TRUE(pending.empty());
+  EXPECT_EQ(pending.getCancelCount(), 1);
+
+  // Reused PID keeps the exit of the old process and the new fork
+  pending.add(200, proc_event::what::PROC_EVENT_EXIT);
+  pending.add(200, proc_event::what::PROC_EVENT_FORK);
+  // Exec of a known process only updates the entry
+  pending.add(300, proc_event::what::PROC_EVENT_EXEC);
+  EXPECT_EQ(pending.size(), 2);
+
+  pending.take(exited, forked, execed);
+  EXPECT_TRUE(pending.empty());
+  EXPECT_EQ(exited, std::vector<int>{200});
+  EXPECT_EQ(forked, std::vector<int>{200});
+  EXPECT_EQ(execed, std::vector<int>{300});
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,119 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcExitSummary Class Unit Tets
+ * @details   GTests for ProcExitSummary class
+ *-
+ */
+
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+
+#include "../source/ProcExitSummary.h"
+
+using namespace tkm::monitor;
+
+static auto makeRecord(const std::string &comm, uint32_t pid, uint32_t tgid) -> struct taskstats
+{
+  struct taskstats t {};
+
+  strncpy(t.ac_comm, comm.c_str(), sizeof(t.ac_comm) - 1);
+  t.ac_pid = pid;
+#if TASKSTATS_VERSION >= 13
+  t.ac_tgid = tgid;
+#else
+  static_cast<void>(tgid);
+#endif
+  t.ac_utime = 100;
+  t.ac_stime = 50;
+  t.cpu_count = 2;
+  t.cpu_delay_total = 4000000;
+  t.read_bytes = 4096;
+  t.hiwater_rss = pid;
+
+  return t;
+}
+
+class GTestProcExitSummary : public ::testing::Test
+{
+protected:
+  GTestProcExitSummary() = default;
+  virtual ~GTestProcExitSummary();
+};
+
+GTestProcExitSummary::~GTestProcExitSummary() {}
+
+TEST_F(GTestProcExitSummary, GroupByName)
+{
+  ProcExitSummary summary{"TestSummary"};
+
+  summary.add(makeRecord("cc1plus", 100, 100));
+  summary.add(makeRecord("cc1plus", 200, 200));
+  summary.add(makeRecord("sh", 300, 300));
+
+  EXPECT_EQ(summary.getEntryCount(), 2);
+  EXPECT_EQ(summary.getExitCount(), 3);
+
+  auto entry = summary.getEntry("cc1plus");
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->exitCount, 2);
+  EXPECT_EQ(entry->acct.ac_comm(), "cc1plus");
+  EXPECT_EQ(entry->acct.ac_utime(), 200);
+  EXPECT_EQ(entry->acct.ac_stime(), 100);
+  EXPECT_EQ(entry->acct.cpu().cpu_count(), 4);
+  EXPECT_EQ(entry->acct.cpu().cpu_delay_average(), 2);
+  EXPECT_EQ(entry->acct.io().read_bytes(), 8192);
+  EXPECT_EQ(entry->acct.mem().hiwater_rss(), 200);
+
+  size_t visited = 0;
+  summary.foreach ([&visited](const ProcExitSummary::Entry &) { visited++; });
+  EXPECT_EQ(visited, 2);
+
+  summary.clear();
+  EXPECT_EQ(summary.getEntryCount(), 0);
+  EXPECT_EQ(summary.getExitCount(), 0);
+}
+
+#if TASKSTATS_VERSION >= 13
+TEST_F(GTestProcExitSummary, ThreadRecords)
+{
+  ProcExitSummary summary{"TestSummary"};
+
+  // Worker thread exits are accounted but do not count as process exits
+  summary.add(makeRecord("worker", 101, 100));
+  summary.add(makeRecord("worker", 102, 100));
+  summary.add(makeRecord("worker", 100, 100));
+
+  auto entry = summary.getEntry("worker");
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->exitCount, 1);
+  EXPECT_EQ(entry->acct.ac_utime(), 300);
+}
+#endif
+
+TEST_F(GTestProcExitSummary, BoundedEntries)
+{
+  ProcExitSummary summary{"TestSummary", 2};
+
+  summary.add(makeRecord("one", 1, 1));
+  summary.add(makeRecord("two", 2, 2));
+  summary.add(makeRecord("three", 3, 3));
+  summary.add(makeRecord("four", 4, 4));
+  summary.add(makeRecord("one", 5, 5));
+
+  EXPECT_EQ(summary.getEntryCount(), 3);
+  EXPECT_EQ(summary.getEntry("three"), nullptr);
+  ASSERT_NE(summary.getEntry(ProcExitSummary::OtherName), nullptr);
+  EXPECT_EQ(summary.getEntry(ProcExitSummary::OtherName)->exitCount, 2);
+  EXPECT_EQ(summary.getEntry("one")->exitCount, 2);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,183 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcFilter Class Unit Tets
+ * @details   GTests and micro benchmarks for ProcFilter class
+ *-
+ */
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "../source/ProcFilter.h"
+
+using namespace tkm::monitor;
+
+class GTestProcFilter : public ::testing::Test
+{
+protected:
+  GTestProcFilter() = default;
+  virtual ~GTestProcFilter();
+};
+
+GTestProcFilter::~GTestProcFilter() {}
+
+TEST_F(GTestProcFilter, Substrings)
+{
+  ProcFilter filter{"TestFilter"};
+
+  EXPECT_TRUE(filter.addRule("kworker"));
+  EXPECT_TRUE(filter.addRule("cgroupify"));
+  EXPECT_TRUE(filter.addRule("worker/u"));
+  EXPECT_FALSE(filter.addRule(""));
+  filter.compile();
+
+  EXPECT_EQ(filter.getRuleCount(), 3);
+  EXPECT_TRUE(filter.matchName("kworker/0:1H"));
+  EXPECT_TRUE(filter.matchName("my-cgroupify"));
+  EXPECT_TRUE(filter.matchName("xworker/u8:2"));
+  EXPECT_FALSE(filter.matchName("kwork"));
+  EXPECT_FALSE(filter.matchName("systemd"));
+  EXPECT_FALSE(filter.matchName(""));
+}
+
+TEST_F(GTestProcFilter, OverlappingSubstrings)
+{
+  ProcFilter filter{"TestFilter"};
+
+  // "she" is only found through the failure link of "hers"
+  filter.addRule("hers");
+  filter.addRule("she");
+  filter.addRule("his");
+  filter.compile();
+
+  EXPECT_TRUE(filter.matchName("ushers"));
+  EXPECT_TRUE(filter.matchName("ashe"));
+  EXPECT_TRUE(filter.matchName("this"));
+  EXPECT_FALSE(filter.matchName("hes"));
+}
+
+TEST_F(GTestProcFilter, AnchoredAndRegex)
+{
+  ProcFilter filter{"TestFilter"};
+
+  filter.addRule("exact:sh");
+  filter.addRule("prefix:ksoftirqd/");
+  filter.addRule("regex:^irq/[0-9]+-");
+  EXPECT_FALSE(filter.addRule("regex:[unterminated"));
+  EXPECT_TRUE(filter.addRule("kworker/0:1"));
+  filter.compile();
+
+  EXPECT_TRUE(filter.matchName("sh"));
+  EXPECT_FALSE(filter.matchName("bash"));
+  EXPECT_TRUE(filter.matchName("ksoftirqd/3"));
+  EXPECT_FALSE(filter.matchName("my-ksoftirqd/3"));
+  EXPECT_TRUE(filter.matchName("irq/42-nvme0q1"));
+  EXPECT_FALSE(filter.matchName("irq/x-nvme0q1"));
+  EXPECT_TRUE(filter.matchName("kworker/0:1H"));
+}
+
+TEST_F(GTestProcFilter, Predicates)
+{
+  ProcFilter filter{"TestFilter"};
+
+  EXPECT_FALSE(filter.needsStat());
+  filter.addRule("kthread:any");
+  filter.addRule("uid:1000");
+  filter.addRule("ppid:2");
+  filter.addRule("cgroup:/system.slice/");
+  EXPECT_FALSE(filter.addRule("uid:nobody"));
+  filter.compile();
+
+  EXPECT_TRUE(filter.needsStat());
+  EXPECT_TRUE(filter.needsUid());
+  EXPECT_TRUE(filter.needsCGroup());
+
+  ProcFilter::Subject subject{};
+  subject.name = "bash";
+  subject.ppid = 1;
+  subject.uid = 0;
+  subject.cgroup = "/user.slice/user-0.slice";
+  EXPECT_FALSE(filter.matchSubject(subject));
+
+  subject.flags = ProcFilter::KThreadFlag;
+  EXPECT_TRUE(filter.matchSubject(subject));
+  subject.flags = 0;
+
+  subject.uid = 1000;
+  EXPECT_TRUE(filter.matchSubject(subject));
+  subject.uid = 0;
+
+  subject.ppid = 2;
+  EXPECT_TRUE(filter.matchSubject(subject));
+  subject.ppid = 1;
+
+  subject.cgroup = "/system.slice/sshd.service";
+  EXPECT_TRUE(filter.matchSubject(subject));
+}
+
+TEST_F(GTestProcFilter, ExcludedFromProc)
+{
+  ProcFilter filter{"TestFilter"};
+
+  filter.addRule("ppid:" + std::to_string(getppid()));
+  filter.compile();
+
+  EXPECT_TRUE(filter.isExcluded(getpid(), "GTestProcFilter"));
+  EXPECT_FALSE(filter.isExcluded(getppid(), "shell"));
+}
+
+TEST_F(GTestProcFilter, BenchmarkMatchName)
+{
+  constexpr int64_t iterations = 100000;
+  using NSec = std::chrono::nanoseconds;
+  const std::vector<std::string> rules{
+      "kworker", "cgroupify", "ksoftirqd", "migration", "rcu_", "watchdog", "idle_inject", "jbd2"};
+  const std::vector<std::string> names{
+      "kworker/3:1H", "systemd-journal", "chromium", "jbd2/sda1-8", "bash", "cc1plus"};
+  ProcFilter filter{"BenchFilter"};
+  size_t legacyHits = 0, filterHits = 0;
+
+  for (const auto &rule : rules) {
+    filter.addRule(rule);
+  }
+  filter.compile();
+
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < iterations; i++) {
+    const auto &name = names[static_cast<size_t>(i) % names.size()];
+    for (const auto &rule : rules) {
+      if (name.find(rule) != std::string::npos) {
+        legacyHits++;
+        break;
+      }
+    }
+  }
+  auto legacyNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+  start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < iterations; i++) {
+    if (filter.matchName(names[static_cast<size_t>(i) % names.size()])) {
+      filterHits++;
+    }
+  }
+  auto filterNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+  std::cout << "[ BENCH    ] name match substrings=" << legacyNs.count() / iterations
+            << "ns/op compiled=" << filterNs.count() / iterations << "ns/op" << std::endl;
+
+  EXPECT_EQ(legacyHits, filterHits);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
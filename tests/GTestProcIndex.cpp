@@ -0,0 +1,177 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcIndex Class Unit Tets
+ * @details   GTests for ProcIndex class
+ *-
+ */
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../source/ProcIndex.h"
+
+using namespace tkm::monitor;
+
+struct TestEntry {
+  TestEntry(int pid, const std::string &name)
+  : m_pid(pid)
+  , m_name(name)
+  {
+  }
+  auto getPid(void) -> int { return m_pid; }
+  auto getName(void) -> const std::string & { return m_name; }
+  void setName(const std::string &name) { m_name = name; }
+
+  int m_pid;
+  std::string m_name;
+};
+
+class GTestProcIndex : public ::testing::Test
+{
+protected:
+  GTestProcIndex() = default;
+  virtual ~GTestProcIndex();
+
+  static auto avgProbes(ProcIndex<TestEntry> &index, size_t count) -> double
+  {
+    index.resetProbeCount();
+    for (size_t i = 0; i < count; i++) {
+      EXPECT_NE(index.find(static_cast<int>(i + 1)), nullptr);
+    }
+    return static_cast<double>(index.getProbeCount()) / static_cast<double>(count);
+  }
+};
+
+GTestProcIndex::~GTestProcIndex() {}
+
+TEST_F(GTestProcIndex, InsertFindErase)
+{
+  ProcIndex<TestEntry> index{"TestIndex"};
+  auto first = std::make_shared<TestEntry>(100, "first");
+  auto second = std::make_shared<TestEntry>(200, "second");
+
+  index.insert(first);
+  index.insert(second);
+  EXPECT_EQ(index.getSize(), 2);
+  EXPECT_EQ(index.find(100), first);
+  EXPECT_EQ(index.find(200), second);
+  EXPECT_EQ(index.find("second"), second);
+  EXPECT_EQ(index.find(300), nullptr);
+
+  index.erase(first);
+  EXPECT_EQ(index.find(100), nullptr);
+  EXPECT_EQ(index.find("first"), nullptr);
+  EXPECT_EQ(index.getSize(), 1);
+}
+
+TEST_F(GTestProcIndex, SortedPids)
+{
+  ProcIndex<TestEntry> index{"TestIndex"};
+  std::vector<int> pids{42};
+
+  for (const auto pid : {900, 3, 4194304, 77, 12}) {
+    index.insert(std::make_shared<TestEntry>(pid, "entry"));
+  }
+  index.erase(index.find(77));
+
+  index.getPids(pids);
+  EXPECT_EQ(pids, std::vector<int>({3, 12, 900, 4194304}));
+}
+
+TEST_F(GTestProcIndex, ReplaceSamePid)
+{
+  ProcIndex<TestEntry> index{"TestIndex"};
+  auto oldEntry = std::make_shared<TestEntry>(100, "old");
+  auto newEntry = std::make_shared<TestEntry>(100, "new");
+
+  index.insert(oldEntry);
+  index.insert(newEntry);
+  EXPECT_EQ(index.getSize(), 1);
+  EXPECT_EQ(index.find(100), newEntry);
+  EXPECT_EQ(index.find("old"), nullptr);
+
+  // Erasing a stale entry must not drop the current one
+  index.erase(oldEntry);
+  EXPECT_EQ(index.find(100), newEntry);
+}
+
+TEST_F(GTestProcIndex, NameIndex)
+{
+  ProcIndex<TestEntry> index{"TestIndex"};
+  auto first = std::make_shared<TestEntry>(100, "worker");
+  auto second = std::make_shared<TestEntry>(200, "worker");
+
+  index.insert(first);
+  index.insert(second);
+  EXPECT_EQ(index.findAll("worker").size(), 2);
+
+  second->setName("renamed");
+  index.rename(second, "worker");
+  EXPECT_EQ(index.findAll("worker").size(), 1);
+  EXPECT_EQ(index.find("worker"), first);
+  EXPECT_EQ(index.find("renamed"), second);
+}
+
+TEST_F(GTestProcIndex, ConstantLookupCost)
+{
+  constexpr size_t smallCount = 1000;
+  constexpr size_t largeCount = 50000;
+  ProcIndex<TestEntry> smallIndex{"SmallIndex"};
+  ProcIndex<TestEntry> largeIndex{"LargeIndex"};
+
+  for (size_t i = 0; i < largeCount; i++) {
+    auto entry = std::make_shared<TestEntry>(static_cast<int>(i + 1), "proc");
+    if (i < smallCount) {
+      smallIndex.insert(entry);
+    }
+    largeIndex.insert(entry);
+  }
+  EXPECT_EQ(largeIndex.getSize(), largeCount);
+
+  // Probe count per lookup must not grow with the number of entries
+  auto smallProbes = avgProbes(smallIndex, smallCount);
+  auto largeProbes = avgProbes(largeIndex, largeCount);
+  EXPECT_LT(smallProbes, 4.0);
+  EXPECT_LT(largeProbes, 4.0);
+
+  // Misses stop at the first empty slot as well
+  largeIndex.resetProbeCount();
+  for (size_t i = 0; i < smallCount; i++) {
+    EXPECT_EQ(largeIndex.find(static_cast<int>(largeCount + i + 1)), nullptr);
+  }
+  EXPECT_LT(static_cast<double>(largeIndex.getProbeCount()) / smallCount, 8.0);
+}
+
+TEST_F(GTestProcIndex, ChurnKeepsTableBounded)
+{
+  ProcIndex<TestEntry> index{"TestIndex"};
+  std::vector<std::shared_ptr<TestEntry>> live;
+
+  // Simulate PID churn with short lived processes
+  for (int pid = 1; pid <= 200000; pid++) {
+    auto entry = std::make_shared<TestEntry>(pid, "short");
+    index.insert(entry);
+    live.push_back(entry);
+    if (live.size() > 1000) {
+      index.erase(live.front());
+      live.erase(live.begin());
+    }
+  }
+
+  EXPECT_EQ(index.getSize(), 1000);
+  EXPECT_LE(index.getCapacity(), 4096);
+  EXPECT_EQ(index.find(200000), live.back());
+  EXPECT_EQ(index.find(1), nullptr);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,235 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcKeyTable Class Unit Tets
+ * @details   GTests for ProcKeyTable and ProcKeyFields classes
+ *-
+ */
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <set>
+#include <string>
+
+#include "../source/ProcKeyTable.h"
+#include "../source/ProcfsFile.h"
+
+using namespace tkm::monitor;
+
+// Prefix compare chain used by SysProcVMStat before the key table
+static const char *LegacyPrefixes[] = {"pgpgin ",
+                                       "pgpgout ",
+                                       "pswpin ",
+                                       "pswpout ",
+                                       "pgmajfault ",
+                                       "pgreuse ",
+                                       "pgsteal_kswapd ",
+                                       "pgsteal_direct ",
+                                       "pgsteal_khugepaged ",
+                                       "pgsteal_anon ",
+                                       "pgsteal_file ",
+                                       "pgscan_kswapd ",
+                                       "pgscan_direct ",
+                                       "pgscan_khugepaged ",
+                                       "pgscan_direct_throttle ",
+                                       "pgscan_anon ",
+                                       "pgscan_file ",
+                                       "oom_kill ",
+                                       "compact_stall ",
+                                       "compact_fail ",
+                                       "compact_success ",
+                                       "thp_fault_alloc ",
+                                       "thp_collapse_alloc ",
+                                       "thp_collapse_alloc_failed ",
+                                       "thp_file_alloc ",
+                                       "thp_file_mapped ",
+                                       "thp_split_page ",
+                                       "thp_split_page_failed ",
+                                       "thp_zero_page_alloc ",
+                                       "thp_zero_page_alloc_failed ",
+                                       "thp_swpout ",
+                                       "thp_swpout_fallback "};
+
+using VMStatFields = ProcKeyFields<decltype(VMStatKeyTable)>;
+using MemInfoFields = ProcKeyFields<decltype(MemInfoKeyTable)>;
+
+class GTestProcKeyTable : public ::testing::Test
+{
+protected:
+  GTestProcKeyTable() = default;
+  virtual ~GTestProcKeyTable();
+
+  static auto legacyLookup(const ProcfsLine &line) -> int
+  {
+    int index = 0;
+
+    for (const auto prefix : LegacyPrefixes) {
+      if (line.startsWith(prefix)) {
+        return index;
+      }
+      index++;
+    }
+
+    return -1;
+  }
+};
+
+GTestProcKeyTable::~GTestProcKeyTable() {}
+
+TEST_F(GTestProcKeyTable, AllKeys)
+{
+  std::set<std::string_view> keys;
+
+  for (size_t i = 0; i < VMStatKeyTable.size(); i++) {
+    EXPECT_EQ(VMStatKeyTable.find(VMStatKeyTable.getKey(i)), static_cast<int>(i));
+    keys.insert(VMStatKeyTable.getKey(i));
+  }
+  EXPECT_EQ(keys.size(), VMStatKeyTable.size());
+
+  keys.clear();
+  for (size_t i = 0; i < MemInfoKeyTable.size(); i++) {
+    EXPECT_EQ(MemInfoKeyTable.find(MemInfoKeyTable.getKey(i)), static_cast<int>(i));
+    keys.insert(MemInfoKeyTable.getKey(i));
+  }
+  EXPECT_EQ(keys.size(), MemInfoKeyTable.size());
+}
+
+TEST_F(GTestProcKeyTable, UnknownKeys)
+{
+  EXPECT_EQ(VMStatKeyTable.find(""), VMStatKeyTable.NoKey);
+  EXPECT_EQ(VMStatKeyTable.find("pgpgi"), VMStatKeyTable.NoKey);
+  EXPECT_EQ(VMStatKeyTable.find("pgpgin "), VMStatKeyTable.NoKey);
+  EXPECT_EQ(VMStatKeyTable.find("thp_swpout_fallback_x"), VMStatKeyTable.NoKey);
+  EXPECT_EQ(MemInfoKeyTable.find("MemTotal:"), MemInfoKeyTable.NoKey);
+  EXPECT_EQ(MemInfoKeyTable.find("memtotal"), MemInfoKeyTable.NoKey);
+
+  // Resolved at compile time (i.e. switch case labels)
+  static_assert(VMStatKeyTable.find("nr_free_pages") == 0);
+  static_assert(MemInfoKeyTable.find("MemTotal") == 0);
+  static_assert(MemInfoKeyTable.find("NoSuchField") == MemInfoKeyTable.NoKey);
+}
+
+TEST_F(GTestProcKeyTable, Fields)
+{
+  VMStatFields fields{VMStatKeyTable};
+
+  EXPECT_EQ(fields.getSelectedCount(), 0);
+  EXPECT_TRUE(fields.select("nr_dirty"));
+  EXPECT_TRUE(fields.select("nr_dirty"));
+  EXPECT_TRUE(fields.select("pgfault"));
+  EXPECT_FALSE(fields.select("nr_nothing"));
+  EXPECT_EQ(fields.getSelectedCount(), 2);
+
+  EXPECT_TRUE(fields.isSelected("nr_dirty"));
+  EXPECT_FALSE(fields.isSelected("pgpgin"));
+  EXPECT_EQ(fields.lookup("pgpgin"), VMStatKeyTable.NoKey);
+
+  fields.setValue(fields.lookup("pgfault"), 42);
+  EXPECT_EQ(fields.getValue("pgfault"), 42);
+  EXPECT_EQ(fields.getValue("nr_dirty"), 0);
+  EXPECT_EQ(fields.getValue("pgpgin"), 0);
+}
+
+TEST_F(GTestProcKeyTable, ProcFiles)
+{
+  MemInfoFields memFields{MemInfoKeyTable};
+  VMStatFields vmFields{VMStatKeyTable};
+  ProcfsFile memInfo{"/proc/meminfo"};
+  ProcfsFile vmStat{"/proc/vmstat"};
+  ProcfsLine line;
+  std::string_view key;
+  uint64_t value = 0;
+  size_t unknown = 0;
+
+  ASSERT_TRUE(memInfo.read());
+  memFields.select("MemTotal");
+  while (memInfo.nextLine(line)) {
+    ASSERT_TRUE(line.nextField(key));
+    key.remove_suffix(1);
+    const auto index = memFields.lookup(key);
+    if (index != MemInfoKeyTable.NoKey) {
+      ASSERT_TRUE(line.nextUnsigned(value));
+      memFields.setValue(index, value);
+    }
+    if (MemInfoKeyTable.find(key) == MemInfoKeyTable.NoKey) {
+      unknown++;
+    }
+  }
+  EXPECT_GT(memFields.getValue("MemTotal"), 0);
+
+  ASSERT_TRUE(vmStat.read());
+  vmFields.select("pgfault");
+  while (vmStat.nextLine(line)) {
+    ASSERT_TRUE(line.nextField(key));
+    const auto index = vmFields.lookup(key);
+    if (index != VMStatKeyTable.NoKey) {
+      ASSERT_TRUE(line.nextUnsigned(value));
+      vmFields.setValue(index, value);
+    }
+    if (VMStatKeyTable.find(key) == VMStatKeyTable.NoKey) {
+      unknown++;
+    }
+  }
+  EXPECT_GT(vmFields.getValue("pgfault"), 0);
+
+  // Newer kernels may add fields, these are only reported
+  std::cout << "[ INFO     ] Unknown procfs fields: " << unknown << std::endl;
+}
+
+TEST_F(GTestProcKeyTable, BenchmarkVMStatLookup)
+{
+  constexpr int64_t iterations = 2000;
+  using NSec = std::chrono::nanoseconds;
+  VMStatFields fields{VMStatKeyTable};
+  ProcfsFile file{"/proc/vmstat"};
+  ProcfsLine line;
+  std::string_view key;
+
+  ASSERT_TRUE(file.read());
+  for (const auto prefix : LegacyPrefixes) {
+    const std::string_view name{prefix};
+    fields.select(name.substr(0, name.size() - 1));
+  }
+
+  size_t legacySink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < iterations; i++) {
+    file.read();
+    while (file.nextLine(line)) {
+      if (legacyLookup(line) >= 0) {
+        legacySink++;
+      }
+    }
+  }
+  auto legacyNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+  size_t fastSink = 0;
+  start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < iterations; i++) {
+    file.read();
+    while (file.nextLine(line)) {
+      if (line.nextField(key) && (fields.lookup(key) >= 0)) {
+        fastSink++;
+      }
+    }
+  }
+  auto fastNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+  std::cout << "[ BENCH    ] /proc/vmstat legacy=" << legacyNs.count() / iterations
+            << "ns/op hash=" << fastNs.count() / iterations << "ns/op speedup="
+            << static_cast<double>(legacyNs.count()) / static_cast<double>(fastNs.count()) << "x"
+            << std::endl;
+
+  EXPECT_GT(fastSink, 0);
+  EXPECT_EQ(fastSink, legacySink);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
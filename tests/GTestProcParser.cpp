@@ -0,0 +1,409 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcParser Unit Tets
+ * @details   GTests and micro benchmarks for procfs parsers
+ *-
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "../source/ProcParser.h"
+
+using namespace tkm::monitor;
+
+static const std::string gStatLine{
+    "1234 (my (weird) comm) S 1 1234 1234 0 -1 4194560 5210 120 3 0 731 215 0 0 20 0 7 0 "
+    "4242 1234567 890 18446744073709551615 1 1 0 0 0 0 0 4096 0 0 0 0 17 3 0 0 0 0 0 0 0 0 0 "
+    "0 0 0 0\n"};
+
+// Implementation used by ProcEntry before the allocation free parser
+static bool legacyParse(const std::string &line, uint64_t &ppid, uint64_t &cpuTime)
+{
+  std::vector<std::string> tokens;
+  std::stringstream ss(line);
+  std::string buf;
+
+  while (ss >> buf) {
+    tokens.push_back(buf);
+  }
+
+  if (tokens.size() < 52) {
+    return false;
+  }
+
+  auto afterNameOffset = tokens.size() - 52;
+  ppid = std::stoul(tokens[3 + afterNameOffset]);
+  cpuTime = std::stoul(tokens[13 + afterNameOffset]) + std::stoul(tokens[14 + afterNameOffset]);
+
+  return true;
+}
+
+// Name lookup used by ProcRegistry before reading /proc/<pid>/comm
+static auto legacyStatusName(int pid) -> std::string
+{
+  std::ifstream statusStream{"/proc/" + std::to_string(pid) + "/status"};
+  std::string line;
+
+  while (std::getline(statusStream, line)) {
+    std::vector<std::string> tokens;
+    std::stringstream ss(line);
+    std::string buf;
+
+    if (line.find("Name") == std::string::npos) {
+      break;
+    }
+
+    while (ss >> buf) {
+      tokens.push_back(buf);
+    }
+
+    std::string name{tokens[1]};
+    for (size_t i = 2; i < tokens.size(); i++) {
+      name.append(" " + tokens[i]);
+    }
+    return name;
+  }
+
+  return std::string();
+}
+
+// Process list scan used by ProcRegistry before the getdents64 scanner
+static void legacyScanPids(std::vector<int> &pids)
+{
+  pids.clear();
+  for (auto const &procEntry : std::filesystem::directory_iterator{"/proc"}) {
+    if (procEntry.is_directory()) {
+      try {
+        pids.push_back(std::stoi(procEntry.path().filename()));
+      } catch (...) {
+        continue;
+      }
+    }
+  }
+}
+
+// Append a linux_dirent64 record to buf
+static void appendDirent(std::vector<char> &buf, const char *name)
+{
+  const size_t nameLen = strlen(name) + 1;
+  const auto recLen = static_cast<uint16_t>((19 + nameLen + 7) & ~static_cast<size_t>(7));
+  const size_t pos = buf.size();
+
+  buf.resize(pos + recLen, '\0');
+  memcpy(buf.data() + pos + 16, &recLen, sizeof(recLen));
+  memcpy(buf.data() + pos + 19, name, nameLen);
+}
+
+class GTestProcParser : public ::testing::Test
+{
+protected:
+  GTestProcParser() = default;
+  virtual ~GTestProcParser();
+};
+
+GTestProcParser::~GTestProcParser() {}
+
+TEST_F(GTestProcParser, ParseStatLine)
+{
+  ProcStatData data{};
+
+  EXPECT_TRUE(parseProcStat(gStatLine.c_str(), gStatLine.size(), data));
+  EXPECT_EQ(data.pid, 1234);
+  EXPECT_EQ(data.state, 'S');
+  EXPECT_EQ(data.ppid, 1);
+  EXPECT_EQ(data.flags, 4194560);
+  EXPECT_EQ(data.minFlt, 5210);
+  EXPECT_EQ(data.majFlt, 3);
+  EXPECT_EQ(data.utime, 731);
+  EXPECT_EQ(data.stime, 215);
+  EXPECT_EQ(data.numThreads, 7);
+  EXPECT_EQ(data.startTime, 4242);
+  EXPECT_EQ(data.vsize, 1234567);
+  EXPECT_EQ(data.rss, 890);
+}
+
+TEST_F(GTestProcParser, ParseTruncated)
+{
+  ProcStatData data{};
+  const std::string noComm{"1234 my comm S 1 2 3"};
+  const std::string shortLine{"1234 (comm) S 1 1234 1234 0 -1 4194560 5210 120"};
+
+  EXPECT_FALSE(parseProcStat(noComm.c_str(), noComm.size(), data));
+  EXPECT_FALSE(parseProcStat(shortLine.c_str(), shortLine.size(), data));
+  EXPECT_FALSE(parseProcStat("", 0, data));
+}
+
+TEST_F(GTestProcParser, ReadSelfStat)
+{
+  ProcStatData data{};
+
+  int fd = ::open("/proc/self/stat", O_RDONLY | O_CLOEXEC);
+  ASSERT_GE(fd, 0);
+  EXPECT_TRUE(readProcStat(fd, data));
+  ::close(fd);
+
+  EXPECT_EQ(data.pid, getpid());
+  EXPECT_EQ(data.ppid, getppid());
+  EXPECT_GE(data.numThreads, 1);
+  EXPECT_GT(data.startTime, 0);
+}
+
+TEST_F(GTestProcParser, ParseStatIdentity)
+{
+  std::string name;
+  uint64_t startTime = 0;
+  const std::string noComm{"1234 my comm S 1 2 3"};
+
+  EXPECT_TRUE(parseProcStatIdentity(gStatLine.c_str(), gStatLine.size(), name, startTime));
+  EXPECT_EQ(name, "my (weird) comm");
+  EXPECT_EQ(startTime, 4242);
+  EXPECT_FALSE(parseProcStatIdentity(noComm.c_str(), noComm.size(), name, startTime));
+}
+
+TEST_F(GTestProcParser, ParseSmapsRollup)
+{
+  const std::string content{"55d0-7ffd ---p 00000000 00:00 0    [rollup]\n"
+                            "Rss:                1384 kB\n"
+                            "Pss:                 403 kB\n"
+                            "Pss_Anon:            100 kB\n"
+                            "AnonHugePages:      2048 kB\n"
+                            "Swap:                 12 kB\n"
+                            "SwapPss:               6 kB\n"};
+  ProcSmapsData data{};
+
+  EXPECT_TRUE(parseProcSmapsRollup(content.c_str(), content.size(), data));
+  EXPECT_EQ(data.rss, 1384);
+  EXPECT_EQ(data.pss, 403);
+
+  // Pss is mandatory
+  const std::string noPss{"Rss:                1384 kB\n"
+                          "Swap:                 12 kB\n"
+                          "SwapPss:               6 kB\n"};
+  EXPECT_FALSE(parseProcSmapsRollup(noPss.c_str(), noPss.size(), data));
+
+  int fd = ::open("/proc/self/smaps_rollup", O_RDONLY | O_CLOEXEC);
+  if (fd >= 0) {
+    ProcSmapsData self{};
+    EXPECT_TRUE(readProcSmapsRollup(fd, self));
+    EXPECT_GT(self.rss, 0);
+    ::close(fd);
+  }
+}
+
+TEST_F(GTestProcParser, MatchLegacyParser)
+{
+  std::ifstream statStream{"/proc/self/stat"};
+  std::string line;
+  ASSERT_TRUE(std::getline(statStream, line));
+
+  uint64_t ppid = 0, cpuTime = 0;
+  ProcStatData data{};
+  EXPECT_TRUE(legacyParse(line, ppid, cpuTime));
+  EXPECT_TRUE(parseProcStat(line.c_str(), line.size(), data));
+  EXPECT_EQ(static_cast<uint64_t>(data.ppid), ppid);
+  EXPECT_EQ(data.utime + data.stime, cpuTime);
+}
+
+TEST_F(GTestProcParser, BenchmarkStatParse)
+{
+  constexpr int64_t iterations = 200000;
+  using NSec = std::chrono::nanoseconds;
+  uint64_t sink = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < iterations; i++) {
+    uint64_t ppid = 0, cpuTime = 0;
+    legacyParse(gStatLine, ppid, cpuTime);
+    sink += cpuTime;
+  }
+  auto legacyNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+  start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < iterations; i++) {
+    ProcStatData data{};
+    parseProcStat(gStatLine.c_str(), gStatLine.size(), data);
+    sink += data.utime + data.stime;
+  }
+  auto fastNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+  std::cout << "[ BENCH    ] stat parse legacy=" << legacyNs.count() / iterations
+            << "ns/op fast=" << fastNs.count() / iterations << "ns/op speedup="
+            << static_cast<double>(legacyNs.count()) / static_cast<double>(fastNs.count()) << "x"
+            << std::endl;
+
+  EXPECT_EQ(sink, static_cast<uint64_t>(2 * iterations * (731 + 215)));
+  EXPECT_LT(fastNs.count(), legacyNs.count());
+}
+
+TEST_F(GTestProcParser, ParseComm)
+{
+  const std::string comm{"kworker/0:1H\n"};
+  std::string name;
+
+  EXPECT_TRUE(parseProcComm(comm.c_str(), comm.size(), name));
+  EXPECT_EQ(name, "kworker/0:1H");
+  EXPECT_FALSE(parseProcComm("\n", 1, name));
+}
+
+TEST_F(GTestProcParser, ParseCmdlineExe)
+{
+  const char cmdline[] = "/usr/lib/jvm/bin/java\0-Xmx4g\0-jar\0app.jar\0";
+  const char title[] = "sshd: root@pts/0\0\0";
+  const char plain[] = "bash";
+  std::string name;
+
+  EXPECT_TRUE(parseProcCmdlineExe(cmdline, sizeof(cmdline) - 1, name));
+  EXPECT_EQ(name, "java");
+  EXPECT_TRUE(parseProcCmdlineExe(title, sizeof(title) - 1, name));
+  EXPECT_EQ(name, "sshd: root@pts/0");
+  EXPECT_TRUE(parseProcCmdlineExe(plain, sizeof(plain) - 1, name));
+  EXPECT_EQ(name, "bash");
+  EXPECT_FALSE(parseProcCmdlineExe("\0", 1, name));
+}
+
+TEST_F(GTestProcParser, ReadSelfComm)
+{
+  std::string name;
+
+  int fd = ::open("/proc/self/comm", O_RDONLY);
+  ASSERT_GE(fd, 0);
+  EXPECT_TRUE(readProcComm(fd, name));
+  ::close(fd);
+
+  EXPECT_EQ(name, legacyStatusName(getpid()));
+}
+
+TEST_F(GTestProcParser, BenchmarkNameRead)
+{
+  constexpr int64_t iterations = 20000;
+  using NSec = std::chrono::nanoseconds;
+  const std::string commPath = "/proc/" + std::to_string(getpid()) + "/comm";
+  size_t sink = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < iterations; i++) {
+    sink += legacyStatusName(getpid()).size();
+  }
+  auto legacyNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+  start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < iterations; i++) {
+    std::string name;
+    int fd = ::open(commPath.c_str(), O_RDONLY | O_CLOEXEC);
+    readProcComm(fd, name);
+    ::close(fd);
+    sink += name.size();
+  }
+  auto commNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+  std::cout << "[ BENCH    ] name read status=" << legacyNs.count() / iterations
+            << "ns/op comm=" << commNs.count() / iterations << "ns/op speedup="
+            << static_cast<double>(legacyNs.count()) / static_cast<double>(commNs.count()) << "x"
+            << std::endl;
+
+  EXPECT_GT(sink, 0);
+  EXPECT_LT(commNs.count(), legacyNs.count());
+}
+
+TEST_F(GTestProcParser, ParseDirents)
+{
+  std::vector<char> buf;
+  std::vector<int> pids;
+
+  for (const auto name : {".", "..", "1", "self", "42", "sys", "4194304", "12a"}) {
+    appendDirent(buf, name);
+  }
+  parseProcDirents(buf.data(), buf.size(), pids);
+
+  EXPECT_EQ(pids, std::vector<int>({1, 42, 4194304}));
+}
+
+TEST_F(GTestProcParser, ReadProcPids)
+{
+  std::vector<int> pids;
+  std::vector<int> legacyPids;
+
+  int fd = ::open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  ASSERT_GE(fd, 0);
+  EXPECT_TRUE(readProcPids(fd, pids));
+  // A second scan on the same descriptor restarts from the beginning
+  EXPECT_TRUE(readProcPids(fd, pids));
+  ::close(fd);
+  legacyScanPids(legacyPids);
+
+  EXPECT_TRUE(std::is_sorted(pids.cbegin(), pids.cend()));
+  EXPECT_TRUE(std::binary_search(pids.cbegin(), pids.cend(), getpid()));
+  EXPECT_TRUE(std::binary_search(pids.cbegin(), pids.cend(), 1));
+  EXPECT_NEAR(static_cast<double>(pids.size()), static_cast<double>(legacyPids.size()), 8.0);
+}
+
+TEST_F(GTestProcParser, DiffProcPids)
+{
+  const std::vector<int> current{1, 2, 5, 7, 9, 12};
+  const std::vector<int> known{1, 3, 5, 9, 10};
+  std::vector<int> added;
+  std::vector<int> gone;
+
+  diffProcPids(current, known, added, gone);
+  EXPECT_EQ(added, std::vector<int>({2, 7, 12}));
+  EXPECT_EQ(gone, std::vector<int>({3, 10}));
+
+  diffProcPids(current, current, added, gone);
+  EXPECT_TRUE(added.empty());
+  EXPECT_TRUE(gone.empty());
+}
+
+TEST_F(GTestProcParser, BenchmarkProcScan)
+{
+  constexpr int64_t iterations = 500;
+  using NSec = std::chrono::nanoseconds;
+  std::vector<int> pids;
+  size_t sink = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < iterations; i++) {
+    legacyScanPids(pids);
+    sink += pids.size();
+  }
+  auto legacyNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+  int fd = ::open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  ASSERT_GE(fd, 0);
+  start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < iterations; i++) {
+    readProcPids(fd, pids);
+    sink += pids.size();
+  }
+  auto scanNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+  ::close(fd);
+
+  std::cout << "[ BENCH    ] proc scan (" << pids.size()
+            << " pids) legacy=" << legacyNs.count() / iterations
+            << "ns/op getdents=" << scanNs.count() / iterations << "ns/op speedup="
+            << static_cast<double>(legacyNs.count()) / static_cast<double>(scanNs.count()) << "x"
+            << std::endl;
+
+  EXPECT_GT(sink, 0);
+  EXPECT_LT(scanNs.count(), legacyNs.count());
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
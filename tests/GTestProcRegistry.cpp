@@ -9,17 +9,28 @@
  *-
  */
 
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <fstream>
 #include <gtest/gtest.h>
+#include <iostream>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
 #include <taskmonitor/taskmonitor.h>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "../tests/dummy/Application.h"
+#include "../tests/dummy/Client.h"
+#include "../tests/dummy/Collector.h"
+#include "../source/ProcEventSet.h"
 
 using namespace tkm::monitor;
 
@@ -139,6 +150,317 @@ TEST_F(GTestProcRegistry, Request_InitFromProc)
   EXPECT_STRCASEEQ(testEntry->getName().c_str(), "GTestProcRegist");
 }
 
+TEST_F(GTestProcRegistry, SweepStaleEntries)
+{
+  auto registry = App()->getProcRegistry();
+
+  pid_t child = fork();
+  if (child == 0) {
+    pause();
+    _exit(0);
+  }
+  ASSERT_GT(child, 0);
+
+  registry->updateProcessList();
+  EXPECT_NE(registry->getProcEntry(child), nullptr);
+  const auto generation = registry->getGeneration();
+  const auto retiredCount = registry->getRetiredCount();
+
+  kill(child, SIGKILL);
+  waitpid(child, nullptr, 0);
+
+  // Gone processes are not stamped by the next scan and swept at once
+  registry->updateProcessList();
+  EXPECT_EQ(registry->getProcEntry(child), nullptr);
+  EXPECT_GT(registry->getGeneration(), generation);
+  EXPECT_GT(registry->getRetiredCount(), retiredCount);
+
+  // Entries found gone by the samplers are swept even if the PID exists
+  auto self = registry->getProcEntry(getpid());
+  ASSERT_NE(self, nullptr);
+  self->markStale();
+  registry->updateProcessList();
+  EXPECT_EQ(registry->getProcEntry(getpid()), nullptr);
+  registry->updateProcessList();
+  EXPECT_NE(registry->getProcEntry(getpid()), nullptr);
+}
+
+TEST_F(GTestProcRegistry, RecheckIgnoredOnRename)
+{
+  auto registry = App()->getProcRegistry();
+  int ready[2], rename[2];
+  char token = 0;
+
+  ASSERT_EQ(pipe(ready), 0);
+  ASSERT_EQ(pipe(rename), 0);
+
+  pid_t child = fork();
+  if (child == 0) {
+    // The test configuration blacklists cgroupify
+    prctl(PR_SET_NAME, "cgroupify");
+    if ((write(ready[1], &token, 1) != 1) || (read(rename[0], &token, 1) != 1)) {
+      _exit(1);
+    }
+    prctl(PR_SET_NAME, "tkmrenamed");
+    if (write(ready[1], &token, 1) != 1) {
+      _exit(1);
+    }
+    pause();
+    _exit(0);
+  }
+  ASSERT_GT(child, 0);
+
+  ASSERT_EQ(read(ready[0], &token, 1), 1);
+  registry->updateProcessList();
+  EXPECT_EQ(registry->getProcEntry(child), nullptr);
+  registry->updateProcessList();
+  EXPECT_EQ(registry->getProcEntry(child), nullptr);
+
+  // Same PID and start time with a new name is filtered again
+  ASSERT_EQ(write(rename[1], &token, 1), 1);
+  ASSERT_EQ(read(ready[0], &token, 1), 1);
+  registry->updateProcessList();
+  auto entry = registry->getProcEntry(child);
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->getName(), "tkmrenamed");
+
+  kill(child, SIGKILL);
+  waitpid(child, nullptr, 0);
+  for (auto fd : {ready[0], ready[1], rename[0], rename[1]}) {
+    close(fd);
+  }
+}
+
+TEST_F(GTestProcRegistry, ExitNotifiedOnPidFd)
+{
+  auto registry = App()->getProcRegistry();
+
+  // The test configuration enables EnableProcPidFd
+  if (!ProcExitWatch::isSupported()) {
+    GTEST_SKIP() << "pidfd_open not available";
+  }
+
+  pid_t child = fork();
+  if (child == 0) {
+    pause();
+    _exit(0);
+  }
+  ASSERT_GT(child, 0);
+
+  registry->addProcEntry(child);
+  auto entry = registry->getProcEntry(child);
+  ASSERT_NE(entry, nullptr);
+  EXPECT_NE(entry->getExitWatch(), nullptr);
+
+  kill(child, SIGKILL);
+  waitpid(child, nullptr, 0);
+
+  // Removed by the pidfd callback in the event loop, no process list scan
+  sleep(1);
+  EXPECT_EQ(registry->getProcEntry(child), nullptr);
+  EXPECT_EQ(entry->getExitWatch(), nullptr);
+}
+
+TEST_F(GTestProcRegistry, ExitStormSweptTogether)
+{
+  constexpr size_t childCount = 8;
+  auto registry = App()->getProcRegistry();
+  std::vector<pid_t> children;
+
+  if (!ProcExitWatch::isSupported()) {
+    GTEST_SKIP() << "pidfd_open not available";
+  }
+
+  for (size_t i = 0; i < childCount; i++) {
+    pid_t child = fork();
+    if (child == 0) {
+      pause();
+      _exit(0);
+    }
+    ASSERT_GT(child, 0);
+    registry->addProcEntry(child);
+    children.push_back(child);
+  }
+  sleep(1);
+
+  const auto sweepCount = registry->getSweepCount();
+  const auto retiredCount = registry->getRetiredCount();
+  for (const auto child : children) {
+    kill(child, SIGKILL);
+  }
+  for (const auto child : children) {
+    waitpid(child, nullptr, 0);
+  }
+
+  // Exits are marked stale and removed by shared sweeps, not one commit each
+  sleep(1);
+  for (const auto child : children) {
+    EXPECT_EQ(registry->getProcEntry(child), nullptr);
+  }
+  EXPECT_GE(registry->getRetiredCount() - retiredCount, childCount);
+  EXPECT_LT(registry->getSweepCount() - sweepCount, childCount);
+}
+
+TEST_F(GTestProcRegistry, ThreadWatchList)
+{
+  auto registry = App()->getProcRegistry();
+
+  // The test configuration watches the threads of this process
+  registry->initFromProc();
+  auto self = registry->getProcEntry(getpid());
+  ASSERT_NE(self, nullptr);
+  EXPECT_TRUE(self->getThreadMonitor());
+  EXPECT_TRUE(self->getHotThreads().empty());
+
+  self->setThreadMonitor(false);
+  EXPECT_FALSE(self->getThreadMonitor());
+  EXPECT_TRUE(self->getHotThreads().empty());
+}
+
+TEST_F(GTestProcRegistry, ThreadMonitorProcInfo)
+{
+  auto registry = App()->getProcRegistry();
+  int sockets[2];
+
+  EXPECT_NE(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), -1);
+  auto collector = std::make_shared<Collector>(sockets[0]);
+  collector->setEventSource(true);
+  auto client = std::make_shared<Client>(sockets[1]);
+  client->setEventSource(true);
+
+  // Keep one thread busy above ThreadCPUThreshold while the process is sampled
+  std::atomic<bool> spinning = true;
+  std::thread spinner([&spinning]() {
+    while (spinning) {
+    }
+  });
+
+  registry->addProcEntry(getpid());
+  auto self = registry->getProcEntry(getpid());
+  ASSERT_NE(self, nullptr);
+  EXPECT_TRUE(self->getThreadMonitor());
+  for (int i = 0; (i < 20) && self->getHotThreads().empty(); i++) {
+    registry->update(ProcRegistry::UpdateLane::Pace);
+    usleep(100000);
+  }
+  spinning = false;
+  spinner.join();
+
+  size_t procCount = 0;
+  registry->getProcList().foreach ([&procCount](const std::shared_ptr<ProcEntry> &entry) {
+    if (!entry->isStale()) {
+      procCount++;
+    }
+  });
+
+  ProcRegistry::Request rq = {.action = ProcRegistry::Action::CollectAndSendProcInfo,
+                              .collector = collector};
+  registry->pushRequest(rq);
+  sleep(1);
+
+  tkm::msg::monitor::Message msg;
+  tkm::msg::monitor::Data data;
+  tkm::msg::monitor::ProcInfo procInfo;
+  client->getLastEnvelope().mesg().UnpackTo(&msg);
+  msg.payload().UnpackTo(&data);
+  ASSERT_EQ(data.what(), tkm::msg::monitor::Data_What_ProcInfo);
+  data.payload().UnpackTo(&procInfo);
+
+  // Hot threads stay internal, ProcInfo has one entry per process
+  EXPECT_EQ(static_cast<size_t>(procInfo.entry_size()), procCount);
+  size_t selfCount = 0;
+  for (const auto &entry : procInfo.entry()) {
+    if (entry.pid() == static_cast<uint32_t>(getpid())) {
+      selfCount++;
+    }
+  }
+  EXPECT_EQ(selfCount, 1);
+
+  collector->setEventSource(false);
+  client->setEventSource(false);
+}
+
+TEST_F(GTestProcRegistry, BenchmarkProcEvents)
+{
+  using NSec = std::chrono::nanoseconds;
+  constexpr size_t childCount = 64;
+  constexpr int64_t rounds = 20;
+  auto registry = App()->getProcRegistry();
+  std::vector<pid_t> children;
+
+  for (size_t i = 0; i < childCount; i++) {
+    pid_t child = fork();
+    if (child == 0) {
+      pause();
+      _exit(0);
+    }
+    ASSERT_GT(child, 0);
+    children.push_back(child);
+  }
+
+  // Every child forks and three out of four exit within the same window,
+  // the long lived ones exit on a later window
+  auto isShortLived = [](size_t i) { return (i % 4) != 0; };
+
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < childCount; i++) {
+      registry->addProcEntry(children[i]);
+    }
+    for (size_t i = 0; i < childCount; i++) {
+      if (isShortLived(i)) {
+        registry->remProcEntry(children[i], true);
+      }
+    }
+    for (size_t i = 0; i < childCount; i++) {
+      if (!isShortLived(i)) {
+        registry->remProcEntry(children[i], true);
+      }
+    }
+  }
+  auto legacyNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+  ProcEventSet pending;
+  std::vector<int> exited, forked, execed;
+  start = std::chrono::steady_clock::now();
+  for (int64_t r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < childCount; i++) {
+      pending.add(children[i], proc_event::what::PROC_EVENT_FORK);
+    }
+    for (size_t i = 0; i < childCount; i++) {
+      if (isShortLived(i)) {
+        pending.add(children[i], proc_event::what::PROC_EVENT_EXIT);
+      }
+    }
+    pending.take(exited, forked, execed);
+    registry->applyProcEvents(exited, forked, execed);
+    for (size_t i = 0; i < childCount; i++) {
+      if (!isShortLived(i)) {
+        pending.add(children[i], proc_event::what::PROC_EVENT_EXIT);
+      }
+    }
+    pending.take(exited, forked, execed);
+    registry->applyProcEvents(exited, forked, execed);
+  }
+  auto fastNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+  for (const auto child : children) {
+    EXPECT_EQ(registry->getProcEntry(child), nullptr);
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+  }
+
+  const auto events = rounds * static_cast<int64_t>(2 * childCount);
+  std::cout << "[ BENCH    ] fork/exit events legacy=" << legacyNs.count() / events
+            << "ns/op fast=" << fastNs.count() / events
+            << "ns/op speedup="
+            << static_cast<double>(legacyNs.count()) / static_cast<double>(fastNs.count()) << "x"
+            << std::endl;
+
+  EXPECT_EQ(pending.getCancelCount(), static_cast<uint64_t>(rounds) * (childCount * 3 / 4));
+  EXPECT_LT(fastNs.count(), legacyNs.count());
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,99 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcThreads Class Unit Tets
+ * @details   GTests for ProcThreads class
+ *-
+ */
+
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "../source/ProcThreads.h"
+
+using namespace tkm::monitor;
+
+class GTestProcThreads : public ::testing::Test
+{
+protected:
+  GTestProcThreads() = default;
+  virtual ~GTestProcThreads();
+
+  static auto openSelfTasks(void) -> int
+  {
+    return ::open("/proc/self/task", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  }
+};
+
+GTestProcThreads::~GTestProcThreads() {}
+
+TEST_F(GTestProcThreads, BaselineOnly)
+{
+  ProcThreads threads{getpid(), openSelfTasks()};
+
+  EXPECT_TRUE(threads.sample());
+  EXPECT_GE(threads.getThreadCount(), 1);
+  EXPECT_TRUE(threads.getHotThreads().empty());
+
+  threads.reset();
+  EXPECT_EQ(threads.getThreadCount(), 0);
+}
+
+TEST_F(GTestProcThreads, InvalidTaskDir)
+{
+  ProcThreads threads{getpid(), -1};
+
+  EXPECT_FALSE(threads.sample());
+  EXPECT_TRUE(threads.getHotThreads().empty());
+}
+
+TEST_F(GTestProcThreads, HotThread)
+{
+  std::atomic<bool> running{true};
+  std::thread spinner([&running]() {
+    pthread_setname_np(pthread_self(), "gtest-spin");
+    while (running) {
+    }
+  });
+  std::thread idle([&running]() {
+    pthread_setname_np(pthread_self(), "gtest-idle");
+    while (running) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  });
+
+  ProcThreads threads{getpid(), openSelfTasks(), 2};
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_TRUE(threads.sample());
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  EXPECT_TRUE(threads.sample());
+
+  running = false;
+  spinner.join();
+  idle.join();
+
+  EXPECT_GE(threads.getThreadCount(), 3);
+  ASSERT_FALSE(threads.getHotThreads().empty());
+  EXPECT_LE(threads.getHotThreads().size(), 2);
+  EXPECT_EQ(threads.getHotThreads().front().name, "gtest-spin");
+  EXPECT_GT(threads.getHotThreads().front().cpuPercent, 50);
+
+  // Exited threads are dropped by the next sample
+  EXPECT_TRUE(threads.sample());
+  EXPECT_EQ(threads.getThreadCount(), 1);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
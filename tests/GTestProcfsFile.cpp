@@ -0,0 +1,258 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     ProcfsFile Class Unit Tets
+ * @details   GTests for ProcfsFile class
+ *-
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "../source/ProcfsFile.h"
+
+using namespace tkm::monitor;
+
+class GTestProcfsFile : public ::testing::Test
+{
+protected:
+  GTestProcfsFile() = default;
+  virtual ~GTestProcfsFile();
+
+  void SetUp() override
+  {
+    char tmpl[] = "/tmp/GTestProcfsFile.XXXXXX";
+    int fd = ::mkstemp(tmpl);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+    m_path = tmpl;
+  }
+
+  void TearDown() override { ::unlink(m_path.c_str()); }
+
+  void writeFile(const std::string &content)
+  {
+    std::ofstream file(m_path, std::ios::trunc);
+    file << content;
+  }
+
+  // Tokenizer used by the data sources before ProcfsFile
+  static auto legacyParse(const std::string &path) -> size_t
+  {
+    std::ifstream stream{path};
+    std::string line;
+    size_t count = 0;
+
+    while (std::getline(stream, line)) {
+      std::vector<std::string> tokens;
+      std::stringstream ss(line);
+      std::string buf;
+
+      while (ss >> buf) {
+        tokens.push_back(buf);
+      }
+      count += tokens.size();
+    }
+
+    return count;
+  }
+
+  static auto procfsParse(ProcfsFile &file) -> size_t
+  {
+    ProcfsLine line;
+    std::string_view field;
+    size_t count = 0;
+
+    file.read();
+    while (file.nextLine(line)) {
+      while (line.nextField(field)) {
+        count++;
+      }
+    }
+
+    return count;
+  }
+
+protected:
+  std::string m_path{};
+};
+
+GTestProcfsFile::~GTestProcfsFile() {}
+
+TEST_F(GTestProcfsFile, LineFields)
+{
+  const std::string text = "wlan0: 0000   70.  -40.  -256        0      0      0";
+  ProcfsLine line(text.data(), text.data() + text.size());
+  std::string_view field;
+  uint64_t value = 0;
+  int64_t signedValue = 0;
+
+  EXPECT_TRUE(line.startsWith("wlan0"));
+  EXPECT_TRUE(line.contains("-256"));
+  EXPECT_EQ(line.countFields(), 8);
+
+  EXPECT_TRUE(line.nextField(field));
+  EXPECT_EQ(field, "wlan0:");
+  EXPECT_TRUE(line.nextField(field));
+  EXPECT_EQ(field, "0000");
+  EXPECT_TRUE(line.nextUnsigned(value));
+  EXPECT_EQ(value, 70);
+  EXPECT_TRUE(line.nextSigned(signedValue));
+  EXPECT_EQ(signedValue, -40);
+  EXPECT_FALSE(line.nextUnsigned(value));
+  EXPECT_EQ(line.countFields(), 3);
+  EXPECT_TRUE(line.skipFields(3));
+  EXPECT_FALSE(line.nextField(field));
+
+  line.rewind();
+  EXPECT_EQ(line.countFields(), 8);
+}
+
+TEST_F(GTestProcfsFile, KeyValues)
+{
+  const std::string text = "some avg10=1.25 avg60=0.50 avg300=12.07 total=8144152";
+  ProcfsLine line(text.data(), text.data() + text.size());
+  std::string_view key, value;
+  uint64_t total = 0;
+  float avg = 0;
+
+  EXPECT_TRUE(line.skipFields(1));
+  EXPECT_TRUE(line.nextKeyValue(key, value));
+  EXPECT_EQ(key, "avg10");
+  EXPECT_TRUE(ProcfsLine::toDecimal(value, avg));
+  EXPECT_FLOAT_EQ(avg, 1.25f);
+  EXPECT_TRUE(line.skipFields(1));
+  EXPECT_TRUE(line.nextKeyValue(key, value));
+  EXPECT_TRUE(ProcfsLine::toDecimal(value, avg));
+  EXPECT_FLOAT_EQ(avg, 12.07f);
+  EXPECT_TRUE(line.nextKeyValue(key, value));
+  EXPECT_EQ(key, "total");
+  EXPECT_TRUE(ProcfsLine::toUnsigned(value, total));
+  EXPECT_EQ(total, 8144152);
+
+  EXPECT_FALSE(ProcfsLine::toUnsigned("12a", total));
+  EXPECT_FALSE(ProcfsLine::toDecimal("x.5", avg));
+}
+
+TEST_F(GTestProcfsFile, ReadAgain)
+{
+  writeFile("MemTotal:       16310508 kB\nMemFree:         1015932 kB\n");
+
+  ProcfsFile file{m_path};
+  ProcfsLine line;
+  uint64_t value = 0;
+
+  ASSERT_TRUE(file.isOpen());
+  EXPECT_TRUE(file.read());
+  EXPECT_TRUE(file.nextLine(line));
+  EXPECT_TRUE(line.startsWith("MemTotal:"));
+  EXPECT_TRUE(line.skipFields(1));
+  EXPECT_TRUE(line.nextUnsigned(value));
+  EXPECT_EQ(value, 16310508);
+  EXPECT_TRUE(file.nextLine(line));
+  EXPECT_TRUE(line.startsWith("MemFree:"));
+  EXPECT_FALSE(file.nextLine(line));
+
+  // The same fd sees the new content from the start
+  writeFile("MemTotal:       42 kB\n");
+  EXPECT_TRUE(file.read());
+  EXPECT_TRUE(file.nextLine(line));
+  EXPECT_TRUE(line.skipFields(1));
+  EXPECT_TRUE(line.nextUnsigned(value));
+  EXPECT_EQ(value, 42);
+  EXPECT_FALSE(file.nextLine(line));
+}
+
+TEST_F(GTestProcfsFile, GrowBuffer)
+{
+  std::string content;
+  for (int i = 0; i < 1000; i++) {
+    content += "cpu" + std::to_string(i) + " 1 2 3 4 5 6 7 8 9 10\n";
+  }
+  writeFile(content);
+
+  ProcfsFile file{m_path, 64};
+  ProcfsLine line;
+  size_t lines = 0;
+
+  EXPECT_TRUE(file.read());
+  EXPECT_EQ(file.getSize(), content.size());
+  while (file.nextLine(line)) {
+    EXPECT_EQ(line.countFields(), 11);
+    lines++;
+  }
+  EXPECT_EQ(lines, 1000);
+}
+
+TEST_F(GTestProcfsFile, MissingFile)
+{
+  ProcfsFile file{"/proc/tkm/none"};
+  ProcfsLine line;
+
+  EXPECT_FALSE(file.isOpen());
+  EXPECT_FALSE(file.read());
+  EXPECT_FALSE(file.nextLine(line));
+}
+
+TEST_F(GTestProcfsFile, BenchmarkSysProcParse)
+{
+  constexpr int64_t iterations = 2000;
+  using NSec = std::chrono::nanoseconds;
+  const std::vector<std::string> paths = {"/proc/stat",
+                                          "/proc/meminfo",
+                                          "/proc/vmstat",
+                                          "/proc/diskstats",
+                                          "/proc/buddyinfo",
+                                          "/proc/pressure/cpu",
+                                          "/proc/net/wireless"};
+
+  for (const auto &path : paths) {
+    ProcfsFile file{path};
+    if (!file.isOpen()) {
+      continue;
+    }
+
+    size_t legacySink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < iterations; i++) {
+      legacySink += legacyParse(path);
+    }
+    auto legacyNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+    size_t fastSink = 0;
+    start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < iterations; i++) {
+      fastSink += procfsParse(file);
+    }
+    auto fastNs = std::chrono::duration_cast<NSec>(std::chrono::steady_clock::now() - start);
+
+    std::cout << "[ BENCH    ] " << path << " legacy=" << legacyNs.count() / iterations
+              << "ns/op procfs=" << fastNs.count() / iterations << "ns/op speedup="
+              << static_cast<double>(legacyNs.count()) / static_cast<double>(fastNs.count())
+              << "x" << std::endl;
+
+    // Same tokens unless the content changed in between (i.e. counters width)
+    EXPECT_GT(fastSink, 0);
+    EXPECT_NEAR(static_cast<double>(fastSink),
+                static_cast<double>(legacySink),
+                static_cast<double>(legacySink) * 0.05);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
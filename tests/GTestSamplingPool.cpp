@@ -0,0 +1,129 @@
+/*-
+ * SPDX-License-Identifier: MIT
+ *-
+ * @date      2021-2023
+ * @author    Alin Popa <alin.popa@fxdata.ro>
+ * @copyright MIT
+ * @brief     SamplingPool Class Unit Tets
+ * @details   GTests for SamplingPool class
+ *-
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "../source/SamplingPool.h"
+
+using namespace tkm::monitor;
+
+class GTestSamplingPool : public ::testing::Test
+{
+protected:
+  GTestSamplingPool() = default;
+  virtual ~GTestSamplingPool();
+
+  void waitDone(void)
+  {
+    std::unique_lock lk(m_mutex);
+    m_cond.wait(lk, [this]() { return m_done; });
+    m_done = false;
+  }
+
+  void setDone(void)
+  {
+    {
+      std::scoped_lock lk(m_mutex);
+      m_done = true;
+    }
+    m_cond.notify_all();
+  }
+
+  std::condition_variable m_cond{};
+  std::mutex m_mutex{};
+  bool m_done = false;
+};
+
+GTestSamplingPool::~GTestSamplingPool() {}
+
+TEST_F(GTestSamplingPool, InvalidThreadCount)
+{
+  EXPECT_THROW(SamplingPool("TestPool", 0), std::runtime_error);
+}
+
+TEST_F(GTestSamplingPool, RunBatchOnce)
+{
+  constexpr size_t count = 10000;
+  SamplingPool pool{"TestPool", 4};
+  std::vector<std::atomic<int>> visits(count);
+
+  EXPECT_EQ(pool.getThreadCount(), 4);
+  EXPECT_FALSE(pool.run(0, [](size_t) {}, []() {}));
+
+  ASSERT_TRUE(pool.run(
+      count, [&visits](size_t index) { visits[index]++; }, [this]() { setDone(); }));
+  waitDone();
+
+  // Each item is sampled exactly once per batch
+  for (size_t i = 0; i < count; i++) {
+    EXPECT_EQ(visits[i].load(), 1);
+  }
+}
+
+TEST_F(GTestSamplingPool, RejectWhileBusy)
+{
+  SamplingPool pool{"TestPool", 2};
+  std::atomic<bool> release{false};
+
+  ASSERT_TRUE(pool.run(
+      64,
+      [&release](size_t) {
+        while (!release.load()) {
+          std::this_thread::yield();
+        }
+      },
+      [this]() { setDone(); }));
+
+  EXPECT_TRUE(pool.isBusy());
+  EXPECT_FALSE(pool.run(1, [](size_t) {}, []() {}));
+
+  release.store(true);
+  waitDone();
+
+  // A new batch is accepted once the previous one completed
+  ASSERT_TRUE(pool.run(1, [](size_t) {}, [this]() { setDone(); }));
+  waitDone();
+}
+
+TEST_F(GTestSamplingPool, ShardAcrossThreads)
+{
+  constexpr size_t count = 4096;
+  SamplingPool pool{"TestPool", 4};
+  std::set<std::thread::id> workers;
+  std::mutex workersMutex;
+
+  for (int batch = 0; batch < 10; batch++) {
+    ASSERT_TRUE(pool.run(
+        count,
+        [&workers, &workersMutex](size_t) {
+          std::this_thread::sleep_for(std::chrono::microseconds(5));
+          std::scoped_lock lk(workersMutex);
+          workers.insert(std::this_thread::get_id());
+        },
+        [this]() { setDone(); }));
+    waitDone();
+  }
+
+  EXPECT_GT(workers.size(), 1);
+  EXPECT_EQ(workers.count(std::this_thread::get_id()), 0);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
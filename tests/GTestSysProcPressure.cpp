@@ -107,6 +107,34 @@ TEST_F(GTestSysProcPressure, RequestData)
   EXPECT_EQ(data.what(), tkm::msg::monitor::Data_What_SysProcPressure);
 }
 
+TEST_F(GTestSysProcPressure, NotifyTrigger)
+{
+  // No [pressure] triggers in the test configuration
+  EXPECT_EQ(App()->getSysProcPressure()->getTrigger(), nullptr);
+
+  SysProcPressure::Request rq = {.action = SysProcPressure::Action::CollectAndSend,
+                                 .collector = m_collector};
+  App()->getSysProcPressure()->pushRequest(rq);
+  sleep(1);
+  EXPECT_EQ(App()->getSysProcPressure()->getSubscribers().size(), 1);
+
+  // Same request as the one queued by the trigger watcher
+  const auto generation = App()->getSysProcPressure()->getDataCache().getGeneration();
+  SysProcPressure::Request nrq = {.action = SysProcPressure::Action::NotifyTrigger,
+                                  .collector = nullptr};
+  App()->getSysProcPressure()->pushRequest(nrq);
+  sleep(1);
+  EXPECT_GT(App()->getSysProcPressure()->getDataCache().getGeneration(), generation);
+
+  tkm::msg::monitor::Message msg;
+  m_client->getLastEnvelope().mesg().UnpackTo(&msg);
+  EXPECT_EQ(msg.type(), tkm::msg::monitor::Message_Type_Data);
+
+  tkm::msg::monitor::Data data;
+  msg.payload().UnpackTo(&data);
+  EXPECT_EQ(data.what(), tkm::msg::monitor::Data_What_SysProcPressure);
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -91,6 +91,39 @@ TEST_F(GTestSysProcStat, UpdateCPUStat)
   EXPECT_NE(cpu, nullptr);
 }
 
+TEST_F(GTestSysProcStat, IndexedCores)
+{
+  App()->getSysProcStat()->update();
+  sleep(1);
+
+  const std::shared_ptr<CPUStat> core = App()->getSysProcStat()->getCPUStat("cpu0");
+  EXPECT_NE(core, nullptr);
+  EXPECT_EQ(core, App()->getSysProcStat()->getCore(0));
+  EXPECT_EQ(core->getName(), "cpu0");
+  EXPECT_EQ(core->getType(), CPUStat::StatType::Core);
+  EXPECT_EQ(App()->getSysProcStat()->getCPU()->getType(), CPUStat::StatType::Cpu);
+  EXPECT_EQ(App()->getSysProcStat()->getCPUStat("cpu100000"), nullptr);
+  EXPECT_EQ(App()->getSysProcStat()->getCPUStat("cpux"), nullptr);
+}
+
+TEST_F(GTestSysProcStat, SystemRates)
+{
+  App()->getSysProcStat()->update();
+  sleep(1);
+
+  // Rates need two updates
+  App()->getSysProcStat()->update();
+  sleep(1);
+
+  const auto &rates = App()->getSysProcStat()->getSystemRates();
+  EXPECT_GT(rates.ctxtPerSec, 0);
+  EXPECT_GT(rates.intrPerSec, 0);
+  EXPECT_GT(rates.procsRunning, 0);
+
+  const auto &extra = App()->getSysProcStat()->getCPU()->getExtra();
+  EXPECT_LE(extra.irq + extra.softIRQ + extra.steal, 100);
+}
+
 TEST_F(GTestSysProcStat, RequestData)
 {
   EXPECT_EQ(App()->getSysProcStat()->getCPUStat("cpu"), nullptr);
@@ -93,6 +93,38 @@ TEST_F(GTestTCPInterface, StartConnectReader)
   EXPECT_NO_THROW(App()->getTCPServer()->invalidate());
 }
 
+TEST_F(GTestTCPInterface, BroadcastEnvelope)
+{
+  EXPECT_NO_THROW(App()->getTCPServer()->bindAndListen());
+  sleep(1);
+
+  auto reader = std::make_shared<Reader>(App()->getOptions(), Reader::Type::INET);
+  reader->setEventSource(true);
+  EXPECT_EQ(m_reader->connect(), 0);
+  EXPECT_EQ(reader->connect(), 0);
+  sleep(1);
+
+  // Both collectors are registered with the state manager
+  std::vector<std::weak_ptr<ICollector>> subscribers;
+  App()->getStateManager()->getActiveCollectorList().foreach (
+      [&subscribers](const std::shared_ptr<ICollector> &entry) { subscribers.push_back(entry); });
+  EXPECT_EQ(subscribers.size(), 2);
+
+  tkm::msg::monitor::Data data;
+  tkm::msg::monitor::SysProcBuddyInfo buddyInfo;
+  data.set_what(tkm::msg::monitor::Data_What_SysProcBuddyInfo);
+  data.mutable_payload()->PackFrom(buddyInfo);
+
+  // One packed envelope is written to every collector
+  ICollector::broadcastEnvelope(*ICollector::makeDataEnvelope(data), subscribers);
+  usleep(100000);
+  EXPECT_EQ(m_reader->getSysProcBuddyInfoCount(), 1);
+  EXPECT_EQ(reader->getSysProcBuddyInfoCount(), 1);
+
+  reader->setEventSource(false);
+  EXPECT_NO_THROW(App()->getTCPServer()->invalidate());
+}
+
 TEST_F(GTestTCPInterface, RequestData_NoModules)
 {
   EXPECT_NO_THROW(App()->getTCPServer()->bindAndListen());
@@ -25,6 +25,7 @@
 #include "ProcEntry.h"
 #include "ProcRegistry.h"
 #include "StateManager.h"
+#include "SysCGroupStat.h"
 #include "SysProcBuddyInfo.h"
 #include "SysProcDiskStats.h"
 #include "SysProcMemInfo.h"
@@ -118,6 +119,10 @@ public:
   {
     return m_sysProcBuddyInfo;
   }
+  auto getSysCGroupStat(void) -> const std::shared_ptr<SysCGroupStat>
+  {
+    return m_sysCGroupStat;
+  }
   auto getProcAcctCollectorCounter(void) -> unsigned short
   {
     return m_procAcctCollectorCounter;
@@ -148,6 +153,7 @@ public:
   std::shared_ptr<SysProcPressure> m_sysProcPressure = nullptr;
   std::shared_ptr<SysProcBuddyInfo> m_sysProcBuddyInfo = nullptr;
   std::shared_ptr<SysProcWireless> m_sysProcWireless = nullptr;
+  std::shared_ptr<SysCGroupStat> m_sysCGroupStat = nullptr;
   std::atomic<unsigned short> m_procAcctCollectorCounter = 0;
 
 private: